@@ -0,0 +1,47 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <ranges>
+#include <vector>
+
+namespace IndustrialMusic {
+
+// Walker alias method, built with Vose's pairing: n weighted outcomes become
+// n equally likely columns, each keeping its own outcome with some
+// probability and giving its alias otherwise, so a draw is one column pick
+// and one comparison. setColumn(column, probability, alias) is called once
+// per column, with probability in [0, 1]; columns left full get 1 and
+// alias themselves. Callers quantize the probability to their own
+// threshold format. Weights must be non-negative with a positive sum.
+template<std::ranges::random_access_range Weights, typename SetColumn>
+void buildAliasTable(const Weights& weights, SetColumn&& setColumn) {
+    const size_t n = std::ranges::size(weights);
+    double total = 0.0;
+    for (const auto& weight : weights) {
+        total += static_cast<double>(weight);
+    }
+
+    std::vector<double> scaled(n);
+    std::vector<size_t> small, large;
+    for (size_t i = 0; i < n; ++i) {
+        scaled[i] = static_cast<double>(weights[i]) * static_cast<double>(n) / total;
+        (scaled[i] < 1.0 ? small : large).push_back(i);
+    }
+    while (!small.empty() && !large.empty()) {
+        size_t low = small.back();
+        small.pop_back();
+        size_t high = large.back();
+        setColumn(low, scaled[low], high);
+        scaled[high] -= 1.0 - scaled[low];
+        if (scaled[high] < 1.0) {
+            large.pop_back();
+            small.push_back(high);
+        }
+    }
+    // Leftovers are 1 up to rounding
+    for (size_t i : small) setColumn(i, 1.0, i);
+    for (size_t i : large) setColumn(i, 1.0, i);
+}
+
+} // namespace IndustrialMusic
\ No newline at end of file
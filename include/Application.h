@@ -13,7 +13,10 @@ class SongStructure;
 class Visualizer;
 class VocalSynthesizer;
 class LyricsGenerator;
+class SongRenderer;
 class MainWindow;
+class ThreadPool;
+class SongCache;
 
 class Application {
 public:
@@ -39,8 +42,19 @@ public:
     [[nodiscard]] Visualizer& getVisualizer() { return *m_visualizer; }
     [[nodiscard]] VocalSynthesizer& getVocalSynthesizer() { return *m_vocalSynth; }
     [[nodiscard]] LyricsGenerator& getLyricsGenerator() { return *m_lyricsGen; }
+    [[nodiscard]] SongRenderer& getSongRenderer() { return *m_songRenderer; }
     
 private:
+    // Sections kept per generator for incremental regeneration while editing
+    static constexpr size_t SECTION_CACHE_CAPACITY = 4096;
+    
+    // Exported songs kept on disk between sessions
+    static constexpr uint64_t SONG_CACHE_BYTES = 256ull * 1024 * 1024;
+    
+    // Shared workers for background generation
+    std::unique_ptr<ThreadPool> m_threadPool;
+    std::unique_ptr<SongCache> m_songCache;
+    
     // Core components
     std::unique_ptr<AudioEngine> m_audioEngine;
     std::unique_ptr<MidiGenerator> m_midiGenerator;
@@ -48,6 +62,7 @@ private:
     std::unique_ptr<Visualizer> m_visualizer;
     std::unique_ptr<VocalSynthesizer> m_vocalSynth;
     std::unique_ptr<LyricsGenerator> m_lyricsGen;
+    std::unique_ptr<SongRenderer> m_songRenderer;
     
     // UI
     GLFWwindow* m_window = nullptr;
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "Common.h"
+#include "SectionCache.h"
+#include <optional>
+
+namespace IndustrialMusic {
+
+// Rule set for generated arrangements: a Markov chain over section types
+// and, per type, a distribution of section lengths in bars. Weights need
+// not sum to one; a row of all zeros falls back to Verse.
+struct ArrangementRules {
+    struct BarChoice {
+        int bars;
+        float weight;
+    };
+
+    std::array<std::array<float, SECTION_TYPE_COUNT>, SECTION_TYPE_COUNT> transitions{}; // [from][to]
+    std::array<std::vector<BarChoice>, SECTION_TYPE_COUNT> barLengths;
+    int beatsPerBar = 4;
+
+    // Verse/chorus cycles broken up by breakdowns and instrumentals; an
+    // outro leads back into a new intro
+    [[nodiscard]] static ArrangementRules industrial();
+};
+
+// Draws an endless sequence of sections from a rule set. Section n depends
+// only on the seed, n and section n - 1, so a stream can be recreated from
+// any point.
+class ArrangementGenerator {
+public:
+    ArrangementGenerator(ArrangementRules rules, uint32_t seed);
+
+    // Continue from a section, e.g. the end of a hand-made arrangement
+    void continueFrom(SectionType previous, uint64_t index);
+
+    [[nodiscard]] Section next();
+    [[nodiscard]] uint64_t getIndex() const { return m_index; }
+    [[nodiscard]] const ArrangementRules& getRules() const { return m_rules; }
+
+private:
+    ArrangementRules m_rules;
+    uint32_t m_seed;
+    uint64_t m_index = 0;
+    std::optional<SectionType> m_previous; // Unset before the first section
+
+    // Running weight totals, so each draw is one search
+    std::array<std::array<float, SECTION_TYPE_COUNT>, SECTION_TYPE_COUNT> m_cumulativeTransitions{};
+    std::array<std::vector<float>, SECTION_TYPE_COUNT> m_cumulativeBars;
+};
+
+// Endless song for continuous playback. Holds only the section playing now
+// and a few ahead; played sections are retired as the playhead moves, so
+// memory stays constant however long it runs. Generated sections get the
+// next variation of their shape, so their seeds (and generated patterns)
+// do not depend on where the window is.
+class EndlessArrangement {
+public:
+    // Play intro first, then continue from its last section with generated ones
+    EndlessArrangement(std::vector<Section> intro, ArrangementRules rules, uint32_t seed, size_t lookahead = 4);
+
+    // Retire sections before playingSection (numbered from the start) and
+    // top up the window. Returns true if the window changed.
+    bool advance(uint64_t playingSection);
+
+    [[nodiscard]] const std::vector<Section>& getSections() const { return m_window; }
+    [[nodiscard]] uint64_t getFirstSection() const { return m_firstSection; }
+    [[nodiscard]] int64_t getFirstBeat() const { return m_firstBeat; }
+
+private:
+    ArrangementGenerator m_generator;
+    std::vector<Section> m_intro; // Released once consumed
+    size_t m_introNext = 0;
+    size_t m_lookahead;
+
+    std::vector<Section> m_window;
+    uint64_t m_firstSection = 0; // Number of m_window[0]
+    int64_t m_firstBeat = 0;     // Beats played before m_window[0]
+    SectionVariations m_variations; // Intro and generated sections so far
+
+    [[nodiscard]] Section nextSection();
+};
+
+} // namespace IndustrialMusic
\ No newline at end of file
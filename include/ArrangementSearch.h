@@ -0,0 +1,75 @@
+#pragma once
+
+#include "Common.h"
+#include "ArrangementGenerator.h"
+
+namespace IndustrialMusic {
+
+class ThreadPool;
+
+// What an arrangement should look like, e.g. for a sync licensing brief
+struct ArrangementBrief {
+    float targetSeconds = 180.0f;
+    int tempo = 120;
+
+    // Desired energy (0-1) over the song, sampled at evenly spaced points
+    // from start to end; empty to ignore energy
+    std::vector<float> energyCurve;
+
+    // Energy of each section type on the same 0-1 scale
+    std::array<float, SECTION_TYPE_COUNT> sectionEnergy = {
+        0.2f,  // Intro
+        0.45f, // Verse
+        0.6f,  // PreChorus
+        0.9f,  // Chorus
+        0.5f,  // Bridge
+        0.7f,  // Instrumental
+        0.3f,  // Breakdown
+        0.25f  // Outro
+    };
+
+    // Candidates are drawn from these rules, and improbable transitions cost more
+    ArrangementRules rules = ArrangementRules::industrial();
+
+    size_t minSections = 6;
+    size_t maxSections = 14;
+    bool startWithIntro = true;
+    bool endWithOutro = true;
+
+    // Relative weight of each term in the cost
+    float durationWeight = 4.0f;
+    float energyWeight = 2.0f;
+    float transitionWeight = 0.25f;
+};
+
+struct ScoredArrangement {
+    std::vector<Section> sections;
+    float cost = 0.0f;         // Lower is better
+    float seconds = 0.0f;      // Length at the brief's tempo
+    float energyError = 0.0f;  // RMS distance from the energy curve
+    uint64_t candidate = 0;    // Index within the search, for reproducing it
+};
+
+// Proposes candidate arrangements from a brief's rules and keeps the best
+// top-K. Candidates are packed into one byte per section (type and a bar
+// count of 2, 4, 8 or 16) and scored in batches laid out as structure of
+// arrays, so the scoring loops run across many candidates at once and the
+// compiler vectorizes them. Batches are spread over the thread pool; the
+// result depends only on the brief, count and seed, not on the thread count.
+class ArrangementSearch {
+public:
+    static constexpr size_t MAX_SECTIONS = 16;
+
+    // Search on the given pool (nullptr searches serially). search() must
+    // not be called from a task running on the same pool.
+    void setThreadPool(ThreadPool* pool) { m_threadPool = pool; }
+
+    // Fails with InvalidParameter if the brief cannot produce candidates
+    [[nodiscard]] Result<std::vector<ScoredArrangement>> search(const ArrangementBrief& brief, uint64_t candidates,
+                                                                size_t topK, uint32_t seed) const;
+
+private:
+    ThreadPool* m_threadPool = nullptr;
+};
+
+} // namespace IndustrialMusic
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Common.h"
+#include "SongSnapshot.h"
 #include <atomic>
 #include <thread>
 #include <mutex>
@@ -38,6 +39,8 @@ public:
     // Playback info
     [[nodiscard]] float getCurrentBeat() const { return m_currentBeat.load(); }
     [[nodiscard]] int getCurrentSectionIndex() const { return m_currentSection.load(); }
+    // Playing section counted from the start of an endless song
+    [[nodiscard]] uint64_t getPlayingSectionNumber() const { return m_playingSectionNumber.load(); }
     [[nodiscard]] float getSectionProgress() const;
     [[nodiscard]] float getTotalProgress() const;
     
@@ -45,8 +48,13 @@ public:
     [[nodiscard]] std::span<const float> getFrequencyData() const;
     [[nodiscard]] float getAverageVolume() const;
     
-    // Song structure
-    void setSongSections(const std::vector<Section>& sections);
+    // Song sections and the notes to play (from the same PatternEngine the
+    // MIDI export uses). Publishing never blocks the audio thread; readers
+    // keep whichever snapshot they loaded until they are done with it.
+    // For a window of an endless song, firstSection and firstBeat place
+    // sections[0]; playback carries on across windows without a jump.
+    std::shared_ptr<const SongSnapshot> publishSong(SongSections sections, uint64_t firstSection = 0, int64_t firstBeat = 0);
+    [[nodiscard]] std::shared_ptr<const SongSnapshot> getSong() const { return m_song.load(); }
     
     // Continuous mode
     void setLooping(bool loop) { m_isLooping.store(loop); }
@@ -72,11 +80,12 @@ private:
     // Playback position
     std::atomic<float> m_currentBeat{0.0f};
     std::atomic<int> m_currentSection{0};
+    std::atomic<uint64_t> m_playingSectionNumber{0};
     std::chrono::steady_clock::time_point m_startTime;
+    int64_t m_songFirstBeat = 0; // Audio thread only; firstBeat of the snapshot last played
     
     // Song structure
-    std::vector<Section> m_sections;
-    mutable std::mutex m_sectionMutex;
+    SongSnapshotSlot m_song;
     
     // Audio data
     mutable std::array<float, 1024> m_frequencyData{};
@@ -99,19 +108,9 @@ private:
     void playSynth(float time, float frequency, float velocity, float duration);
     void playBass(float time, float frequency, float velocity, float duration);
     
-    // Pattern generation
-    struct DrumPattern {
-        bool kick = false;
-        bool snare = false;
-        bool hihat = false;
-        float kickVelocity = 1.0f;
-        float snareVelocity = 1.0f;
-        float hihatVelocity = 1.0f;
-    };
-    
-    [[nodiscard]] DrumPattern getDrumPattern(const Section& section, int beat, int intensity, float random) const;
-    [[nodiscard]] std::vector<std::pair<float, float>> getBassPattern(const Section& section, int intensity, uint32_t seed) const;
-    [[nodiscard]] std::vector<std::pair<float, float>> getSynthPattern(const Section& section, int intensity, uint32_t seed) const;
+    // Loudest velocity (0-1) among a section's notes sounding at tick,
+    // counted from the section start
+    [[nodiscard]] static float noteActivity(const SongSection& section, uint32_t tick);
     
     // Random number generation
     mutable std::mt19937 m_rng;
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "Common.h"
+#include <bit>
+#include <cstring>
+#include <filesystem>
+#include <string_view>
+#include <unordered_map>
+
+namespace IndustrialMusic {
+
+// Helpers shared by the binary file formats (project files, lyric models):
+// fixed-width little-endian records copied in and out with memcpy, tables
+// located by a header entry, and a deduplicating string table.
+
+// Records are written and read with memcpy in host order
+static_assert(std::endian::native == std::endian::little, "Binary formats assume a little-endian host");
+
+struct TableHeader {
+    uint32_t offset;
+    uint32_t count;
+    uint32_t stride;
+};
+
+struct StringRef {
+    uint32_t offset; // Within the string table
+    uint32_t length;
+};
+
+// Tables start on 8-byte boundaries
+constexpr size_t TABLE_ALIGNMENT = 8;
+
+template<typename T>
+T readRecord(const uint8_t* bytes) {
+    T value;
+    std::memcpy(&value, bytes, sizeof(T));
+    return value;
+}
+
+template<typename T>
+void appendRecord(std::vector<uint8_t>& out, const T& value) {
+    const auto* bytes = reinterpret_cast<const uint8_t*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+// Pad out to the next table boundary and return the table's offset
+inline uint32_t beginTable(std::vector<uint8_t>& out) {
+    out.resize((out.size() + TABLE_ALIGNMENT - 1) / TABLE_ALIGNMENT * TABLE_ALIGNMENT, 0);
+    return static_cast<uint32_t>(out.size());
+}
+
+// Location of one record table within a mapped file
+struct RecordTable {
+    const uint8_t* data = nullptr;
+    uint32_t count = 0;
+    uint32_t stride = 0;
+
+    [[nodiscard]] const uint8_t* record(size_t index) const { return data + index * stride; }
+
+    // Locate a table, checking it lies after the header and inside the file
+    // and that its records are at least recordSize bytes
+    [[nodiscard]] static bool map(std::span<const uint8_t> bytes, const TableHeader& table, size_t headerSize,
+                                  size_t recordSize, RecordTable& out) {
+        uint64_t end = table.offset + static_cast<uint64_t>(table.count) * table.stride;
+        if (table.count > 0 && (table.stride < recordSize || table.offset < headerSize || end > bytes.size())) {
+            return false;
+        }
+        out = {bytes.data() + table.offset, table.count, table.stride};
+        return true;
+    }
+};
+
+// Deduplicating string table; repeated strings are stored once
+class StringTableBuilder {
+public:
+    StringRef add(std::string_view text) {
+        auto [it, inserted] = m_offsets.try_emplace(text, static_cast<uint32_t>(m_bytes.size()));
+        if (inserted) {
+            m_bytes.insert(m_bytes.end(), text.begin(), text.end());
+        }
+        return {it->second, static_cast<uint32_t>(text.size())};
+    }
+
+    [[nodiscard]] const std::vector<uint8_t>& bytes() const { return m_bytes; }
+
+private:
+    std::vector<uint8_t> m_bytes;
+    std::unordered_map<std::string_view, uint32_t> m_offsets; // Views into the caller's strings
+};
+
+// Write beside the target and rename over it, so a crash never leaves a
+// half-written file and an open mapping of the old file stays valid
+[[nodiscard]] Result<void> writeFileAtomically(const std::filesystem::path& filepath, std::span<const uint8_t> bytes);
+
+} // namespace IndustrialMusic
\ No newline at end of file
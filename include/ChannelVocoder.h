@@ -0,0 +1,78 @@
+#pragma once
+
+#include "Common.h"
+
+namespace IndustrialMusic {
+
+struct VocoderSettings {
+    size_t bands = 16;             // 16-32, rounded up to a multiple of 8
+    float lowFrequency = 100.0f;   // Centre of the lowest band, Hz
+    float highFrequency = 7000.0f; // Centre of the highest band, Hz
+    float carrierPitch = 55.0f;    // Hz
+    float noise = 0.1f;            // Noise in the carrier, so consonants come through
+    float attack = 0.002f;         // Envelope follower, seconds
+    float release = 0.025f;
+    float gain = 1.0f;
+};
+
+// Channel vocoder: the input (the modulator, usually a voice) is split into
+// log-spaced bands by a bank of bandpass biquads, each band's level is
+// followed, and the same bands of a synth carrier are scaled by those levels
+// and summed. The carrier is built like the renderer's synth voices: two
+// detuned saws over a square sub-octave, plus a little noise.
+//
+// Both banks are stored as structure-of-arrays, one lane per band, and each
+// sample runs every band in the same straight loops, so the compiler
+// processes LANES bands per instruction. Coefficients are recomputed only
+// when the settings or sample rate change; processing never allocates.
+class ChannelVocoder {
+public:
+    static constexpr size_t LANES = 8;
+    static constexpr size_t MIN_BANDS = 16;
+    static constexpr size_t MAX_BANDS = 32;
+
+    explicit ChannelVocoder(const VocoderSettings& settings = {}) : m_settings(settings) {}
+
+    void setSettings(const VocoderSettings& settings);
+    [[nodiscard]] const VocoderSettings& getSettings() const { return m_settings; }
+
+    void setCarrierPitch(float hz) { m_settings.carrierPitch = hz; }
+
+    // Bands in use, after rounding
+    [[nodiscard]] size_t getBandCount() const;
+
+    // Silence the filters, envelopes and carrier
+    void reset();
+
+    // Replace buffer (the modulator) with the vocoded carrier
+    void process(std::span<float> buffer, float sampleRate);
+
+private:
+    struct alignas(32) Bands {
+        std::array<float, MAX_BANDS> values{};
+    };
+
+    VocoderSettings m_settings;
+    float m_sampleRate = 0.0f; // Coefficients are for this rate; 0 forces an update
+    size_t m_bands = 0;
+
+    // Bandpass biquads (b1 is zero), shared by both banks
+    Bands m_b0, m_b2, m_a1, m_a2;
+    float m_attack = 0.0f;
+    float m_release = 0.0f;
+
+    // Transposed direct form II state
+    Bands m_analysisZ1, m_analysisZ2;
+    Bands m_synthesisZ1, m_synthesisZ2;
+    Bands m_envelope;
+
+    // Carrier
+    float m_phaseA = 0.0f;
+    float m_phaseB = 0.5f;
+    float m_subPhase = 0.0f;
+    uint32_t m_noise = 0x2545F491u;
+
+    void updateCoefficients(float sampleRate);
+};
+
+} // namespace IndustrialMusic
\ No newline at end of file
@@ -28,15 +28,20 @@ enum class SectionType {
     Outro
 };
 
+constexpr size_t SECTION_TYPE_COUNT = static_cast<size_t>(SectionType::Outro) + 1;
+
 struct Section {
     SectionType type;
     std::string name;
     int bars = 4;
     int beatsPerBar = 4;
+    uint32_t variation = 0; // Tells identical sections apart; part of their seed
     
     [[nodiscard]] constexpr int totalBeats() const noexcept {
         return bars * beatsPerBar;
     }
+    
+    bool operator==(const Section&) const = default;
 };
 
 // Audio parameters
@@ -64,6 +69,12 @@ struct MidiNote {
     uint32_t duration;
 };
 
+// Loop of notes imported from an existing file, used in place of a generated pattern
+struct GrooveTemplate {
+    std::vector<MidiNote> notes; // Ticks relative to the start of the loop
+    uint32_t lengthTicks = 0;
+};
+
 // Visualization data
 struct VisualizationData {
     std::array<float, 1024> frequencies{};
@@ -78,7 +89,10 @@ enum class ErrorCode {
     AudioInitFailed,
     MidiDeviceNotFound,
     FileWriteFailed,
-    InvalidParameter
+    InvalidParameter,
+    // Codes are printed as numbers, so new ones go last
+    FileReadFailed,
+    InvalidFileFormat
 };
 
 template<typename T>
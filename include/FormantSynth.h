@@ -0,0 +1,84 @@
+#pragma once
+
+#include "Common.h"
+#include "Phonemizer.h"
+
+namespace IndustrialMusic {
+
+// How a voice is excited and pitched
+struct VoiceSettings {
+    float pitch = 110.0f;        // Hz
+    float stressPitch = 0.1f;    // Stressed vowels sing this fraction higher
+    float jitter = 0.0f;         // Random pitch wobble per glottal period, as a fraction
+    float voicing = 1.0f;        // 0 whispers: the formants are excited by noise only
+    float openQuotient = 0.6f;   // Open part of each glottal period; lower is buzzier
+    float aspiration = 0.05f;    // Breath noise mixed into voiced sounds
+    float rate = 1.0f;           // Speaking speed
+    float gain = 0.5f;
+};
+
+// Parallel formant synthesizer (Klatt style) speaking phoneme lines. A
+// glottal pulse and a noise source excite a bank of two-pole resonators:
+// five formants, plus three high resonances that shape frication. Each
+// block's excitation is computed first; then every sample updates all
+// lanes of the structure-of-arrays bank with the same branch-free
+// operations (one vector wide with AVX) and sums them once. Formant
+// targets come from a phoneme table; they glide at control rate (every
+// CONTROL_SAMPLES) so coefficients are recomputed a few hundred times per
+// second, not per sample. Playing a line never allocates.
+class FormantSynth {
+public:
+    static constexpr size_t RESONATORS = 8;
+    static constexpr size_t CONTROL_SAMPLES = 32;
+
+    // Start speaking a line, replacing any line still playing. maxSeconds,
+    // when positive, speeds the line up to fit (up to twice as fast).
+    void start(std::shared_ptr<const PhonemeLine> line, const VoiceSettings& settings, float maxSeconds = 0.0f);
+    void stop() { m_line.reset(); }
+
+    [[nodiscard]] bool isActive() const { return m_line != nullptr; }
+
+    // Add the voice into out; returns false once the line has finished
+    bool render(std::span<float> out, float sampleRate);
+
+    // Length of a line at normal speed
+    [[nodiscard]] static float naturalSeconds(const PhonemeLine& line);
+
+private:
+    // Resonator bank, one lane per resonator
+    struct alignas(32) Lanes {
+        std::array<float, RESONATORS> values{};
+    };
+
+    std::shared_ptr<const PhonemeLine> m_line;
+    VoiceSettings m_settings;
+    size_t m_index = 0;          // Phoneme playing
+    float m_elapsed = 0.0f;      // Seconds into it
+    float m_duration = 0.0f;     // Its length at the current rate
+    float m_speed = 1.0f;
+    float m_release = 0.0f;      // Fades the voice after the last phoneme
+
+    // Smoothed control values
+    std::array<float, RESONATORS> m_frequency{};
+    float m_voiceLevel = 0.0f;
+    float m_noiseLevel = 0.0f;
+    float m_fricationLevel = 0.0f;
+
+    // Per-lane coefficients and gains, recomputed at control rate
+    Lanes m_a, m_b, m_c;
+    Lanes m_voiceGain, m_noiseGain;
+    Lanes m_y1, m_y2;
+
+    // Glottal source
+    float m_pitch = 0.0f;        // Smoothed target
+    float m_periodPitch = 0.0f;  // Of the current period, with jitter
+    float m_phase = 0.0f;
+    float m_previousFlow = 0.0f;
+    uint32_t m_noise = 0x9E3779B9u;
+
+    [[nodiscard]] float phonemeSeconds(const PhonemeEvent& event) const;
+    void updateControls(float sampleRate, float seconds);
+    [[nodiscard]] float noise();
+};
+
+} // namespace IndustrialMusic
\ No newline at end of file
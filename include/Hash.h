@@ -0,0 +1,93 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <format>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace IndustrialMusic {
+
+// splitmix64 increment (2^64 / golden ratio); also spreads small integers
+// apart before mixing
+constexpr uint64_t GOLDEN_GAMMA = 0x9E3779B97F4A7C15ull;
+
+// splitmix64 finalizer: every input bit affects every output bit
+[[nodiscard]] constexpr uint64_t mix64(uint64_t x) {
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+// 128-bit hash of everything an output depends on: cache keys, transform
+// fingerprints and rhyme classes. Values are added as little-endian bytes,
+// so keys are the same on every machine. Usable in constant expressions.
+class ContentHasher {
+public:
+    constexpr void add(std::span<const uint8_t> bytes) {
+        for (uint8_t byte : bytes) {
+            addByte(byte);
+        }
+    }
+
+    constexpr void add(std::string_view text) {
+        for (char c : text) {
+            addByte(static_cast<uint8_t>(c));
+        }
+    }
+
+    template<typename T>
+        requires std::is_integral_v<T> || std::is_enum_v<T>
+    constexpr void add(T value) {
+        if constexpr (std::is_enum_v<T>) {
+            add(std::to_underlying(value));
+        } else if constexpr (std::is_same_v<T, bool>) {
+            addByte(value ? 1 : 0);
+        } else {
+            const auto bits = static_cast<std::make_unsigned_t<T>>(value);
+            for (size_t i = 0; i < sizeof(T); ++i) {
+                addByte(static_cast<uint8_t>(bits >> (i * 8)));
+            }
+        }
+    }
+
+    // By bit pattern, so 0.0f and -0.0f differ
+    constexpr void add(float value) { add(std::bit_cast<uint32_t>(value)); }
+
+    // The low half of hex()
+    [[nodiscard]] constexpr uint64_t value() const { return finalize(m_low ^ m_length); }
+
+    // 32 lowercase hex digits
+    [[nodiscard]] std::string hex() const {
+        const uint64_t low = value();
+        return std::format("{:016x}{:016x}", finalize(m_high + low), low);
+    }
+
+private:
+    uint64_t m_low = 0xCBF29CE484222325ull;
+    uint64_t m_high = 0x84222325CBF29CE4ull;
+    uint64_t m_length = 0;
+
+    // Two independent FNV-1a style lanes with different primes
+    constexpr void addByte(uint8_t byte) {
+        m_low = (m_low ^ byte) * 0x100000001B3ull;
+        m_high = (m_high ^ byte) * GOLDEN_GAMMA;
+        m_high ^= m_high >> 29;
+        ++m_length;
+    }
+
+    // murmur3 finalizer
+    static constexpr uint64_t finalize(uint64_t x) {
+        x ^= x >> 33;
+        x *= 0xFF51AFD7ED558CCDull;
+        x ^= x >> 33;
+        x *= 0xC4CEB9FE1A85EC53ull;
+        x ^= x >> 33;
+        return x;
+    }
+};
+
+} // namespace IndustrialMusic
\ No newline at end of file
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Common.h"
+#include "SongSection.h"
+#include "SongStructure.h"
+
+namespace IndustrialMusic {
+
+class VocalSynthesizer;
+
+// The song being played and shown: every section's notes, lyrics and
+// vocals in a persistent sequence. Edits to the song structure are applied
+// as splices, so only the sections an edit inserts are built (through the
+// section caches) and everything else is shared with the previous version;
+// an edit costs the same however long the song is.
+class LiveSong {
+public:
+    // What every section is generated from; changing any of it means
+    // building the song again
+    struct Settings {
+        int intensity = 5;
+        uint32_t seed = 0;
+        uint32_t lyricsSeed = 0;
+    };
+
+    LiveSong(const PatternEngine& patterns, LyricsGenerator& lyrics, VocalSynthesizer& vocals);
+
+    // Prevent copying
+    LiveSong(const LiveSong&) = delete;
+    LiveSong& operator=(const LiveSong&) = delete;
+
+    // Build every section
+    void rebuild(const SectionList& sections, const Settings& settings);
+
+    // Replace `removed` sections at index by newly built ones for inserted
+    void splice(size_t index, size_t removed, const SectionList& inserted);
+
+    // Lyrics and vocals of every section again, from a new seed or, with
+    // the same one, after the word banks changed
+    void rebuildLyrics(uint32_t lyricsSeed);
+
+    // Lyrics as laid out by LyricsGenerator::generate (e.g. from a project
+    // file): split at section headers and handed to the sections in order
+    void setLyrics(const std::vector<std::string>& lyrics);
+
+    // Every section's lyrics behind their headers, as generate() lays them out
+    [[nodiscard]] std::vector<std::string> getLyrics() const;
+
+    [[nodiscard]] const SongSections& getSections() const { return m_sections; }
+    [[nodiscard]] const Settings& getSettings() const { return m_settings; }
+
+private:
+    const PatternEngine& m_patterns;
+    LyricsGenerator& m_lyrics;
+    VocalSynthesizer& m_vocals;
+
+    Settings m_settings;
+    SongSections m_sections;
+
+    [[nodiscard]] SongSection build(const Section& section) const;
+    [[nodiscard]] SongSection withLyrics(const SongSection& entry, std::shared_ptr<const SectionLyrics> lyrics) const;
+};
+
+} // namespace IndustrialMusic
\ No newline at end of file
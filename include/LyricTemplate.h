@@ -0,0 +1,107 @@
+#pragma once
+
+#include "Common.h"
+#include "Prosody.h"
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace IndustrialMusic {
+
+// Word banks a lyric template can draw from
+enum class LyricSlot : uint8_t {
+    Adjective, // {adj}
+    Noun,      // {noun}
+    Verb,      // {verb}
+    Theme      // {theme}
+};
+
+constexpr size_t LYRIC_SLOT_COUNT = 4;
+
+// A word chosen for a slot, with its entry from the bank's prosody table
+struct LyricWord {
+    std::string_view text;
+    WordProsody prosody;
+};
+
+// A lyric pattern such as "The {adj} {noun} {verb}s in silence", parsed
+// once into literal spans and slots so rendering a line is a run of
+// appends into the caller's buffer rather than find/replace passes that
+// reallocate for every placeholder. Unknown placeholders are kept as text.
+// The literal parts' prosody is worked out once too, so a drawn line's
+// syllable count and stresses come from table entries alone.
+class LyricTemplate {
+public:
+    // Placeholders after this many are kept as text
+    static constexpr size_t MAX_SLOTS = 8;
+
+    using Words = std::array<LyricWord, MAX_SLOTS>;
+
+    explicit LyricTemplate(std::string_view pattern);
+
+    [[nodiscard]] size_t getSlotCount() const { return m_slots.size(); }
+    [[nodiscard]] size_t getLiteralLength() const { return m_literalLength; }
+
+    // True when the line's last rhyming word is literal text ("...forever"),
+    // so no choice of words changes what it rhymes with
+    [[nodiscard]] bool hasFixedRhyme() const { return m_fixedRhyme; }
+
+    // Upper bound on a rendered line when no word is longer than maxWordLength
+    [[nodiscard]] size_t maxLength(size_t maxWordLength) const {
+        return m_literalLength + m_slots.size() * maxWordLength;
+    }
+
+    // Choose a word for every slot, with pick(LyricSlot) returning a
+    // LyricWord. Words are drawn kind by kind (every adjective, then every
+    // noun, verb and theme, left to right within a kind), the order the
+    // find/replace passes consumed random numbers in.
+    template<typename Pick>
+    void draw(Words& words, Pick&& pick) const {
+        for (uint8_t slot : m_drawOrder) {
+            words[slot] = pick(m_slots[slot]);
+        }
+    }
+
+    // Prosody of the line the drawn words would render
+    [[nodiscard]] LineProsody prosody(const Words& words) const {
+        LineProsody line;
+        for (const Token& token : m_tokens) {
+            if (token.slot == LITERAL) {
+                line.append(token.prosody);
+            } else {
+                line.append(words[token.slot].prosody);
+            }
+        }
+        return line;
+    }
+
+    // Append the line with the drawn words to out
+    void render(std::string& out, const Words& words) const {
+        for (const Token& token : m_tokens) {
+            if (token.slot == LITERAL) {
+                out.append(m_text, token.offset, token.length);
+            } else {
+                out.append(words[token.slot].text);
+            }
+        }
+    }
+
+private:
+    static constexpr uint8_t LITERAL = 0xFF;
+
+    struct Token {
+        uint32_t offset = 0; // Into m_text, for literals
+        uint32_t length = 0;
+        uint8_t slot = LITERAL; // Index into m_slots otherwise
+        LineProsody prosody;    // Of the literal text
+    };
+
+    std::string m_text;
+    std::vector<Token> m_tokens;
+    std::vector<LyricSlot> m_slots;   // In the order they appear
+    std::vector<uint8_t> m_drawOrder; // Slot indices grouped by kind
+    size_t m_literalLength = 0;
+    bool m_fixedRhyme = false;
+};
+
+} // namespace IndustrialMusic
\ No newline at end of file
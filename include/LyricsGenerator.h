@@ -1,26 +1,72 @@
 #pragma once
 
 #include "Common.h"
+#include "SectionCache.h"
+#include "LyricTemplate.h"
 #include <string>
 #include <vector>
 #include <random>
 #include <filesystem>
+#include <optional>
 
 namespace IndustrialMusic {
 
+class NgramModel;
+class WordBankPack;
+
+// One section's lines after its header, ending with a blank line, and
+// their prosody (empty when the lines were not generated)
+struct SectionLyrics {
+    std::vector<std::string> lines;
+    std::vector<LineProsody> prosody;
+};
+
 class LyricsGenerator {
 public:
     LyricsGenerator();
     ~LyricsGenerator() = default;
     
-    // Generate lyrics for a song structure
+    // Generate lyrics for a song structure. Each section is seeded on its
+    // own, so its lines do not depend on the sections before it. Every line
+    // is fitted to its share of the section's beats at up to
+    // MAX_SYLLABLES_PER_BEAT, and tries to rhyme with the line before it.
+    // prosody, when given, receives one entry per returned line (no
+    // syllables for section headers and blank lines).
     [[nodiscard]] std::vector<std::string> generate(
         const std::vector<Section>& sections,
-        uint32_t seed = 0
+        uint32_t seed = 0,
+        std::vector<LineProsody>* prosody = nullptr
     );
     
+    // The lines generate() gives one section of a song generated with seed,
+    // from the section cache when it is enabled
+    [[nodiscard]] std::shared_ptr<const SectionLyrics> generateSection(const Section& section, uint32_t seed);
+    
+    // The header generate() puts before a section's lines, or nullopt for
+    // sections without sung lines. verseCount counts the verses so far and
+    // numbers their headers.
+    [[nodiscard]] static std::optional<std::string> sectionHeader(const Section& section, int& verseCount);
+    
+    // Keep each section's lines so regenerating after an edit only rebuilds
+    // the sections that changed (0 disables caching)
+    void setSectionCacheCapacity(size_t sections);
+    
+    // Draw one section type's lines from a trained n-gram model instead of
+    // the built-in templates (nullptr restores them). Models are read-only
+    // and can be shared between generators on any number of threads.
+    void setLanguageModel(SectionType type, std::shared_ptr<const NgramModel> model);
+    
+    // Fill template slots from a loaded word-bank pack, drawn by weight;
+    // slots the pack has no words for keep the built-in banks (nullptr
+    // restores them all). Takes effect from the next generate().
+    void setWordBankPack(std::shared_ptr<const WordBankPack> pack);
+    [[nodiscard]] const std::shared_ptr<const WordBankPack>& getWordBankPack() const { return m_wordPack; }
+    
     // Regenerate with new seed
-    [[nodiscard]] std::vector<std::string> regenerate();
+    [[nodiscard]] std::vector<std::string> regenerate(
+        const std::vector<Section>& sections,
+        std::vector<LineProsody>* prosody = nullptr
+    );
     
     // Export lyrics to text file
     [[nodiscard]] Result<void> exportToFile(
@@ -29,24 +75,34 @@ public:
     );
     
 private:
-    uint32_t m_lastSeed = 0;
-    std::mt19937 m_rng;
+    // A language model and the prosody of each of its words
+    struct LanguageModel {
+        std::shared_ptr<const NgramModel> model;
+        std::shared_ptr<const std::vector<WordProsody>> prosody;
+    };
     
-    // Industrial-themed word banks
-    static const std::vector<std::string> INDUSTRIAL_NOUNS;
-    static const std::vector<std::string> INDUSTRIAL_VERBS;
-    static const std::vector<std::string> INDUSTRIAL_ADJECTIVES;
-    static const std::vector<std::string> THEMES;
+    uint32_t m_lastSeed = 0;
+    std::minstd_rand m_rng; // Reseeded per section, so it must be cheap to seed
+    std::unique_ptr<SectionCache<SectionLyrics>> m_sectionCache;
+    std::array<LanguageModel, SECTION_TYPE_COUNT> m_models;
+    std::shared_ptr<const WordBankPack> m_wordPack;
     
     // Generation methods
-    [[nodiscard]] std::string generateLine(SectionType type, int lineIndex);
-    [[nodiscard]] std::string generateChorus();
-    [[nodiscard]] std::string generateVerse(int verseNumber);
-    [[nodiscard]] std::string generateBridge();
+    [[nodiscard]] SectionLyrics buildSection(const Section& section, uint32_t seed);
+    [[nodiscard]] const LyricTemplate& chooseTemplate(SectionType type, size_t lineIndex);
+    
+    // Draw a line up to FIT_ATTEMPTS times and keep the first that fits
+    // the syllable budget and rhymes with rhymeWith (0 for any), or else
+    // the closest; only the kept line is rendered
+    [[nodiscard]] std::string fitTemplateLine(const LyricTemplate& line, size_t budget, uint16_t rhymeWith,
+                                              LineProsody& prosody);
+    [[nodiscard]] std::string fitModelLine(const LanguageModel& model, size_t budget, uint16_t rhymeWith,
+                                           LineProsody& prosody);
     
     // Helper methods
-    [[nodiscard]] std::string pickRandom(const std::vector<std::string>& words);
-    [[nodiscard]] std::string generatePhrase(const std::string& pattern);
+    [[nodiscard]] size_t pickIndex(size_t count);
+    [[nodiscard]] uint64_t randomBits();
+    [[nodiscard]] LyricWord pickWord(LyricSlot slot);
 };
 
 } // namespace IndustrialMusic
\ No newline at end of file
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Common.h"
+#include <filesystem>
+
+namespace IndustrialMusic {
+
+// Read-only memory mapping of a whole file. The mapping is released when
+// the object is destroyed; views into bytes() must not outlive it.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    // Prevent copying
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Allow moving
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    [[nodiscard]] static Result<MappedFile> open(const std::filesystem::path& filepath);
+
+    [[nodiscard]] std::span<const uint8_t> bytes() const { return {m_data, m_size}; }
+    [[nodiscard]] size_t size() const { return m_size; }
+    [[nodiscard]] bool empty() const { return m_size == 0; }
+
+private:
+    const uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+
+    void release();
+};
+
+} // namespace IndustrialMusic
\ No newline at end of file
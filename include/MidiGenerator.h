@@ -1,31 +1,105 @@
 #pragma once
 
 #include "Common.h"
-#include <libremidi/libremidi.hpp>
+#include "MappedFile.h"
+#include "MidiWriter.h"
+#include "MidiScheduler.h"
+#include "PatternEngine.h"
 #include <filesystem>
+#include <generator>
+#include <optional>
+#include <variant>
 
 namespace IndustrialMusic {
 
+class ThreadPool;
+class SongCache;
+
+// A generated MIDI file: built in memory, or a song cache entry mapped in
+// place so a cache hit copies nothing. bytes() is valid for the lifetime
+// of the object, including after it is moved.
+class MidiBytes {
+public:
+    MidiBytes(std::vector<uint8_t> bytes) : m_storage(std::move(bytes)) {}
+    MidiBytes(MappedFile file) : m_storage(std::move(file)) {}
+
+    [[nodiscard]] std::span<const uint8_t> bytes() const {
+        if (const auto* file = std::get_if<MappedFile>(&m_storage)) {
+            return file->bytes();
+        }
+        return std::get<std::vector<uint8_t>>(m_storage);
+    }
+
+    // Contiguous range, so it converts to std::span<const uint8_t>
+    [[nodiscard]] const uint8_t* data() const { return bytes().data(); }
+    [[nodiscard]] size_t size() const { return bytes().size(); }
+    [[nodiscard]] const uint8_t* begin() const { return data(); }
+    [[nodiscard]] const uint8_t* end() const { return data() + size(); }
+
+private:
+    std::variant<std::vector<uint8_t>, MappedFile> m_storage;
+};
+
 class MidiGenerator {
 public:
     MidiGenerator();
     ~MidiGenerator() = default;
     
     // Generate MIDI file from song structure
-    [[nodiscard]] Result<std::vector<uint8_t>> generate(
+    [[nodiscard]] Result<MidiBytes> generate(
         const std::vector<Section>& sections,
         const AudioParams& params,
         uint32_t seed = 0
     );
     
+    // Build tracks concurrently on the given pool (nullptr generates serially).
+    // Output is byte-identical either way. generate() must not be called from
+    // a task running on the same pool.
+    void setThreadPool(ThreadPool* pool) { m_threadPool = pool; }
+    
+    // Serve repeated requests from a persistent cache (nullptr disables).
+    // The cache may be shared between generators and threads.
+    void setSongCache(SongCache* cache) { m_songCache = cache; }
+    
+    // Part of every song cache key; bump whenever generated bytes change
+    static constexpr uint32_t GENERATOR_VERSION = 4;
+    
+    // Generate straight to disk through a lazy pipeline
+    // (sections -> pattern events -> encoded bytes -> buffered file sink).
+    // Memory use does not grow with song length; bytes match generate().
+    [[nodiscard]] Result<void> generateToFile(
+        const std::vector<Section>& sections,
+        const AudioParams& params,
+        const std::filesystem::path& filepath,
+        uint32_t seed = 0
+    );
+    
+    // Groove templates: the first track with notes in an existing MIDI file
+    // replaces the generated pattern for a part, looped across each section
+    using Part = PatternPart;
+    [[nodiscard]] Result<void> loadGrooveTemplate(Part part, const std::filesystem::path& filepath);
+    void setGrooveTemplate(Part part, std::optional<GrooveTemplate> groove);
+    
+    // Keep each section's generated notes, so regenerating after an edit only
+    // rebuilds the sections that changed (0 disables caching)
+    void setSectionCacheCapacity(size_t sections) { m_patternEngine.setSectionCacheCapacity(sections); }
+    
+    // Source of every note this generator encodes. Playback and audio
+    // rendering use it too, so they hear exactly what gets exported.
+    [[nodiscard]] PatternEngine& getPatternEngine() { return m_patternEngine; }
+    [[nodiscard]] const PatternEngine& getPatternEngine() const { return m_patternEngine; }
+    
     // Save MIDI to file
     [[nodiscard]] Result<void> saveToFile(
-        const std::vector<uint8_t>& midiData,
+        std::span<const uint8_t> midiData,
         const std::filesystem::path& filepath
     );
     
-    // Real-time MIDI output
+    // Real-time MIDI output. Messages go through the scheduler's output
+    // thread; the send* calls dispatch as soon as possible and never block.
     [[nodiscard]] Result<void> initializeMidiOutput();
+    void setMidiOutput(std::unique_ptr<MidiSink> sink);
+    [[nodiscard]] MidiScheduler* getMidiScheduler() { return m_midiScheduler.get(); }
     void sendMidiNote(uint8_t channel, uint8_t note, uint8_t velocity);
     void sendMidiCC(uint8_t channel, uint8_t controller, uint8_t value);
     void sendMidiProgramChange(uint8_t channel, uint8_t program);
@@ -34,54 +108,50 @@ public:
     [[nodiscard]] std::vector<std::string> getAvailableMidiOutputs() const;
     [[nodiscard]] Result<void> selectMidiOutput(size_t index);
     
+    // Upper-bound guess of the encoded file size, used to pre-size the output buffer
+    [[nodiscard]] static size_t estimateFileSize(const std::vector<Section>& sections);
+    
 private:
-    static constexpr uint16_t TICKS_PER_QUARTER = 480;
+    static constexpr uint16_t TICKS_PER_QUARTER = PatternEngine::TICKS_PER_QUARTER;
+    static constexpr uint16_t TRACK_COUNT = 6;
     
     // MIDI output
-    std::unique_ptr<libremidi::midi_out> m_midiOut;
+    std::unique_ptr<MidiScheduler> m_midiScheduler;
     size_t m_selectedOutput = 0;
     
-    // Track creation methods
-    [[nodiscard]] std::vector<uint8_t> createTempoTrack(uint32_t microsecondsPerQuarter, const std::vector<Section>& sections);
-    [[nodiscard]] std::vector<uint8_t> createDrumTrack(const std::vector<Section>& sections, int tempo, int intensity, uint32_t seed);
-    [[nodiscard]] std::vector<uint8_t> createBassTrack(const std::vector<Section>& sections, int intensity, uint32_t seed);
-    [[nodiscard]] std::vector<uint8_t> createLeadTrack(const std::vector<Section>& sections, int intensity, uint32_t seed);
-    [[nodiscard]] std::vector<uint8_t> createPadTrack(const std::vector<Section>& sections, int intensity, uint32_t seed);
-    [[nodiscard]] std::vector<uint8_t> createEffectsTrack(const std::vector<Section>& sections, int intensity, uint32_t seed);
-    
-    // Helper methods
-    [[nodiscard]] std::vector<uint8_t> encodeVariableLength(uint32_t value) const;
-    void addNoteOn(std::vector<uint8_t>& track, uint32_t deltaTicks, uint8_t channel, uint8_t note, uint8_t velocity);
-    void addNoteOff(std::vector<uint8_t>& track, uint32_t deltaTicks, uint8_t channel, uint8_t note);
-    void addControlChange(std::vector<uint8_t>& track, uint32_t deltaTicks, uint8_t channel, uint8_t controller, uint8_t value);
-    void addProgramChange(std::vector<uint8_t>& track, uint32_t deltaTicks, uint8_t channel, uint8_t program);
-    void updateTrackLength(std::vector<uint8_t>& track);
-    
-    // Pattern generation (similar to AudioEngine but for MIDI)
-    [[nodiscard]] std::vector<MidiNote> generateDrumPattern(const Section& section, int intensity, uint32_t seed) const;
-    [[nodiscard]] std::vector<MidiNote> generateBassPattern(const Section& section, int intensity, uint32_t seed) const;
-    [[nodiscard]] std::vector<MidiNote> generateLeadPattern(const Section& section, int intensity, uint32_t seed) const;
-    
-    // Note mapping
-    static constexpr uint8_t DRUM_CHANNEL = 9; // MIDI channel 10 (0-indexed)
-    static constexpr uint8_t KICK_NOTE = 36;   // C1
-    static constexpr uint8_t SNARE_NOTE = 38;  // D1
-    static constexpr uint8_t HIHAT_CLOSED = 42; // F#1
-    static constexpr uint8_t HIHAT_OPEN = 46;   // A#1
-    static constexpr uint8_t CRASH_NOTE = 49;   // C#2
-    static constexpr uint8_t RIDE_NOTE = 51;    // D#2
-    
-    // Bass notes (industrial style - low frequencies)
-    static constexpr std::array<uint8_t, 12> BASS_NOTES = {
-        24, 26, 27, 29, 31, 32, 34, 36, 38, 39, 41, 43 // C1 to G2
-    };
+    // Optional pool for parallel track generation (not owned)
+    ThreadPool* m_threadPool = nullptr;
     
-    // Lead notes (industrial style - mid to high frequencies)
-    static constexpr std::array<uint8_t, 24> LEAD_NOTES = {
-        48, 50, 51, 53, 55, 56, 58, 60, // C3 to C4
-        62, 63, 65, 67, 68, 70, 72, 74, // D4 to D5
-        75, 77, 79, 80, 82, 84, 86, 87  // D#5 to D#6
+    // Optional persistent cache of finished files (not owned)
+    SongCache* m_songCache = nullptr;
+    
+    // Patterns, imported grooves and the section cache
+    PatternEngine m_patternEngine;
+    
+    // Encoded bytes are handed down the pipeline in chunks of about this size
+    static constexpr size_t STREAM_CHUNK_BYTES = 16 * 1024;
+    
+    // Writes one complete MTrk chunk. Tracks only read their arguments,
+    // so different tracks can be built concurrently.
+    [[nodiscard]] Result<std::vector<uint8_t>> generateUncached(const std::vector<Section>& sections, const AudioParams& params, uint32_t seed) const;
+    [[nodiscard]] Result<void> streamToFile(const std::vector<Section>& sections, const AudioParams& params, const std::filesystem::path& filepath, uint32_t seed) const;
+    [[nodiscard]] std::string songCacheKey(const std::vector<Section>& sections, const AudioParams& params, uint32_t seed) const;
+    
+    void createTrack(MidiWriter& out, size_t trackIndex, const std::vector<Section>& sections, const AudioParams& params, uint32_t seed) const;
+    
+    // Pipeline stages
+    struct SectionSpan {
+        const Section* section;
+        uint32_t startTick;
     };
+    [[nodiscard]] std::generator<SectionSpan> sectionStream(const std::vector<Section>& sections) const;
+    static void buildSectionEvents(const NoteStream& notes, std::vector<MidiEvent>& events, std::vector<MidiEvent>& scratch);
+    [[nodiscard]] std::generator<const MidiEvent&> noteEvents(const std::vector<Section>& sections, int intensity, uint32_t seed, PatternPart part) const;
+    [[nodiscard]] std::generator<std::span<const uint8_t>> encodeTrack(size_t trackIndex, const std::vector<Section>& sections, const AudioParams& params, uint32_t seed) const;
+    
+    // Track layout: meta/program events at the start of each track and its note source
+    void writeTrackPrologue(MidiWriter& out, size_t trackIndex, const AudioParams& params) const;
+    [[nodiscard]] static std::optional<PatternPart> trackPart(size_t trackIndex);
 };
 
 } // namespace IndustrialMusic
\ No newline at end of file
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "Common.h"
+#include "MappedFile.h"
+#include <iterator>
+
+namespace IndustrialMusic {
+
+// One event as stored in a track. data points straight into the file bytes.
+struct MidiFileEvent {
+    uint32_t tick = 0;             // Absolute tick from the start of the track
+    uint8_t status = 0;            // Channel status, 0xFF for meta, 0xF0/0xF7 for sysex
+    uint8_t metaType = 0;          // Meta event type when status is 0xFF
+    std::span<const uint8_t> data; // Channel data bytes, or the meta/sysex payload
+};
+
+// Forward-only, zero-copy view of the events in one MTrk chunk.
+// Running status is resolved while iterating; iteration stops early at the
+// first malformed or truncated event.
+class MidiTrackView {
+public:
+    class iterator {
+    public:
+        using value_type = MidiFileEvent;
+        using difference_type = std::ptrdiff_t;
+
+        iterator() = default;
+        explicit iterator(std::span<const uint8_t> bytes)
+            : m_pos(bytes.data()), m_end(bytes.data() + bytes.size()) {
+            advance();
+        }
+
+        const MidiFileEvent& operator*() const { return m_event; }
+        const MidiFileEvent* operator->() const { return &m_event; }
+        iterator& operator++() { advance(); return *this; }
+        void operator++(int) { advance(); }
+        bool operator==(std::default_sentinel_t) const { return m_done; }
+
+    private:
+        const uint8_t* m_pos = nullptr;
+        const uint8_t* m_end = nullptr;
+        MidiFileEvent m_event;
+        uint8_t m_runningStatus = 0;
+        bool m_done = true;
+
+        void advance();
+        bool readVariableLength(uint32_t& value);
+    };
+
+    MidiTrackView() = default;
+    explicit MidiTrackView(std::span<const uint8_t> bytes) : m_bytes(bytes) {}
+
+    [[nodiscard]] iterator begin() const { return iterator(m_bytes); }
+    [[nodiscard]] std::default_sentinel_t end() const { return {}; }
+    [[nodiscard]] std::span<const uint8_t> bytes() const { return m_bytes; }
+
+private:
+    std::span<const uint8_t> m_bytes;
+};
+
+// Standard MIDI File reader. Files are memory-mapped and only the chunk
+// table is parsed up front; events are decoded lazily from the mapping.
+class MidiReader {
+public:
+    MidiReader() = default;
+
+    // Map and parse a file
+    [[nodiscard]] static Result<MidiReader> open(const std::filesystem::path& filepath);
+
+    // Parse bytes owned by the caller, which must outlive the reader
+    [[nodiscard]] static Result<MidiReader> parse(std::span<const uint8_t> bytes);
+
+    [[nodiscard]] uint16_t getFormat() const { return m_format; }
+    [[nodiscard]] uint16_t getTicksPerQuarter() const { return m_ticksPerQuarter; }
+    [[nodiscard]] size_t getTrackCount() const { return m_tracks.size(); }
+    [[nodiscard]] const std::vector<MidiTrackView>& getTracks() const { return m_tracks; }
+    [[nodiscard]] size_t getFileSize() const { return m_bytes.size(); }
+
+    // Pair note-ons with their note-offs; notes are ordered by start tick
+    [[nodiscard]] static std::vector<MidiNote> extractNotes(const MidiTrackView& track);
+
+    // First track with notes, rescaled to ticksPerQuarter and padded to whole bars
+    [[nodiscard]] Result<GrooveTemplate> extractGroove(uint16_t ticksPerQuarter, int beatsPerBar = 4) const;
+
+private:
+    MappedFile m_file;
+    std::span<const uint8_t> m_bytes;
+    uint16_t m_format = 0;
+    uint16_t m_ticksPerQuarter = 0;
+    std::vector<MidiTrackView> m_tracks;
+
+    [[nodiscard]] Result<void> readChunks();
+};
+
+} // namespace IndustrialMusic
\ No newline at end of file
@@ -0,0 +1,163 @@
+#pragma once
+
+#include "Common.h"
+#include "BoundedQueue.h"
+#include <thread>
+#include <mutex>
+
+namespace libremidi {
+class midi_out;
+}
+
+namespace IndustrialMusic {
+
+// A channel message of up to three bytes, stored inline
+struct MidiMessage {
+    std::array<uint8_t, 3> bytes{};
+    uint8_t size = 0;
+
+    [[nodiscard]] std::span<const uint8_t> view() const { return {bytes.data(), size}; }
+
+    [[nodiscard]] static MidiMessage noteOn(uint8_t channel, uint8_t note, uint8_t velocity) {
+        return {{static_cast<uint8_t>(0x90 | (channel & 0x0F)), note, velocity}, 3};
+    }
+    [[nodiscard]] static MidiMessage noteOff(uint8_t channel, uint8_t note) {
+        return {{static_cast<uint8_t>(0x80 | (channel & 0x0F)), note, 0}, 3};
+    }
+    [[nodiscard]] static MidiMessage controlChange(uint8_t channel, uint8_t controller, uint8_t value) {
+        return {{static_cast<uint8_t>(0xB0 | (channel & 0x0F)), controller, value}, 3};
+    }
+    [[nodiscard]] static MidiMessage programChange(uint8_t channel, uint8_t program) {
+        return {{static_cast<uint8_t>(0xC0 | (channel & 0x0F)), program, 0}, 2};
+    }
+};
+
+// Destination for scheduled messages. send() is only called from the
+// scheduler's output thread.
+class MidiSink {
+public:
+    virtual ~MidiSink() = default;
+    virtual void send(std::span<const uint8_t> message) = 0;
+};
+
+// Hardware/virtual port output through libremidi
+class LibremidiSink : public MidiSink {
+public:
+    ~LibremidiSink() override;
+
+    [[nodiscard]] static std::vector<std::string> availableOutputs();
+    [[nodiscard]] static Result<std::unique_ptr<LibremidiSink>> open(size_t index);
+
+    void send(std::span<const uint8_t> message) override;
+
+private:
+    LibremidiSink() = default;
+
+    std::unique_ptr<libremidi::midi_out> m_out;
+};
+
+// Records everything it receives with the time it arrived
+class LoopbackSink : public MidiSink {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Received {
+        MidiMessage message;
+        Clock::time_point time;
+    };
+
+    // Storage is reserved up front; messages beyond capacity are counted but not kept
+    explicit LoopbackSink(size_t capacity = 1 << 16);
+
+    void send(std::span<const uint8_t> message) override;
+
+    [[nodiscard]] std::vector<Received> received() const;
+    [[nodiscard]] size_t count() const;
+    void clear();
+
+private:
+    mutable std::mutex m_mutex;
+    std::vector<Received> m_received;
+    size_t m_count = 0;
+};
+
+// Dedicated output thread that sends timestamped messages at their due time.
+// Producers push into a lock-free queue; the output thread moves messages into
+// a lookahead heap ordered by time (ties keep submission order), sleeps until
+// shortly before the earliest one and spins for the rest, so dispatch jitter
+// is bounded by the spin loop rather than the OS sleep granularity.
+class MidiScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct JitterStats {
+        uint64_t messages = 0;          // Messages dispatched
+        uint64_t dropped = 0;           // Messages rejected because the queue was full
+        std::chrono::nanoseconds mean{};
+        std::chrono::nanoseconds p99{}; // Upper bound of the 99th percentile bucket
+        std::chrono::nanoseconds max{};
+    };
+
+    explicit MidiScheduler(std::unique_ptr<MidiSink> sink);
+    ~MidiScheduler();
+
+    // Prevent copying and moving (the output thread holds a pointer to the scheduler)
+    MidiScheduler(const MidiScheduler&) = delete;
+    MidiScheduler& operator=(const MidiScheduler&) = delete;
+
+    // Safe to call from any thread. Returns false if the queue is full.
+    bool schedule(const MidiMessage& message, Clock::time_point time);
+    bool sendNow(const MidiMessage& message) { return schedule(message, Clock::now()); }
+
+    [[nodiscard]] JitterStats getJitterStats() const;
+    void resetJitterStats();
+
+    [[nodiscard]] MidiSink& getSink() { return *m_sink; }
+
+    static constexpr size_t QUEUE_CAPACITY = 4096;
+    static constexpr size_t LOOKAHEAD_CAPACITY = 16384;
+
+private:
+    struct ScheduledMessage {
+        Clock::time_point time;
+        MidiMessage message;
+    };
+
+    struct PendingMessage {
+        Clock::time_point time;
+        uint64_t order;
+        MidiMessage message;
+    };
+
+    // Sleep until this long before the next message, then spin
+    static constexpr auto SPIN_WINDOW = std::chrono::microseconds(500);
+    // Longest sleep, so messages earlier than the current head are picked up
+    static constexpr auto POLL_INTERVAL = std::chrono::milliseconds(1);
+    static constexpr size_t HISTOGRAM_BUCKETS = 40;
+
+    std::unique_ptr<MidiSink> m_sink;
+    BoundedQueue<ScheduledMessage, QUEUE_CAPACITY> m_queue;
+
+    // Owned by the output thread
+    std::vector<PendingMessage> m_pending;
+    uint64_t m_nextOrder = 0;
+    uint16_t m_activeChannels = 0;
+
+    // Jitter measurements, written by the output thread only
+    std::atomic<uint64_t> m_dispatched{0};
+    std::atomic<uint64_t> m_dropped{0};
+    std::atomic<uint64_t> m_jitterSumNs{0};
+    std::atomic<uint64_t> m_jitterMaxNs{0};
+    std::array<std::atomic<uint64_t>, HISTOGRAM_BUCKETS> m_histogram{};
+
+    std::atomic<uint32_t> m_wake{0};
+    std::atomic<bool> m_stopping{false};
+    std::thread m_thread;
+
+    void run();
+    void drainQueue();
+    void dispatch(const PendingMessage& pending);
+    void recordJitter(Clock::duration lateness);
+};
+
+} // namespace IndustrialMusic
\ No newline at end of file
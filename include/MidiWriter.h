@@ -0,0 +1,143 @@
+#pragma once
+
+#include "Common.h"
+#include <string_view>
+#include <filesystem>
+#include <fstream>
+
+namespace IndustrialMusic {
+
+// A single channel event at an absolute tick, as laid out in a track
+struct MidiEvent {
+    uint32_t tick;
+    uint8_t status;
+    uint8_t data1;
+    uint8_t data2;
+};
+
+// Stable LSD radix sort on tick; only the bytes that actually vary are sorted.
+// scratch is working space that callers can reuse between sorts.
+void sortEventsByTick(std::vector<MidiEvent>& events, std::vector<MidiEvent>& scratch);
+
+// Serialises a Standard MIDI File into a single contiguous buffer.
+// The buffer is sized up front, delta times are VLQ-encoded in place and
+// each MTrk length is back-patched when the track is closed, so writing an
+// event never allocates unless the initial size estimate was too small.
+// Channel events use running status: the status byte is only written when it
+// differs from the previous channel event in the track.
+class MidiWriter {
+public:
+    explicit MidiWriter(size_t expectedSize = 0);
+
+    // Chunks
+    void writeHeader(uint16_t format, uint16_t trackCount, uint16_t ticksPerQuarter);
+    void beginTrack();
+    void endTrack();
+
+    // Events
+    void writeChannelEvent(uint32_t deltaTicks, uint8_t status, uint8_t data1, uint8_t data2) {
+        uint8_t* out = grow(7);
+        out = encodeVariableLength(out, deltaTicks);
+        if (status != m_runningStatus) {
+            *out++ = status;
+            m_runningStatus = status;
+        }
+        out[0] = data1;
+        out[1] = data2;
+        m_size = static_cast<size_t>(out + 2 - m_data.data());
+        m_trackTick += deltaTicks;
+    }
+
+    void writeChannelEvent(uint32_t deltaTicks, uint8_t status, uint8_t data1) {
+        uint8_t* out = grow(6);
+        out = encodeVariableLength(out, deltaTicks);
+        if (status != m_runningStatus) {
+            *out++ = status;
+            m_runningStatus = status;
+        }
+        out[0] = data1;
+        m_size = static_cast<size_t>(out + 1 - m_data.data());
+        m_trackTick += deltaTicks;
+    }
+
+    // Writes an event at an absolute tick at or after the current track position
+    void writeEvent(const MidiEvent& event) {
+        writeChannelEvent(event.tick - m_trackTick, event.status, event.data1, event.data2);
+    }
+
+    // Writes events sorted by absolute tick, starting from the current track position
+    void writeEvents(std::span<const MidiEvent> events);
+
+    void writeMetaEvent(uint32_t deltaTicks, uint8_t type, std::span<const uint8_t> data);
+    void writeTextEvent(uint32_t deltaTicks, uint8_t type, std::string_view text);
+
+    // Raw output
+    void writeVariableLength(uint32_t value) {
+        uint8_t* out = grow(4);
+        m_size = static_cast<size_t>(encodeVariableLength(out, value) - m_data.data());
+    }
+
+    void writeBytes(std::span<const uint8_t> bytes);
+
+    [[nodiscard]] size_t size() const { return m_size; }
+    [[nodiscard]] std::span<const uint8_t> data() const { return {m_data.data(), m_size}; }
+
+    // Hand the finished file over, trimmed to its written size
+    [[nodiscard]] std::vector<uint8_t> release();
+
+    // Drop the written bytes but keep the track position and running status,
+    // so encoding can carry on into a fresh chunk once the old one is consumed
+    void clear() { m_size = 0; m_trackStart = 0; }
+
+    // Encodes value (at most 28 bits) at out and returns one past the last byte written
+    static uint8_t* encodeVariableLength(uint8_t* out, uint32_t value) {
+        if (value >= (1u << 21)) *out++ = static_cast<uint8_t>(((value >> 21) & 0x7F) | 0x80);
+        if (value >= (1u << 14)) *out++ = static_cast<uint8_t>(((value >> 14) & 0x7F) | 0x80);
+        if (value >= (1u << 7))  *out++ = static_cast<uint8_t>(((value >> 7) & 0x7F) | 0x80);
+        *out++ = static_cast<uint8_t>(value & 0x7F);
+        return out;
+    }
+
+private:
+    std::vector<uint8_t> m_data;
+    size_t m_size = 0;
+    size_t m_trackStart = 0;
+    uint32_t m_trackTick = 0;
+    uint8_t m_runningStatus = 0;
+
+    // Returns a cursor with room for at least `bytes` more bytes
+    uint8_t* grow(size_t bytes) {
+        if (m_size + bytes > m_data.size()) {
+            m_data.resize(std::max(m_data.size() * 2, m_size + bytes));
+        }
+        return m_data.data() + m_size;
+    }
+};
+
+// Buffered file output for streamed MIDI. A track's length is only known
+// once it is complete, so endTrack() seeks back and patches the MTrk header.
+class MidiFileSink {
+public:
+    explicit MidiFileSink(const std::filesystem::path& filepath, size_t bufferSize = 64 * 1024);
+    ~MidiFileSink() = default;
+
+    [[nodiscard]] bool isOpen() const { return m_file.is_open(); }
+
+    void write(std::span<const uint8_t> bytes);
+    void beginTrack();
+    void endTrack();
+
+    // Flush and close, reporting any write failure
+    [[nodiscard]] Result<void> close();
+
+private:
+    std::ofstream m_file;
+    std::vector<uint8_t> m_buffer;
+    size_t m_used = 0;
+    uint64_t m_written = 0;    // Bytes passed to write() so far
+    uint64_t m_trackStart = 0;
+
+    void flush();
+};
+
+} // namespace IndustrialMusic
\ No newline at end of file
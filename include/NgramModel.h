@@ -0,0 +1,97 @@
+#pragma once
+
+#include "Common.h"
+#include "MappedFile.h"
+#include "BinaryRecords.h"
+#include "Prosody.h"
+#include <filesystem>
+#include <string_view>
+
+namespace IndustrialMusic {
+
+// Word n-gram language model trained from a lyric corpus and stored as a
+// compact binary file (.imlm) that is memory-mapped on open. Contexts (the
+// previous order - 1 words) are placed by a hash-and-displace perfect hash,
+// so finding one is two hashes and two table reads. Each context's next
+// words form a Walker alias table with 16-bit quantized probabilities, so
+// sampling a word is O(1) whatever the vocabulary size.
+//
+// Opening only validates the header and table bounds, so even very large
+// models load instantly, and since the mapping is read-only every process
+// using the same file shares its pages.
+class NgramModel {
+public:
+    using Token = uint32_t;
+
+    // Marks the start and the end of a line
+    static constexpr Token BOUNDARY = 0;
+
+    static constexpr int MIN_ORDER = 2;
+    static constexpr int MAX_ORDER = 4;
+    static constexpr uint16_t FORMAT_VERSION = 1;
+    static constexpr const char* EXTENSION = ".imlm";
+
+    // Each line of the corpus is one lyric line. Words are runs of letters,
+    // digits and apostrophes, lowercased. Contexts keep at most 65535 next
+    // words (the most frequent). Fails with InvalidParameter if the order is
+    // out of range or the corpus has no words.
+    [[nodiscard]] static Result<std::vector<uint8_t>> train(std::string_view corpus, int order);
+
+    // Map and validate a file
+    [[nodiscard]] static Result<NgramModel> open(const std::filesystem::path& filepath);
+
+    // Validate bytes owned by the caller, which must outlive the model
+    [[nodiscard]] static Result<NgramModel> parse(std::span<const uint8_t> bytes);
+
+    [[nodiscard]] int getOrder() const { return m_order; }
+    [[nodiscard]] size_t getVocabularySize() const { return m_vocabulary.count; }
+    [[nodiscard]] size_t getContextCount() const { return m_contextCount; }
+    [[nodiscard]] size_t getFileSize() const { return m_bytes.size(); }
+
+    // Text of a token (empty for BOUNDARY or an unknown token)
+    [[nodiscard]] std::string_view word(Token token) const;
+
+    // Next token after history, the last order - 1 tokens padded on the left
+    // with BOUNDARY, chosen by 64 uniform random bits. Returns BOUNDARY
+    // (end of line) for a context the corpus never contained.
+    [[nodiscard]] Token next(std::span<const Token> history, uint64_t random) const;
+
+    // Sample one line into out, stopping at the end of the line or when out
+    // is full, and return the number of words
+    template<typename Rng>
+    size_t sampleLine(std::span<Token> out, Rng& rng) const {
+        std::array<Token, MAX_ORDER - 1> history{};
+        std::uniform_int_distribution<uint64_t> bits;
+        auto context = std::span<Token>(history).first(static_cast<size_t>(m_order - 1));
+
+        size_t count = 0;
+        for (; count < out.size(); ++count) {
+            Token token = next(context, bits(rng));
+            if (token == BOUNDARY) break;
+
+            out[count] = token;
+            std::shift_left(context.begin(), context.end(), 1);
+            context.back() = token;
+        }
+        return count;
+    }
+
+    // Prosody of every token's word, indexed by token; done once per model
+    // rather than per generated line
+    [[nodiscard]] std::vector<WordProsody> analyzeVocabulary() const;
+
+private:
+    MappedFile m_file;
+    std::span<const uint8_t> m_bytes;
+    int m_order = 0;
+    uint32_t m_contextCount = 0;
+    RecordTable m_vocabulary;
+    RecordTable m_displacements; // One per perfect-hash bucket
+    RecordTable m_slots;         // Contexts, with unused slots empty
+    RecordTable m_successors;
+    std::span<const uint8_t> m_strings;
+
+    [[nodiscard]] Result<void> readHeader();
+};
+
+} // namespace IndustrialMusic
\ No newline at end of file
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "Common.h"
+#include <variant>
+
+namespace IndustrialMusic {
+
+struct NoteStream;
+
+// Pull note starts and ends toward the nearest grid line; strength 0-1
+struct Quantize {
+    uint32_t grid = 120;
+    float strength = 1.0f;
+};
+
+// Delay every second subdivision of the grid by amount * grid (0-1; about
+// 0.33 gives a triplet feel). Time is warped linearly within each pair of
+// subdivisions, so notes never change order or start to overlap.
+struct Swing {
+    uint32_t grid = 240;
+    float amount = 0.0f;
+};
+
+// Random offsets of up to +-timing ticks and +-velocity. Notes keep their
+// length, so close repeats of one pitch can overlap, which a MIDI file
+// cannot represent exactly.
+struct Humanize {
+    uint32_t timing = 0;
+    uint8_t velocity = 0;
+};
+
+// Velocity gain per grid step, cycled from the section start. The gains
+// apply in full at intensity 10 and fade towards 1 at lower intensities.
+struct AccentMap {
+    uint32_t step = 120;
+    std::vector<float> gains;
+};
+
+// out = floor + (ceiling - floor) * (in / 127)^exponent
+struct VelocityCurve {
+    float exponent = 1.0f;
+    uint8_t floor = 1;
+    uint8_t ceiling = 127;
+};
+
+using NoteTransform = std::variant<Quantize, Swing, Humanize, AccentMap, VelocityCurve>;
+
+// Ordered list of transforms run over generated notes before they are
+// encoded or rendered. Each step is one pass over one or two of the
+// NoteStream arrays. Grid positions are found with a reciprocal worked out
+// once per pass, so no step divides per note.
+class NoteTransformChain {
+public:
+    NoteTransformChain() = default;
+    NoteTransformChain(std::initializer_list<NoteTransform> steps);
+
+    NoteTransformChain& add(NoteTransform step);
+    [[nodiscard]] bool empty() const { return m_steps.empty(); }
+    [[nodiscard]] std::span<const NoteTransform> getSteps() const { return m_steps; }
+
+    // Run every step in order. Humanize draws from seed, so a chunk always
+    // gets the same offsets. Notes are left in start order.
+    void apply(NoteStream& notes, int intensity, uint32_t seed) const;
+
+    // Changes whenever any step does; part of cache keys
+    [[nodiscard]] uint64_t fingerprint() const;
+
+private:
+    std::vector<NoteTransform> m_steps;
+
+    // Lookup table for each VelocityCurve step, in step order
+    std::vector<std::array<uint8_t, 128>> m_curveTables;
+};
+
+} // namespace IndustrialMusic
\ No newline at end of file
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "Common.h"
+#include "NoteTransforms.h"
+#include "SectionCache.h"
+#include <optional>
+
+namespace IndustrialMusic {
+
+// Notes stored as parallel arrays (structure of arrays), kept in start-tick
+// order. Consumers that only look at a few fields touch only those arrays.
+struct NoteStream {
+    std::vector<uint32_t> ticks;
+    std::vector<uint32_t> durations;
+    std::vector<uint8_t> channels;
+    std::vector<uint8_t> notes;
+    std::vector<uint8_t> velocities;
+
+    [[nodiscard]] size_t size() const { return ticks.size(); }
+    [[nodiscard]] bool empty() const { return ticks.empty(); }
+
+    void reserve(size_t count);
+    void clear();
+    void push(uint8_t channel, uint8_t note, uint8_t velocity, uint32_t tick, uint32_t duration);
+
+    // Append another stream with its ticks shifted by tickOffset
+    void append(const NoteStream& other, uint32_t tickOffset);
+
+    // Restore start order after timing changes; equal ticks keep their order
+    void sortByTick();
+
+    [[nodiscard]] MidiNote at(size_t index) const {
+        return {channels[index], notes[index], velocities[index], ticks[index], durations[index]};
+    }
+};
+
+enum class PatternPart { Drums, Bass, Lead };
+inline constexpr size_t PATTERN_PART_COUNT = 3;
+
+// A whole song, one stream per part, with absolute ticks
+struct SongPatterns {
+    uint16_t ticksPerQuarter = 480;
+    uint32_t lengthTicks = 0;
+    std::vector<uint32_t> sectionStartTicks;
+    std::array<NoteStream, PATTERN_PART_COUNT> parts;
+
+    [[nodiscard]] const NoteStream& part(PatternPart which) const { return parts[static_cast<size_t>(which)]; }
+};
+
+// The one source of drum, bass and lead patterns. The MIDI encoder pulls
+// section chunks from it while streaming; playback and audio rendering use
+// whole-song patterns assembled from the same chunks.
+class PatternEngine {
+public:
+    static constexpr uint16_t TICKS_PER_QUARTER = 480;
+
+    // Channel layout shared by every consumer
+    static constexpr uint8_t DRUM_CHANNEL = 9; // MIDI channel 10 (0-indexed)
+    static constexpr uint8_t BASS_CHANNEL = 0;
+    static constexpr uint8_t LEAD_CHANNEL = 1;
+
+    // Each part is seeded with seed + part index, then each section with
+    // sectionSeed() from its content and variation
+    [[nodiscard]] static constexpr uint32_t partSeed(uint32_t seed, PatternPart part) {
+        return seed + static_cast<uint32_t>(part);
+    }
+
+    // Notes for one part of one section, with ticks relative to the section
+    // start. Served from the section cache when it is enabled (the chunk is
+    // held in `cached`); otherwise built into `buffer`.
+    [[nodiscard]] const NoteStream& sectionNotes(PatternPart part, const Section& section, int intensity, uint32_t seed,
+                                                 NoteStream& buffer, std::shared_ptr<const NoteStream>& cached) const;
+
+    // Every part of every section, concatenated with absolute ticks
+    [[nodiscard]] SongPatterns generateSong(const std::vector<Section>& sections, int intensity, uint32_t seed) const;
+
+    // Groove templates replace the generated pattern for a part, looped across each section
+    void setGrooveTemplate(PatternPart part, std::optional<GrooveTemplate> groove);
+    [[nodiscard]] const std::optional<GrooveTemplate>& getGrooveTemplate(PatternPart part) const {
+        return m_grooves[static_cast<size_t>(part)];
+    }
+
+    // Transforms run over each part's notes as every section is generated
+    // (after any groove template), so all consumers see the same feel
+    void setTransforms(PatternPart part, NoteTransformChain transforms);
+    [[nodiscard]] const NoteTransformChain& getTransforms(PatternPart part) const {
+        return m_transforms[static_cast<size_t>(part)];
+    }
+
+    // Keep generated section chunks, so regenerating after an edit, or
+    // rendering a song that was just encoded, only builds what changed
+    // (0 disables caching)
+    void setSectionCacheCapacity(size_t sections);
+
+private:
+    std::array<std::optional<GrooveTemplate>, PATTERN_PART_COUNT> m_grooves;
+    std::array<NoteTransformChain, PATTERN_PART_COUNT> m_transforms;
+    std::unique_ptr<SectionCache<NoteStream>> m_sectionCache;
+
+    void buildSection(PatternPart part, const Section& section, int intensity, uint32_t seed, NoteStream& out) const;
+    void generateDrums(const Section& section, int intensity, uint32_t seed, NoteStream& out) const;
+    void generateBass(const Section& section, NoteStream& out) const;
+    void generateLead(const Section& section, int intensity, uint32_t seed, NoteStream& out) const;
+    void tileGroove(const GrooveTemplate& groove, const Section& section, uint8_t channel, NoteStream& out) const;
+
+    // Note mapping
+    static constexpr uint8_t KICK_NOTE = 36;    // C1
+    static constexpr uint8_t SNARE_NOTE = 38;   // D1
+    static constexpr uint8_t HIHAT_CLOSED = 42; // F#1
+
+    // Bass notes (industrial style - low frequencies)
+    static constexpr std::array<uint8_t, 12> BASS_NOTES = {
+        24, 26, 27, 29, 31, 32, 34, 36, 38, 39, 41, 43 // C1 to G2
+    };
+
+    // Lead notes (industrial style - mid to high frequencies)
+    static constexpr std::array<uint8_t, 24> LEAD_NOTES = {
+        48, 50, 51, 53, 55, 56, 58, 60, // C3 to C4
+        62, 63, 65, 67, 68, 70, 72, 74, // D4 to D5
+        75, 77, 79, 80, 82, 84, 86, 87  // D#5 to D#6
+    };
+};
+
+} // namespace IndustrialMusic
\ No newline at end of file
@@ -0,0 +1,298 @@
+#pragma once
+
+#include "Hash.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+#include <type_traits>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace IndustrialMusic {
+
+// Immutable sequence with structural sharing. Every edit returns a new
+// version that shares all untouched nodes with the old one, so keeping many
+// versions costs memory in proportion to the edits between them, not to
+// their length. Stored as an implicit treap: a binary tree ordered by
+// position and heap-ordered by random priority, so edits at any index touch
+// O(log n) nodes. Versions are safe to read from several threads.
+//
+// A Weight policy (static int64_t of(const T&)) keeps the total weight of
+// every subtree, so elements can also be found by the summed weight before
+// them, e.g. the section playing at a beat.
+struct NoWeight {};
+
+template<typename T, typename Weight = NoWeight>
+class PersistentVector {
+    static constexpr bool WEIGHTED = !std::is_same_v<Weight, NoWeight>;
+
+public:
+    PersistentVector() = default;
+
+    explicit PersistentVector(std::span<const T> values) : m_root(build(values)) {}
+
+    [[nodiscard]] size_t size() const { return sizeOf(m_root); }
+    [[nodiscard]] bool empty() const { return !m_root; }
+
+    [[nodiscard]] const T& operator[](size_t index) const {
+        const Node* node = m_root.get();
+        for (;;) {
+            size_t leftSize = sizeOf(node->left);
+            if (index < leftSize) {
+                node = node->left.get();
+            } else if (index == leftSize) {
+                return node->value;
+            } else {
+                index -= leftSize + 1;
+                node = node->right.get();
+            }
+        }
+    }
+
+    [[nodiscard]] PersistentVector insert(size_t index, T value) const {
+        auto [left, right] = split(m_root, std::min(index, size()));
+        auto single = std::make_shared<const Node>(std::move(value), nullptr, nullptr, nextPriority());
+        return PersistentVector(merge(merge(left, single), right));
+    }
+
+    [[nodiscard]] PersistentVector pushBack(T value) const {
+        return insert(size(), std::move(value));
+    }
+
+    [[nodiscard]] PersistentVector erase(size_t index) const {
+        return erase(index, index + 1);
+    }
+
+    // Remove [begin, end)
+    [[nodiscard]] PersistentVector erase(size_t begin, size_t end) const {
+        end = std::min(end, size());
+        if (begin >= end) return *this;
+        auto [left, rest] = split(m_root, begin);
+        auto [removed, right] = split(rest, end - begin);
+        return PersistentVector(merge(left, right));
+    }
+
+    // Insert a whole sequence before index, sharing its nodes
+    [[nodiscard]] PersistentVector insert(size_t index, const PersistentVector& values) const {
+        if (values.empty()) return *this;
+        auto [left, right] = split(m_root, std::min(index, size()));
+        return PersistentVector(merge(merge(left, values.m_root), right));
+    }
+
+    // Elements [begin, end) as a version of their own
+    [[nodiscard]] PersistentVector slice(size_t begin, size_t end) const {
+        end = std::min(end, size());
+        if (begin >= end) return {};
+        auto [rest, right] = split(m_root, end);
+        return PersistentVector(split(rest, begin).second);
+    }
+
+    // Visit every element in order
+    template<typename Visit>
+    void forEach(Visit&& visit) const {
+        std::vector<const Node*> stack;
+        const Node* node = m_root.get();
+        while (node || !stack.empty()) {
+            for (; node; node = node->left.get()) {
+                stack.push_back(node);
+            }
+            node = stack.back();
+            stack.pop_back();
+            visit(node->value);
+            node = node->right.get();
+        }
+    }
+
+    // Weighted lookups, for a Weight policy only
+    [[nodiscard]] int64_t totalWeight() const requires WEIGHTED { return weightOf(m_root); }
+
+    // Summed weight of the first count elements
+    [[nodiscard]] int64_t weightBefore(size_t count) const requires WEIGHTED {
+        int64_t weight = 0;
+        for (const Node* node = m_root.get(); node;) {
+            size_t leftSize = sizeOf(node->left);
+            if (count <= leftSize) {
+                node = node->left.get();
+            } else {
+                weight += weightOf(node->left) + Weight::of(node->value);
+                count -= leftSize + 1;
+                node = node->right.get();
+            }
+        }
+        return weight;
+    }
+
+    struct Position {
+        size_t index;
+        int64_t start; // Summed weight before the element
+    };
+
+    // Element whose weight spans `weight`, counting from the front, or
+    // size() and the total once past the end. Weightless elements are
+    // skipped, and weights before the front give the first element.
+    [[nodiscard]] Position find(int64_t weight) const requires WEIGHTED {
+        Position position{0, 0};
+        weight = std::max<int64_t>(weight, 0);
+        for (const Node* node = m_root.get(); node;) {
+            int64_t leftWeight = weightOf(node->left);
+            int64_t ownWeight = Weight::of(node->value);
+            if (weight < leftWeight) {
+                node = node->left.get();
+            } else if (weight < leftWeight + ownWeight) {
+                position.index += sizeOf(node->left);
+                position.start += leftWeight;
+                return position;
+            } else {
+                position.index += sizeOf(node->left) + 1;
+                position.start += leftWeight + ownWeight;
+                weight -= leftWeight + ownWeight;
+                node = node->right.get();
+            }
+        }
+        return position;
+    }
+
+    // Copy out in order
+    [[nodiscard]] std::vector<T> toVector() const {
+        std::vector<T> values;
+        values.reserve(size());
+        forEach([&](const T& value) { values.push_back(value); });
+        return values;
+    }
+
+    // Distinct nodes across a set of versions, i.e. how many elements they
+    // hold in memory between them
+    [[nodiscard]] static size_t countNodes(std::span<const PersistentVector> versions) {
+        std::unordered_set<const Node*> seen;
+        std::vector<const Node*> stack;
+        for (const auto& version : versions) {
+            stack.push_back(version.m_root.get());
+            while (!stack.empty()) {
+                const Node* node = stack.back();
+                stack.pop_back();
+                // A shared node's whole subtree has been counted already
+                if (!node || !seen.insert(node).second) continue;
+                stack.push_back(node->left.get());
+                stack.push_back(node->right.get());
+            }
+        }
+        return seen.size();
+    }
+
+private:
+    using WeightSum = std::conditional_t<WEIGHTED, int64_t, NoWeight>;
+
+    struct Node;
+    using NodePtr = std::shared_ptr<const Node>;
+
+    struct Node {
+        T value;
+        NodePtr left;
+        NodePtr right;
+        size_t size;
+        [[no_unique_address]] WeightSum weight; // Of the whole subtree
+        uint32_t priority;
+
+        Node(T value, NodePtr left, NodePtr right, uint32_t priority)
+            : value(std::move(value)), left(std::move(left)), right(std::move(right)),
+              size(sizeOf(this->left) + 1 + sizeOf(this->right)), weight(sumWeight()), priority(priority) {}
+
+        WeightSum sumWeight() const {
+            if constexpr (WEIGHTED) {
+                return weightOf(left) + Weight::of(value) + weightOf(right);
+            } else {
+                return {};
+            }
+        }
+    };
+
+public:
+    // Approximate heap cost of one element, including the shared_ptr control block
+    static constexpr size_t NODE_BYTES = sizeof(Node) + 2 * sizeof(void*);
+
+private:
+    explicit PersistentVector(NodePtr root) : m_root(std::move(root)) {}
+
+    NodePtr m_root;
+
+    static size_t sizeOf(const NodePtr& node) { return node ? node->size : 0; }
+    static int64_t weightOf(const NodePtr& node) requires WEIGHTED { return node ? node->weight : 0; }
+
+    // Deterministic within a process; only the shape of the tree depends on it
+    static uint32_t nextPriority() {
+        static std::atomic<uint64_t> counter{0};
+        return static_cast<uint32_t>(mix64(counter.fetch_add(1, std::memory_order_relaxed) + GOLDEN_GAMMA));
+    }
+
+    // First `count` elements on the left; copies only the nodes on the split path
+    static std::pair<NodePtr, NodePtr> split(const NodePtr& node, size_t count) {
+        if (!node) return {nullptr, nullptr};
+
+        size_t leftSize = sizeOf(node->left);
+        if (count <= leftSize) {
+            auto [left, right] = split(node->left, count);
+            return {left, std::make_shared<const Node>(node->value, right, node->right, node->priority)};
+        }
+        auto [left, right] = split(node->right, count - leftSize - 1);
+        return {std::make_shared<const Node>(node->value, node->left, left, node->priority), right};
+    }
+
+    static NodePtr merge(const NodePtr& left, const NodePtr& right) {
+        if (!left) return right;
+        if (!right) return left;
+
+        if (left->priority >= right->priority) {
+            return std::make_shared<const Node>(left->value, left->left, merge(left->right, right), left->priority);
+        }
+        return std::make_shared<const Node>(right->value, merge(left, right->left), right->right, right->priority);
+    }
+
+    // Balanced tree over values. Priorities are drawn for every node and
+    // handed out largest first by depth, so the heap order holds.
+    static NodePtr build(std::span<const T> values) {
+        if (values.empty()) return nullptr;
+
+        std::vector<uint32_t> priorities(values.size());
+        for (auto& priority : priorities) {
+            priority = nextPriority();
+        }
+        std::ranges::sort(priorities, std::greater<>());
+
+        // Depth of each position in the midpoint tree decides its share
+        std::vector<uint32_t> depths(values.size());
+        size_t maxDepth = 0;
+        auto assignDepths = [&](auto& self, size_t begin, size_t end, uint32_t depth) -> void {
+            if (begin >= end) return;
+            size_t middle = begin + (end - begin) / 2;
+            depths[middle] = depth;
+            maxDepth = std::max<size_t>(maxDepth, depth);
+            self(self, begin, middle, depth + 1);
+            self(self, middle + 1, end, depth + 1);
+        };
+        assignDepths(assignDepths, 0, values.size(), 0);
+
+        std::vector<size_t> levelStart(maxDepth + 2, 0);
+        for (uint32_t depth : depths) {
+            ++levelStart[depth + 1];
+        }
+        for (size_t level = 1; level < levelStart.size(); ++level) {
+            levelStart[level] += levelStart[level - 1];
+        }
+
+        auto buildRange = [&](auto& self, size_t begin, size_t end) -> NodePtr {
+            if (begin >= end) return nullptr;
+            size_t middle = begin + (end - begin) / 2;
+            uint32_t priority = priorities[levelStart[depths[middle]]++];
+            NodePtr left = self(self, begin, middle);
+            NodePtr right = self(self, middle + 1, end);
+            return std::make_shared<const Node>(values[middle], std::move(left), std::move(right), priority);
+        };
+        return buildRange(buildRange, 0, values.size());
+    }
+};
+
+} // namespace IndustrialMusic
\ No newline at end of file
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "Common.h"
+#include "SectionCache.h"
+#include <string_view>
+
+namespace IndustrialMusic {
+
+// English phonemes (ARPAbet), plus a pause for punctuation
+enum class Phoneme : uint8_t {
+    Pause,
+    // Vowels
+    AA, AE, AH, AO, EH, ER, IH, IY, UH, UW,
+    // Diphthongs
+    AY, AW, EY, OW, OY,
+    // Nasals, liquids and glides
+    M, N, NG, L, R, W, Y,
+    // Fricatives
+    HH, F, V, TH, DH, S, Z, SH, ZH,
+    // Plosives and affricates
+    P, B, T, D, K, G, CH, JH
+};
+
+constexpr size_t PHONEME_COUNT = static_cast<size_t>(Phoneme::JH) + 1;
+
+[[nodiscard]] constexpr bool isVowel(Phoneme phoneme) {
+    return phoneme >= Phoneme::AA && phoneme <= Phoneme::OY;
+}
+
+struct PhonemeEvent {
+    Phoneme phoneme = Phoneme::Pause;
+    bool stressed = false; // Vowels of stressed syllables, from the word's prosody
+
+    bool operator==(const PhonemeEvent&) const = default;
+};
+
+using PhonemeLine = std::vector<PhonemeEvent>;
+
+// Rule-based letter-to-sound conversion for lyric lines: digraphs and
+// common spellings first ("tion", "igh", "sh"), then silent-e lengthening,
+// then single letters, with unstressed short vowels reduced to a schwa.
+// Stress comes from the same spelling rules as the lyric prosody tables.
+// It is an approximation, not a pronouncing dictionary.
+//
+// Lyric lines repeat a lot (choruses, cached sections), so converted lines
+// are kept in a thread-safe LRU cache and shared; converting a song's
+// lyrics a second time is a hash lookup per line.
+class Phonemizer {
+public:
+    explicit Phonemizer(size_t cacheLines = 1024) : m_cache(cacheLines) {}
+
+    // Prevent copying
+    Phonemizer(const Phonemizer&) = delete;
+    Phonemizer& operator=(const Phonemizer&) = delete;
+
+    // Phonemes of one line, converted on first use. Section headers
+    // ("[VERSE 1]") and blank lines give an empty line.
+    [[nodiscard]] std::shared_ptr<const PhonemeLine> convert(std::string_view line);
+
+    // Uncached conversion
+    [[nodiscard]] static PhonemeLine convertLine(std::string_view line);
+    static void convertWord(std::string_view word, PhonemeLine& out);
+
+    [[nodiscard]] uint64_t hits() const { return m_cache.hits(); }
+    [[nodiscard]] uint64_t misses() const { return m_cache.misses(); }
+
+private:
+    // Hashes std::string keys and string_view lookups alike, so a hit
+    // does not copy the line
+    struct LineHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view line) const noexcept { return std::hash<std::string_view>{}(line); }
+    };
+
+    SectionCache<PhonemeLine, std::string, LineHash> m_cache;
+};
+
+} // namespace IndustrialMusic
\ No newline at end of file
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "Common.h"
+#include "MappedFile.h"
+#include "BinaryRecords.h"
+#include <filesystem>
+#include <string_view>
+
+namespace IndustrialMusic {
+
+// Parameter driven by an automation lane
+enum class AutomationTarget : uint8_t {
+    Tempo,
+    Intensity,
+    Distortion
+};
+
+struct AutomationPoint {
+    uint32_t beat = 0; // From the start of the song
+    float value = 0.0f;
+
+    bool operator==(const AutomationPoint&) const = default;
+};
+
+struct AutomationLane {
+    AutomationTarget target = AutomationTarget::Intensity;
+    std::vector<AutomationPoint> points; // Ordered by beat
+
+    bool operator==(const AutomationLane&) const = default;
+};
+
+// Everything needed to reopen a song exactly as it was saved
+struct Project {
+    std::vector<Section> sections;
+    AudioParams params;
+    uint32_t songSeed = 0;
+    std::vector<std::string> lyrics;
+    std::vector<AutomationLane> automation;
+};
+
+// Section as stored, with its name pointing into the file
+struct SectionView {
+    SectionType type = SectionType::Verse;
+    std::string_view name;
+    int bars = 4;
+    int beatsPerBar = 4;
+    uint32_t variation = 0;
+};
+
+struct AutomationLaneView {
+    AutomationTarget target = AutomationTarget::Intensity;
+    uint32_t firstPoint = 0; // Index into the file's point table
+    uint32_t pointCount = 0;
+};
+
+// Binary project file (.immp). A fixed header holds the parameters and
+// seed, followed by tables of fixed-width little-endian records (sections,
+// lyric lines, automation lanes and points) and one string table that
+// names and lines point into. Opening maps the file and checks the header
+// and table bounds; records are read in place on access, so open time does
+// not depend on project size.
+//
+// Each table stores its record stride. Later versions may append fields to
+// a record or to the header, and older readers skip what they do not know.
+class ProjectFile {
+public:
+    static constexpr uint16_t FORMAT_VERSION = 1;
+    static constexpr const char* EXTENSION = ".immp";
+
+    // Map and validate a file
+    [[nodiscard]] static Result<ProjectFile> open(const std::filesystem::path& filepath);
+
+    // Validate bytes owned by the caller, which must outlive the view
+    [[nodiscard]] static Result<ProjectFile> parse(std::span<const uint8_t> bytes);
+
+    // Encode a project, and write one to disk atomically
+    [[nodiscard]] static std::vector<uint8_t> serialize(const Project& project);
+    [[nodiscard]] static Result<void> save(const Project& project, const std::filesystem::path& filepath);
+
+    [[nodiscard]] uint16_t getVersion() const { return m_version; }
+    [[nodiscard]] uint32_t getSongSeed() const;
+    [[nodiscard]] AudioParams getParams() const;
+
+    // Records are read in place. An index past the end gives a default
+    // record, and a string reference outside the string table reads as empty.
+    [[nodiscard]] size_t getSectionCount() const { return m_sections.count; }
+    [[nodiscard]] SectionView getSection(size_t index) const;
+
+    [[nodiscard]] size_t getLyricCount() const { return m_lyrics.count; }
+    [[nodiscard]] std::string_view getLyric(size_t index) const;
+
+    [[nodiscard]] size_t getAutomationLaneCount() const { return m_lanes.count; }
+    [[nodiscard]] AutomationLaneView getAutomationLane(size_t index) const;
+    [[nodiscard]] size_t getAutomationPointCount() const { return m_points.count; }
+    [[nodiscard]] AutomationPoint getAutomationPoint(size_t index) const;
+
+    // Copy everything out, checking every record; fails with
+    // InvalidFileFormat if any string or point reference is out of range or
+    // a section's length is not positive or implausibly long. Sections from
+    // files written before variations were stored are numbered in order.
+    [[nodiscard]] Result<Project> load() const;
+
+    [[nodiscard]] size_t getFileSize() const { return m_bytes.size(); }
+
+private:
+    // Only open() and parse() make one, so the header is always there
+    ProjectFile() = default;
+
+    MappedFile m_file;
+    std::span<const uint8_t> m_bytes;
+    uint16_t m_version = 0;
+    RecordTable m_sections;
+    RecordTable m_lyrics;
+    RecordTable m_lanes;
+    RecordTable m_points;
+    std::span<const uint8_t> m_strings;
+
+    [[nodiscard]] Result<void> readHeader();
+    [[nodiscard]] bool hasVariations() const;
+    [[nodiscard]] std::string_view stringAt(uint32_t offset, uint32_t length) const;
+};
+
+} // namespace IndustrialMusic
\ No newline at end of file
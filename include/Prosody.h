@@ -0,0 +1,219 @@
+#pragma once
+
+#include "Common.h"
+#include "Hash.h"
+#include <string_view>
+
+namespace IndustrialMusic {
+
+// Syllable count, stress pattern and rhyme class of one word, estimated
+// from its spelling. Built-in word banks get theirs at compile time and
+// loaded vocabularies when they are loaded, so fitting lyrics to the beat
+// grid only sums table entries.
+struct WordProsody {
+    uint8_t syllables = 0;
+    uint8_t stress = 0;  // Bit i set when syllable i is stressed (first 8 syllables)
+    uint16_t rhyme = 0;  // Words with equal classes rhyme; 0 when there is no vowel
+
+    bool operator==(const WordProsody&) const = default;
+};
+
+// Prosody of a line built up word by word
+struct LineProsody {
+    uint16_t syllables = 0;
+    uint16_t rhyme = 0;  // Of the last word with one
+    uint32_t stress = 0; // Bit i set when syllable i is stressed (first 32 syllables)
+
+    constexpr void append(const WordProsody& word) {
+        if (syllables < 32) {
+            stress |= static_cast<uint32_t>(word.stress) << syllables;
+        }
+        syllables = static_cast<uint16_t>(syllables + word.syllables);
+        if (word.rhyme != 0) {
+            rhyme = word.rhyme;
+        }
+    }
+
+    constexpr void append(const LineProsody& other) {
+        if (syllables < 32) {
+            stress |= other.stress << syllables;
+        }
+        syllables = static_cast<uint16_t>(syllables + other.syllables);
+        if (other.rhyme != 0) {
+            rhyme = other.rhyme;
+        }
+    }
+
+    bool operator==(const LineProsody&) const = default;
+};
+
+// Lyric lines are sung at up to two syllables per beat (eighth notes)
+constexpr int MAX_SYLLABLES_PER_BEAT = 2;
+
+namespace prosody_detail {
+
+constexpr char lower(char c) {
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+constexpr bool isVowel(std::string_view word, size_t i) {
+    char c = lower(word[i]);
+    // y is a vowel except at the start of a word ("yell" but "heavy")
+    return c == 'a' || c == 'e' || c == 'i' || c == 'o' || c == 'u' || (c == 'y' && i > 0);
+}
+
+// Vowel pairs sounded as two syllables ("violent", "dual", "neon"), except
+// "ion"/"ia" after t, s, c, x or g ("nation", "special", "region") and
+// after a double l ("rebellion")
+constexpr bool isHiatus(std::string_view word, size_t i) {
+    char first = lower(word[i - 1]);
+    char second = lower(word[i]);
+    if (first == 'i' && (second == 'a' || second == 'o' || second == 'u')) {
+        char before = i >= 2 ? lower(word[i - 2]) : ' ';
+        bool doubleL = before == 'l' && i >= 3 && lower(word[i - 3]) == 'l';
+        return before != 't' && before != 's' && before != 'c' && before != 'x' && before != 'g' && !doubleL;
+    }
+    return (first == 'e' && second == 'o') || (first == 'u' && (second == 'a' || second == 'o'));
+}
+
+constexpr bool endsWith(std::string_view word, std::string_view suffix) {
+    if (suffix.size() > word.size()) return false;
+    for (size_t i = 0; i < suffix.size(); ++i) {
+        if (lower(word[word.size() - suffix.size() + i]) != suffix[i]) return false;
+    }
+    return true;
+}
+
+constexpr bool startsWith(std::string_view word, std::string_view prefix) {
+    if (prefix.size() > word.size()) return false;
+    for (size_t i = 0; i < prefix.size(); ++i) {
+        if (lower(word[i]) != prefix[i]) return false;
+    }
+    return true;
+}
+
+} // namespace prosody_detail
+
+// Spelling rules: each run of vowels is a syllable (two for pairs such as
+// the "io" in "violent"), except a silent final "e" ("forge"), "es"
+// ("smokes") or "ed" ("crashed"). Stress falls on the first syllable, the
+// second after an unstressed prefix ("destroy"), or is placed by suffix
+// ("-tion", "-ic", "-ity"). The rhyme class hashes the spelling from the
+// last sounded vowel to the end. A suffix (text glued to the word before,
+// such as the "ing" in "{verb}ing") may have no syllables and is never
+// stressed.
+constexpr WordProsody analyzeWord(std::string_view word, bool suffix = false) {
+    using namespace prosody_detail;
+
+    // Start of each vowel run
+    constexpr size_t MAX_RUNS = 16;
+    size_t runs[MAX_RUNS] = {};
+    size_t count = 0;
+    for (size_t i = 0; i < word.size(); ++i) {
+        if (isVowel(word, i) && (i == 0 || !isVowel(word, i - 1) || isHiatus(word, i))) {
+            if (count < MAX_RUNS) runs[count] = i;
+            ++count;
+        }
+    }
+    count = count < MAX_RUNS ? count : MAX_RUNS;
+
+    if (!suffix && count > 1) {
+        size_t last = runs[count - 1];
+        bool finalE = last == word.size() - 1 && lower(word[last]) == 'e';
+        // "le" after a consonant is sounded ("little"), other final e's are not
+        bool sounded = finalE && word.size() >= 3 && lower(word[word.size() - 2]) == 'l' &&
+                       !isVowel(word, word.size() - 3);
+        bool silentE = finalE && !sounded;
+
+        bool silentEs = false;
+        bool silentEd = false;
+        if (last == word.size() - 2 && lower(word[last]) == 'e') {
+            char before = lower(word[last - 1]);
+            char after = lower(word[last + 1]);
+            silentEs = after == 's' && before != 's' && before != 'x' && before != 'z' &&
+                       before != 'c' && before != 'g' && before != 'h';
+            silentEd = after == 'd' && before != 't' && before != 'd';
+        }
+        if (silentE || silentEs || silentEd) {
+            --count;
+        }
+    }
+
+    WordProsody prosody;
+    if (count == 0) {
+        // Vowelless words ("hmm") are one syllable; suffixes like "s" add none
+        prosody.syllables = suffix ? 0 : 1;
+        prosody.stress = suffix ? 0 : 1;
+        return prosody;
+    }
+    prosody.syllables = static_cast<uint8_t>(count);
+
+    if (!suffix) {
+        size_t stressed = 0;
+        if (count >= 2) {
+            if (endsWith(word, "tion") || endsWith(word, "sion") || endsWith(word, "ic") ||
+                endsWith(word, "ics") || endsWith(word, "cian")) {
+                stressed = count - 2;
+            } else if (endsWith(word, "ity") || endsWith(word, "ical") || (count >= 3 && endsWith(word, "ate"))) {
+                stressed = count >= 3 ? count - 3 : 0;
+            } else if (count == 2) {
+                constexpr std::string_view PREFIXES[] = {"a", "be", "de", "re", "ex", "dis", "un", "in"};
+                for (std::string_view prefix : PREFIXES) {
+                    // The prefix must end before the second vowel run ("attack", not "anvil")
+                    if (startsWith(word, prefix) && runs[1] > prefix.size() &&
+                        (prefix != "a" || (word.size() > 2 && lower(word[1]) == lower(word[2])))) {
+                        stressed = 1;
+                        break;
+                    }
+                }
+            }
+        }
+        if (stressed < 8) {
+            prosody.stress = static_cast<uint8_t>(1u << stressed);
+        }
+    }
+
+    // Hash of the last sounded vowel run to the end of the word
+    ContentHasher hash;
+    for (size_t i = runs[count - 1]; i < word.size(); ++i) {
+        hash.add(static_cast<uint8_t>(lower(word[i])));
+    }
+    prosody.rhyme = static_cast<uint16_t>(hash.value() & 0xFFFF);
+    if (prosody.rhyme == 0) {
+        prosody.rhyme = 1;
+    }
+    return prosody;
+}
+
+// Prosody of every word of a built-in bank, evaluated at compile time
+template<size_t N>
+constexpr std::array<WordProsody, N> analyzeWords(const std::array<std::string_view, N>& words) {
+    std::array<WordProsody, N> prosody{};
+    for (size_t i = 0; i < N; ++i) {
+        prosody[i] = analyzeWord(words[i]);
+    }
+    return prosody;
+}
+
+// Prosody of free text such as a template's literal parts. Words are runs
+// of letters and apostrophes; a run that starts the text is a suffix of the
+// word before it when attached is set.
+constexpr LineProsody analyzeText(std::string_view text, bool attached = false) {
+    LineProsody line;
+    size_t start = 0;
+    bool inWord = false;
+    for (size_t i = 0; i <= text.size(); ++i) {
+        char c = i < text.size() ? prosody_detail::lower(text[i]) : ' ';
+        bool letter = (c >= 'a' && c <= 'z') || c == '\'';
+        if (letter && !inWord) {
+            start = i;
+            inWord = true;
+        } else if (!letter && inWord) {
+            line.append(analyzeWord(text.substr(start, i - start), attached && start == 0));
+            inWord = false;
+        }
+    }
+    return line;
+}
+
+} // namespace IndustrialMusic
\ No newline at end of file
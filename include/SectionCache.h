@@ -0,0 +1,170 @@
+#pragma once
+
+#include "Common.h"
+#include "Hash.h"
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace IndustrialMusic {
+
+// Everything a generated section chunk depends on
+struct SectionKey {
+    SectionType type = SectionType::Intro;
+    int bars = 0;
+    int beatsPerBar = 0;
+    int intensity = 0;
+    uint32_t seed = 0;    // Derived per-section seed
+    uint32_t variant = 0; // Track index, or verse number for lyrics
+
+    SectionKey() = default;
+    SectionKey(const Section& section, int intensity, uint32_t seed, uint32_t variant)
+        : type(section.type), bars(section.bars), beatsPerBar(section.beatsPerBar),
+          intensity(intensity), seed(seed), variant(variant) {}
+
+    bool operator==(const SectionKey&) const = default;
+};
+
+struct SectionKeyHash {
+    size_t operator()(const SectionKey& key) const noexcept {
+        // splitmix64 over the packed fields
+        uint64_t hash = (static_cast<uint64_t>(key.type) << 56) ^ (static_cast<uint64_t>(key.bars) << 32) ^
+                        (static_cast<uint64_t>(key.beatsPerBar) << 24) ^ (static_cast<uint64_t>(key.intensity) << 16) ^
+                        key.variant;
+        hash ^= static_cast<uint64_t>(key.seed) * GOLDEN_GAMMA;
+        return static_cast<size_t>(mix64(hash));
+    }
+};
+
+// Thread-safe LRU cache of per-section generation results, or of anything
+// else keyed by value (the phonemizer keys lines by their text). Entries
+// are immutable and shared, so a chunk handed out stays valid after
+// eviction. A Hash with is_transparent allows lookups by any type it
+// hashes, such as a string_view for string keys.
+template<typename T, typename Key = SectionKey, typename Hash = SectionKeyHash>
+class SectionCache {
+public:
+    explicit SectionCache(size_t capacity) : m_capacity(std::max<size_t>(capacity, 1)) {}
+
+    // Prevent copying
+    SectionCache(const SectionCache&) = delete;
+    SectionCache& operator=(const SectionCache&) = delete;
+
+    // Return the cached chunk for key, building it on a miss. build runs
+    // without the lock held, so concurrent misses on one key may both build.
+    template<typename Lookup, typename Build>
+    [[nodiscard]] std::shared_ptr<const T> getOrBuild(const Lookup& key, Build&& build) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (auto it = m_index.find(key); it != m_index.end()) {
+                m_entries.splice(m_entries.begin(), m_entries, it->second);
+                ++m_hits;
+                return it->second->second;
+            }
+            ++m_misses;
+        }
+
+        auto value = std::make_shared<const T>(build());
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (auto it = m_index.find(key); it != m_index.end()) {
+            return it->second->second;
+        }
+        m_entries.emplace_front(Key(key), value);
+        m_index.emplace(m_entries.front().first, m_entries.begin());
+        if (m_entries.size() > m_capacity) {
+            m_index.erase(m_entries.back().first);
+            m_entries.pop_back();
+        }
+        return value;
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_entries.clear();
+        m_index.clear();
+    }
+
+    [[nodiscard]] size_t size() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_entries.size();
+    }
+
+    [[nodiscard]] uint64_t hits() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_hits;
+    }
+
+    [[nodiscard]] uint64_t misses() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_misses;
+    }
+
+private:
+    using Entry = std::pair<Key, std::shared_ptr<const T>>;
+
+    size_t m_capacity;
+    std::list<Entry> m_entries; // Most recently used first
+    std::unordered_map<Key, typename std::list<Entry>::iterator, Hash, std::equal_to<>> m_index;
+    mutable std::mutex m_mutex;
+    uint64_t m_hits = 0;
+    uint64_t m_misses = 0;
+};
+
+// Identifies sections that generate alike: same type, bars and beats per bar
+[[nodiscard]] constexpr uint64_t sectionContent(const Section& section) {
+    const uint64_t length = (static_cast<uint64_t>(static_cast<uint32_t>(section.bars)) << 32) |
+                            static_cast<uint32_t>(section.beatsPerBar);
+    return mix64(length) + static_cast<uint64_t>(section.type);
+}
+
+// Seed for one section, derived from the song or track seed, the section's
+// content and its variation. Positions play no part, so inserting, removing
+// or moving a section leaves the seeds (and generated chunks) of every
+// other section as they were.
+[[nodiscard]] constexpr uint32_t sectionSeed(uint32_t seed, const Section& section) {
+    const uint64_t numbered = (static_cast<uint64_t>(seed) << 32) | section.variation;
+    return static_cast<uint32_t>(mix64(mix64(numbered) ^ sectionContent(section)));
+}
+
+// Hands out variations: each section gets the next unused number among
+// sections of its shape, so identical sections still sound different
+class SectionVariations {
+public:
+    // Number section, which is then counted
+    void assign(Section& section) {
+        uint32_t& count = countFor(section);
+        section.variation = count++;
+    }
+
+    // Count a section that is already numbered, so later ones come after it
+    void reserve(const Section& section) {
+        uint32_t& count = countFor(section);
+        count = std::max(count, section.variation + 1);
+    }
+
+private:
+    // Songs use a handful of section shapes, so a scan beats hashing
+    std::vector<std::pair<uint64_t, uint32_t>> m_counts;
+
+    uint32_t& countFor(const Section& section) {
+        const uint64_t content = sectionContent(section);
+        for (auto& [key, count] : m_counts) {
+            if (key == content) {
+                return count;
+            }
+        }
+        return m_counts.emplace_back(content, 0).second;
+    }
+};
+
+// Number sections in order, as a song written without variations would be
+[[nodiscard]] inline std::vector<Section> numberVariations(std::vector<Section> sections) {
+    SectionVariations variations;
+    for (auto& section : sections) {
+        variations.assign(section);
+    }
+    return sections;
+}
+
+} // namespace IndustrialMusic
\ No newline at end of file
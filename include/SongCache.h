@@ -0,0 +1,53 @@
+#pragma once
+
+#include "Common.h"
+#include "Hash.h"
+#include "MappedFile.h"
+#include <filesystem>
+#include <mutex>
+
+namespace IndustrialMusic {
+
+// Persistent content-addressed store for generated songs. Each entry is one
+// file named after its key. Entries are written to a temporary file and
+// renamed into place, so readers (in this or another process) only ever see
+// complete files. Hits are served by memory-mapping the entry and refresh
+// its modification time, which drives least-recently-used eviction once the
+// directory grows past its byte budget.
+class SongCache {
+public:
+    [[nodiscard]] static Result<std::unique_ptr<SongCache>> open(const std::filesystem::path& directory, uint64_t maxBytes);
+
+    // Prevent copying
+    SongCache(const SongCache&) = delete;
+    SongCache& operator=(const SongCache&) = delete;
+
+    // Map a stored entry; fails with FileReadFailed on a miss
+    [[nodiscard]] Result<MappedFile> find(const std::string& key);
+
+    // Store an entry and evict old ones if over budget
+    [[nodiscard]] Result<void> store(const std::string& key, std::span<const uint8_t> bytes);
+
+    [[nodiscard]] const std::filesystem::path& getDirectory() const { return m_directory; }
+    [[nodiscard]] uint64_t getMaxBytes() const { return m_maxBytes; }
+    [[nodiscard]] uint64_t getHits() const;
+    [[nodiscard]] uint64_t getMisses() const;
+
+private:
+    SongCache(std::filesystem::path directory, uint64_t maxBytes);
+
+    static constexpr const char* ENTRY_EXTENSION = ".mid";
+
+    std::filesystem::path m_directory;
+    uint64_t m_maxBytes;
+
+    mutable std::mutex m_mutex;
+    uint64_t m_trackedBytes = 0; // Estimate; other processes may add entries too
+    uint64_t m_hits = 0;
+    uint64_t m_misses = 0;
+
+    [[nodiscard]] std::filesystem::path entryPath(const std::string& key) const;
+    void evict();
+};
+
+} // namespace IndustrialMusic
\ No newline at end of file
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "Common.h"
+#include "MidiReader.h"
+#include "PatternEngine.h"
+#include <filesystem>
+
+namespace IndustrialMusic {
+
+class ThreadPool;
+
+struct RenderSettings {
+    uint32_t sampleRate = 44100;
+    float distortion = 0.6f; // 0-1, drive of the master soft clipper
+    float gain = 0.5f;
+};
+
+// Mono PCM
+struct RenderedAudio {
+    uint32_t sampleRate = 44100;
+    std::vector<float> samples;
+
+    [[nodiscard]] double durationSeconds() const {
+        return sampleRate ? static_cast<double>(samples.size()) / sampleRate : 0.0;
+    }
+};
+
+// Offline renderer using the built-in drum, bass and lead voices. Renders
+// either generated patterns directly or any Standard MIDI File; there,
+// channel 10 plays drums and other channels pick bass or lead from their GM
+// program. Output depends only on the input and settings, not on the thread
+// count.
+class SongRenderer {
+public:
+    explicit SongRenderer(RenderSettings settings = {});
+
+    void setSettings(const RenderSettings& settings) { m_settings = settings; }
+    [[nodiscard]] const RenderSettings& getSettings() const { return m_settings; }
+
+    // Render on the given pool (nullptr renders serially). render() must not
+    // be called from a task running on the same pool.
+    void setThreadPool(ThreadPool* pool) { m_threadPool = pool; }
+
+    [[nodiscard]] Result<RenderedAudio> render(std::span<const uint8_t> midiData) const;
+
+    // Render the pattern engine's output directly, without encoding it to MIDI
+    [[nodiscard]] Result<RenderedAudio> render(const SongPatterns& patterns, int tempo) const;
+
+    // 16-bit PCM WAV
+    [[nodiscard]] static Result<void> saveWav(const RenderedAudio& audio, const std::filesystem::path& filepath);
+
+private:
+    enum class Voice : uint8_t { Kick, Snare, ClosedHat, OpenHat, Cymbal, Bass, Lead };
+
+    struct RenderNote {
+        uint32_t startSample;
+        uint32_t lengthSamples; // Gate length; voices ring out past it
+        float frequency;
+        float velocity;         // 0-1
+        Voice voice;
+    };
+
+    // Converts ticks to seconds across tempo changes
+    class TempoMap {
+    public:
+        explicit TempoMap(const MidiReader& reader);
+        [[nodiscard]] double secondsAt(uint32_t tick) const;
+
+    private:
+        struct Segment {
+            uint32_t tick;
+            double seconds;
+            double secondsPerTick;
+        };
+        std::vector<Segment> m_segments;
+    };
+
+    // Notes are rendered in batches by start time; each batch owns a private
+    // span of samples, and batches are summed in order afterwards
+    static constexpr double BATCH_SECONDS = 1.0;
+
+    RenderSettings m_settings;
+    ThreadPool* m_threadPool = nullptr;
+
+    [[nodiscard]] std::vector<RenderNote> collectNotes(const MidiReader& reader, const TempoMap& tempo) const;
+    [[nodiscard]] std::vector<RenderNote> collectNotes(const SongPatterns& patterns, int tempo) const;
+    [[nodiscard]] RenderedAudio renderNotes(const std::vector<RenderNote>& notes) const;
+    [[nodiscard]] uint32_t voiceLength(const RenderNote& note) const;
+    void renderNote(const RenderNote& note, std::span<float> out) const;
+
+    void renderKick(const RenderNote& note, std::span<float> out) const;
+    void renderSnare(const RenderNote& note, std::span<float> out) const;
+    void renderHat(const RenderNote& note, std::span<float> out, float decayPerSecond, float level) const;
+    void renderBass(const RenderNote& note, std::span<float> out) const;
+    void renderLead(const RenderNote& note, std::span<float> out) const;
+
+    [[nodiscard]] static Voice drumVoice(uint8_t key);
+};
+
+} // namespace IndustrialMusic
\ No newline at end of file
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "Common.h"
+#include "LyricsGenerator.h"
+#include "PatternEngine.h"
+#include "PersistentVector.h"
+#include "VocalTimeline.h"
+
+namespace IndustrialMusic {
+
+// Everything generated for one section of a song: its notes, lyrics and
+// vocals. Each part is immutable and shared, with the section caches and
+// with other versions of the song.
+struct SongSection {
+    Section section;
+    std::array<std::shared_ptr<const NoteStream>, PATTERN_PART_COUNT> notes; // Ticks from the section start
+    std::shared_ptr<const SectionLyrics> lyrics;
+    std::shared_ptr<const SectionVocals> vocals;
+};
+
+struct SectionBeats {
+    static int64_t of(const SongSection& entry) { return entry.section.totalBeats(); }
+};
+
+// A song's sections in order, weighted by their beats so the section
+// playing at any beat is found in O(log n)
+using SongSections = PersistentVector<SongSection, SectionBeats>;
+
+struct SectionAtBeat {
+    const SongSection* entry = nullptr; // Null past the end
+    int64_t start = 0;                  // Beat the section starts on
+};
+
+[[nodiscard]] inline SectionAtBeat sectionAt(const SongSections& sections, int64_t beat) {
+    auto [index, start] = sections.find(beat);
+    if (index >= sections.size()) {
+        return {nullptr, start};
+    }
+    return {&sections[index], start};
+}
+
+} // namespace IndustrialMusic
\ No newline at end of file
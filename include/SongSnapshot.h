@@ -0,0 +1,56 @@
+#pragma once
+
+#include "Common.h"
+#include "SongSection.h"
+#include <atomic>
+
+namespace IndustrialMusic {
+
+// One published version of the song: its sections with the notes, lyrics
+// and vocals generated for them. Never modified after publication, so any
+// thread holding a pointer can read it without locking. Consecutive
+// versions share every section an edit did not touch.
+struct SongSnapshot {
+    uint64_t version = 0;
+    SongSections sections;
+
+    // Where sections[0] sits in a song that is played as a sliding window
+    // (endless mode): how many sections and beats came before it
+    uint64_t firstSection = 0;
+    int64_t firstBeat = 0;
+
+    SongSnapshot(uint64_t version, SongSections sections, uint64_t firstSection = 0, int64_t firstBeat = 0)
+        : version(version), sections(std::move(sections)), firstSection(firstSection), firstBeat(firstBeat) {}
+
+    [[nodiscard]] int totalBeats() const { return static_cast<int>(sections.totalWeight()); }
+
+    // Section playing at beat, or sections.size() once past the end
+    [[nodiscard]] size_t sectionAt(float beat) const {
+        return sections.find(static_cast<int64_t>(std::floor(beat))).index;
+    }
+
+    [[nodiscard]] int sectionStartBeat(size_t index) const { return static_cast<int>(sections.weightBefore(index)); }
+};
+
+// Holds the current snapshot. Readers take a reference with load() and keep
+// using it for as long as they like; writers build a complete new snapshot
+// and swap it in, and the old one is freed when its last reader lets go.
+class SongSnapshotSlot {
+public:
+    [[nodiscard]] std::shared_ptr<const SongSnapshot> load() const {
+        return m_current.load(std::memory_order_acquire);
+    }
+
+    // Publish a new version; returns the snapshot that readers will now see
+    std::shared_ptr<const SongSnapshot> publish(SongSections sections, uint64_t firstSection = 0, int64_t firstBeat = 0) {
+        auto snapshot = std::make_shared<const SongSnapshot>(++m_version, std::move(sections), firstSection, firstBeat);
+        m_current.store(snapshot, std::memory_order_release);
+        return snapshot;
+    }
+
+private:
+    std::atomic<std::shared_ptr<const SongSnapshot>> m_current;
+    std::atomic<uint64_t> m_version{0};
+};
+
+} // namespace IndustrialMusic
\ No newline at end of file
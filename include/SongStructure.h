@@ -1,25 +1,65 @@
 #pragma once
 
 #include "Common.h"
+#include "PersistentVector.h"
+#include "SectionCache.h"
+#include <deque>
 #include <functional>
+#include <optional>
 
 namespace IndustrialMusic {
 
+using SectionList = PersistentVector<Section>;
+
+// One edit as a splice: at index, the sections in removed were replaced by
+// those in inserted. Both share nodes with the versions they came from.
+struct SectionSplice {
+    size_t index = 0;
+    SectionList removed;
+    SectionList inserted;
+};
+
 class SongStructure {
 public:
     SongStructure();
     ~SongStructure() = default;
     
-    // Section management
+    // Section management. Added sections get a variation of their own;
+    // setSections keeps the variations it is given.
     void addSection(const Section& section);
     void removeSection(size_t index);
     void moveSection(size_t from, size_t to);
     void clearSections();
+    void setSections(const std::vector<Section>& sections);
+    
+    // Undo/redo. Every edit above and every preset load is one step; history
+    // is unlimited and each step costs O(log n) memory.
+    bool undo();
+    bool redo();
+    [[nodiscard]] bool canUndo() const { return !m_undoStack.empty(); }
+    [[nodiscard]] bool canRedo() const { return !m_redoStack.empty(); }
+    [[nodiscard]] size_t getUndoCount() const { return m_undoStack.size(); }
+    [[nodiscard]] size_t getRedoCount() const { return m_redoStack.size(); }
+    void clearHistory();
+    
+    // Distinct section entries held by the current version and all history
+    [[nodiscard]] size_t getHistoryNodeCount() const;
+    
+    // Counts changes to the sections, undo and redo included, so a reader
+    // can tell whether the song changed without comparing it
+    [[nodiscard]] uint64_t getVersion() const { return m_version; }
     
-    // Get sections
-    [[nodiscard]] const std::vector<Section>& getSections() const { return m_sections; }
-    [[nodiscard]] std::vector<Section>& getSections() { return m_sections; }
-    [[nodiscard]] size_t getSectionCount() const { return m_sections.size(); }
+    // The splices that turn the sections at version `since` into the
+    // current ones, oldest first; nullopt when since is older than the
+    // recent changes kept, and the reader has to start over from
+    // getSectionList()
+    [[nodiscard]] std::optional<std::vector<SectionSplice>> getChangesSince(uint64_t since) const;
+    
+    // Get sections. Read-only, so every change goes through the history. The
+    // vector is rebuilt on the first call after a change.
+    [[nodiscard]] const std::vector<Section>& getSections() const;
+    [[nodiscard]] const SectionList& getSectionList() const { return m_current; }
+    [[nodiscard]] size_t getSectionCount() const { return m_current.size(); }
     [[nodiscard]] const Section* getSection(size_t index) const;
     
     // Presets
@@ -40,7 +80,25 @@ public:
     void setSectionChangeCallback(SectionChangeCallback callback) { m_onSectionChange = callback; }
     
 private:
-    std::vector<Section> m_sections;
+    // A version kept for undo or redo, and the splices that lead from the
+    // older of it and its neighbour to the newer
+    struct HistoryStep {
+        SectionList sections;
+        std::vector<SectionSplice> splices;
+    };
+    
+    static constexpr size_t MAX_LOGGED_CHANGES = 256;
+    
+    // m_current is the authoritative version; m_sections caches it as a
+    // plain vector for readers until the next change
+    SectionList m_current;
+    std::vector<HistoryStep> m_undoStack;
+    std::vector<HistoryStep> m_redoStack;
+    uint64_t m_version = 0;
+    std::deque<SectionSplice> m_changes; // The last changes, up to m_version
+    mutable std::vector<Section> m_sections;
+    mutable bool m_sectionsStale = false;
+    SectionVariations m_variations; // Every variation handed out, history included
     SectionChangeCallback m_onSectionChange;
     
     // Preset definitions
@@ -49,14 +107,21 @@ private:
     void createExtendedPreset();
     void createIndustrialPreset();
     
+    // Make the result of splices the current version, recording the old
+    // one for undo
+    void commit(std::vector<SectionSplice> splices);
+    
+    // Record splices as changes; they are applied by the caller
+    void logChanges(const std::vector<SectionSplice>& splices);
+    
     // Helper to notify changes
     void notifyChange(size_t index);
 };
 
-// Preset templates
+// Preset templates, with repeated sections numbered apart
 namespace Presets {
     inline std::vector<Section> getStandardStructure() {
-        return {
+        return numberVariations({
             {SectionType::Intro, "INTRO", 2, 4},
             {SectionType::Verse, "VERSE", 4, 4},
             {SectionType::PreChorus, "PRE-CHORUS", 2, 4},
@@ -67,22 +132,22 @@ namespace Presets {
             {SectionType::Bridge, "BRIDGE", 4, 4},
             {SectionType::Chorus, "CHORUS", 4, 4},
             {SectionType::Outro, "OUTRO", 2, 4}
-        };
+        });
     }
     
     inline std::vector<Section> getSimpleStructure() {
-        return {
+        return numberVariations({
             {SectionType::Intro, "INTRO", 2, 4},
             {SectionType::Verse, "VERSE", 4, 4},
             {SectionType::Chorus, "CHORUS", 4, 4},
             {SectionType::Verse, "VERSE", 4, 4},
             {SectionType::Chorus, "CHORUS", 4, 4},
             {SectionType::Outro, "OUTRO", 2, 4}
-        };
+        });
     }
     
     inline std::vector<Section> getExtendedStructure() {
-        return {
+        return numberVariations({
             {SectionType::Intro, "INTRO", 4, 4},
             {SectionType::Verse, "VERSE", 4, 4},
             {SectionType::PreChorus, "PRE-CHORUS", 2, 4},
@@ -95,11 +160,11 @@ namespace Presets {
             {SectionType::Breakdown, "BREAKDOWN", 2, 4},
             {SectionType::Chorus, "CHORUS", 8, 4},
             {SectionType::Outro, "OUTRO", 4, 4}
-        };
+        });
     }
     
     inline std::vector<Section> getIndustrialStructure() {
-        return {
+        return numberVariations({
             {SectionType::Intro, "INTRO", 4, 4},
             {SectionType::Breakdown, "BREAKDOWN", 2, 4},
             {SectionType::Verse, "VERSE", 4, 4},
@@ -111,7 +176,7 @@ namespace Presets {
             {SectionType::Chorus, "CHORUS", 8, 4},
             {SectionType::Breakdown, "BREAKDOWN", 2, 4},
             {SectionType::Outro, "OUTRO", 4, 4}
-        };
+        });
     }
 }
 
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "Common.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <queue>
+#include <future>
+
+namespace IndustrialMusic {
+
+// Fixed-size pool of worker threads running tasks in submission order.
+// A task must not block on another task submitted to the same pool, or
+// the pool can run out of workers and deadlock.
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t threadCount = std::thread::hardware_concurrency());
+    ~ThreadPool();
+
+    // Prevent copying and moving (workers hold a pointer to the pool)
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Queue a task and get a future for its result
+    template<typename F>
+    [[nodiscard]] auto submit(F&& task) -> std::future<std::invoke_result_t<F>> {
+        std::packaged_task<std::invoke_result_t<F>()> packaged(std::forward<F>(task));
+        auto future = packaged.get_future();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_tasks.emplace([packaged = std::move(packaged)]() mutable { packaged(); });
+        }
+        m_cv.notify_one();
+        return future;
+    }
+
+    [[nodiscard]] size_t size() const { return m_workers.size(); }
+
+private:
+    std::vector<std::thread> m_workers;
+    std::queue<std::move_only_function<void()>> m_tasks;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_stopping = false;
+
+    void workerLoop();
+};
+
+} // namespace IndustrialMusic
\ No newline at end of file
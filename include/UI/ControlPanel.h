@@ -14,6 +14,7 @@ public:
     void render();
     
     [[nodiscard]] const AudioParams& getParams() const { return m_params; }
+    void setParams(const AudioParams& params) { m_params = params; }
     
 private:
     AudioEngine& m_audioEngine;
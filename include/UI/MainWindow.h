@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../Common.h"
+#include <filesystem>
 #include <memory>
 
 namespace IndustrialMusic {
@@ -9,6 +10,10 @@ class Application;
 class SongStructureEditor;
 class ControlPanel;
 class Visualizer3D;
+struct SongSnapshot;
+struct AutomationLane;
+class EndlessArrangement;
+class LiveSong;
 
 class MainWindow {
 public:
@@ -35,16 +40,39 @@ private:
     std::string m_statusText;
     float m_progress = 0.0f;
     
-    // Lyrics
-    std::vector<std::string> m_currentLyrics;
-    std::string m_currentVocalText;
+    // Generated song, with its notes, lyrics and vocals, built from version
+    // m_songVersion of the song structure; later edits are spliced in.
+    // m_song is the snapshot last published to the audio engine.
+    uint32_t m_songSeed = 0;
+    std::unique_ptr<LiveSong> m_liveSong;
+    std::shared_ptr<const SongSnapshot> m_song;
+    uint64_t m_songVersion = 0;
+    
+    // Continuous mode: the song followed by generated sections, without
+    // end, and what is generated for the window being played
+    std::unique_ptr<EndlessArrangement> m_endless;
+    std::unique_ptr<LiveSong> m_endlessSong;
+    
+    // Word-bank packs found in the packs directory, rescanned whenever the
+    // picker opens so new files show up without a restart
+    std::vector<std::filesystem::path> m_wordPacks;
+    std::string m_wordPackName = "Built-in";
+    
+    // Automation lanes, kept with the project
+    std::vector<AutomationLane> m_automation;
     
     // Helper methods
     void renderMenuBar();
     void renderStatusBar();
     void renderProgressBar();
     void renderLyricsWindow();
+    void renderWordPackPicker();
     void renderVocalOutputWindow();
+    void rebuildSong();
+    void updateSong();
+    void publishSong();
+    void startEndless();
+    void advanceEndless();
     
     // Actions
     void onGenerateSong();
@@ -52,8 +80,12 @@ private:
     void onStopSong();
     void onLoopToggle();
     void onDownloadMidi();
+    void onExportAudio();
     void onRegenerateLyrics();
     void onExportLyrics();
+    void onSelectWordPack(const std::filesystem::path& filepath);
+    void onSaveProject();
+    void onOpenProject();
 };
 
 } // namespace IndustrialMusic
\ No newline at end of file
@@ -1,37 +1,71 @@
 #pragma once
 
 #include "Common.h"
+#include "ChannelVocoder.h"
+#include "FormantSynth.h"
+#include "SongSection.h"
+#include <atomic>
 #include <string>
 #include <optional>
 
 namespace IndustrialMusic {
 
+// Sings a song's lyrics with a formant voice. Each section's vocal
+// schedule is compiled up front with compileVocals, and setSong hands over
+// the song's sections; during playback onBeat and processAudio (both on
+// the audio thread) only index them. Everything else is called from the
+// UI thread, which also frees replaced songs, so the audio thread never
+// drops the last reference to one (or to the phonemes it owns).
 class VocalSynthesizer {
 public:
     VocalSynthesizer();
     ~VocalSynthesizer() = default;
     
-    // Set vocal type
-    void setVocalType(AudioParams::VocalType type) { m_vocalType = type; }
-    [[nodiscard]] AudioParams::VocalType getVocalType() const { return m_vocalType; }
+    // Set vocal type. Effects change at once; vocals compiled from then on
+    // are styled for it, so recompile the song's to restyle their text.
+    void setVocalType(AudioParams::VocalType type) { m_vocalType.store(type); }
+    [[nodiscard]] AudioParams::VocalType getVocalType() const { return m_vocalType.load(); }
     
-    // Generate vocal for a specific beat and section
-    [[nodiscard]] std::optional<std::string> generateVocal(
-        const Section& section,
-        int beat,
-        const std::vector<std::string>& lyrics
-    );
+    // Compile one section's vocals in the current style. Lines are
+    // phonemized through a shared cache, so repeated lines convert once.
+    [[nodiscard]] std::shared_ptr<const SectionVocals> compileVocals(const Section& section, const SectionLyrics& lyrics);
     
-    // Process vocal audio (apply effects)
+    // Sing these sections from now on; beats count from the first of them
+    void setSong(SongSections sections);
+    
+    // Lines are sped up to end before the next vocal at this tempo
+    void setTempo(int bpm) { m_tempo.store(std::max(bpm, 1)); }
+    
+    // The sections being sung; never null
+    [[nodiscard]] std::shared_ptr<const SongSections> getSong() const {
+        return m_song.load(std::memory_order_acquire);
+    }
+    
+    // Start the vocal due on beat (counted from the start of the song), if
+    // any, and return it with its beat in its section. Call as playback
+    // reaches each beat; a beat only starts its vocal once. Does not allocate.
+    std::optional<VocalEvent> onBeat(int beat);
+    
+    // Add the line being sung into buffer, then apply the style's effects
     void processAudio(std::span<float> buffer, float sampleRate);
     
+    [[nodiscard]] const Phonemizer& getPhonemizer() const { return m_phonemizer; }
+    
 private:
-    AudioParams::VocalType m_vocalType = AudioParams::VocalType::Whisper;
-    std::string m_currentVocal;
+    std::atomic<AudioParams::VocalType> m_vocalType{AudioParams::VocalType::Whisper};
+    std::atomic<int> m_tempo{70};
+    
+    Phonemizer m_phonemizer;
+    std::atomic<std::shared_ptr<const SongSections>> m_song;
+    std::vector<std::shared_ptr<const SongSections>> m_retired; // Replaced, possibly still held by the audio thread
+    
+    // Playback (audio thread)
+    std::shared_ptr<const SongSections> m_playing; // Owns the line the voice is singing
     int m_lastVocalBeat = -1;
+    FormantSynth m_voice;
     
     // Effect parameters
-    float m_roboticModulation = 0.0f;
+    ChannelVocoder m_vocoder;
     float m_whisperBreathiness = 0.8f;
     float m_distortionAmount = 0.0f;
 };
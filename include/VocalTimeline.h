@@ -0,0 +1,75 @@
+#pragma once
+
+#include "Common.h"
+#include "Phonemizer.h"
+#include "Prosody.h"
+#include <string_view>
+
+namespace IndustrialMusic {
+
+// One sung line
+struct VocalEvent {
+    int beat = 0;            // From the start of its section
+    int beats = 0;           // Until the next vocal is due
+    uint32_t line = 0;       // Index into the section's lyrics
+    uint32_t textOffset = 0; // Styled text, in the section's text
+    uint32_t textLength = 0;
+};
+
+// The vocals of one section, compiled once when its lyrics or the vocal
+// style change: which of its lines is sung on which beat, the text as
+// displayed in the style, and its phonemes. A song's sections are compiled
+// separately, so an edit only compiles the sections it adds. Never
+// modified after compilation, so playback and the UI can share it across
+// threads and look up any beat without allocating.
+class SectionVocals {
+public:
+    SectionVocals() = default;
+
+    // Sections sing at fixed intervals (Verse every 8 beats, Chorus 4,
+    // Bridge 16, Breakdown 32) from their start, moving to the next of
+    // their lines every 8 beats. With prosody (one entry per line) a line
+    // is chosen that can be sung before the next vocal; otherwise it is
+    // worked out from the text.
+    [[nodiscard]] static SectionVocals compile(
+        const Section& section,
+        std::span<const std::string> lines,
+        AudioParams::VocalType style,
+        Phonemizer& phonemizer,
+        std::span<const LineProsody> prosody = {}
+    );
+
+    // The vocal starting on beat, if any
+    [[nodiscard]] const VocalEvent* eventAt(int beat) const {
+        const VocalEvent* event = activeAt(beat);
+        return event && event->beat == beat ? event : nullptr;
+    }
+
+    // The vocal due at beat: started on it or after the previous one, and
+    // before the next vocal or the end of its section
+    [[nodiscard]] const VocalEvent* activeAt(int beat) const {
+        if (beat < 0 || static_cast<size_t>(beat) >= m_active.size() || m_active[beat] < 0) {
+            return nullptr;
+        }
+        return &m_events[static_cast<size_t>(m_active[beat])];
+    }
+
+    [[nodiscard]] std::string_view text(const VocalEvent& event) const {
+        return std::string_view(m_text).substr(event.textOffset, event.textLength);
+    }
+
+    [[nodiscard]] const std::shared_ptr<const PhonemeLine>& phonemes(const VocalEvent& event) const {
+        return m_phonemes[event.line];
+    }
+
+    [[nodiscard]] std::span<const VocalEvent> getEvents() const { return m_events; }
+    [[nodiscard]] int getTotalBeats() const { return static_cast<int>(m_active.size()); }
+
+private:
+    std::vector<VocalEvent> m_events;                        // In beat order
+    std::vector<int32_t> m_active;                           // Per beat: the event due, or -1
+    std::string m_text;                                      // Styled text of every line sung, each once
+    std::vector<std::shared_ptr<const PhonemeLine>> m_phonemes; // Per line; null for lines never sung
+};
+
+} // namespace IndustrialMusic
\ No newline at end of file
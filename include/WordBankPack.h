@@ -0,0 +1,79 @@
+#pragma once
+
+#include "Common.h"
+#include "MappedFile.h"
+#include "LyricTemplate.h"
+#include <filesystem>
+#include <string_view>
+
+namespace IndustrialMusic {
+
+// A themed set of weighted word banks for the lyric template slots, loaded
+// from a plain-text pack file (.imwords) so writers can maintain and swap
+// vocabularies without a rebuild:
+//
+//     # Comments start with '#'
+//     [noun]
+//     machine 3
+//     steel mill 0.5
+//     rust
+//
+// Each line under a [adj], [noun], [verb] or [theme] header is one entry,
+// optionally followed by a weight (default 1; 0 leaves the entry out).
+// The file is memory-mapped and words stay views into the mapping. Each
+// bank gets a Walker alias table and every word its prosody when the pack
+// is loaded, so drawing a word is O(1) whatever the bank size. Packs are
+// read-only and can be shared between generators on any number of threads.
+class WordBankPack {
+public:
+    static constexpr const char* EXTENSION = ".imwords";
+
+    // Map and parse a file. Fails with InvalidFileFormat on an unknown
+    // header, an entry before the first header, a negative or malformed
+    // weight, or a pack without any words.
+    [[nodiscard]] static Result<WordBankPack> open(const std::filesystem::path& filepath);
+
+    // Parse text owned by the caller, which must outlive the pack
+    [[nodiscard]] static Result<WordBankPack> parse(std::string_view text);
+
+    [[nodiscard]] size_t getWordCount(LyricSlot slot) const { return bank(slot).words.size(); }
+    [[nodiscard]] bool hasWords(LyricSlot slot) const { return !bank(slot).words.empty(); }
+    [[nodiscard]] size_t getMaxWordLength() const { return m_maxWordLength; }
+
+    [[nodiscard]] LyricWord word(LyricSlot slot, size_t index) const {
+        const Bank& words = bank(slot);
+        return {words.words[index], words.prosody[index]};
+    }
+
+    // Draw a word by weight with 64 uniform random bits: the high half
+    // picks a column, the low half decides between it and its alias. The
+    // slot's bank must not be empty.
+    [[nodiscard]] LyricWord pick(LyricSlot slot, uint64_t random) const {
+        const Bank& words = bank(slot);
+        auto column = static_cast<size_t>(((random >> 32) * words.columns.size()) >> 32);
+        const Column& entry = words.columns[column];
+        size_t index = static_cast<uint32_t>(random) < entry.threshold ? column : entry.alias;
+        return {words.words[index], words.prosody[index]};
+    }
+
+private:
+    struct Column {
+        uint32_t threshold; // Keep the column's own word below this
+        uint32_t alias;
+    };
+
+    struct Bank {
+        std::vector<std::string_view> words;
+        std::vector<WordProsody> prosody;
+        std::vector<Column> columns;
+    };
+
+    MappedFile m_file;
+    std::array<Bank, LYRIC_SLOT_COUNT> m_banks;
+    size_t m_maxWordLength = 0;
+
+    [[nodiscard]] const Bank& bank(LyricSlot slot) const { return m_banks[static_cast<size_t>(slot)]; }
+    [[nodiscard]] Result<void> load(std::string_view text);
+};
+
+} // namespace IndustrialMusic
\ No newline at end of file
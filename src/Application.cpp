@@ -5,6 +5,9 @@
 #include "Visualizer.h"
 #include "VocalSynthesizer.h"
 #include "LyricsGenerator.h"
+#include "SongRenderer.h"
+#include "ThreadPool.h"
+#include "SongCache.h"
 #include "UI/MainWindow.h"
 
 #include <glad/glad.h>
@@ -113,12 +116,27 @@ Result<void> Application::initializeImGui() {
 
 Result<void> Application::initializeComponents() {
     // Create core components
+    m_threadPool = std::make_unique<ThreadPool>();
     m_audioEngine = std::make_unique<AudioEngine>();
     m_midiGenerator = std::make_unique<MidiGenerator>();
+    m_midiGenerator->setThreadPool(m_threadPool.get());
+    m_midiGenerator->setSectionCacheCapacity(SECTION_CACHE_CAPACITY);
+    
+    // Repeated exports are served from disk; run without the cache if it cannot be created
+    auto cacheDir = std::filesystem::temp_directory_path() / "industrial_music_cache";
+    if (auto cache = SongCache::open(cacheDir, SONG_CACHE_BYTES)) {
+        m_songCache = std::move(*cache);
+        m_midiGenerator->setSongCache(m_songCache.get());
+    } else {
+        std::cerr << "Warning: song cache unavailable\n";
+    }
     m_songStructure = std::make_unique<SongStructure>();
     m_visualizer = std::make_unique<Visualizer>();
     m_vocalSynth = std::make_unique<VocalSynthesizer>();
     m_lyricsGen = std::make_unique<LyricsGenerator>();
+    m_lyricsGen->setSectionCacheCapacity(SECTION_CACHE_CAPACITY);
+    m_songRenderer = std::make_unique<SongRenderer>();
+    m_songRenderer->setThreadPool(m_threadPool.get());
     
     // Initialize audio engine
     if (auto result = m_audioEngine->initialize(); !result) {
@@ -168,7 +186,11 @@ void Application::update(float deltaTime) {
         auto freqData = m_audioEngine->getFrequencyData();
         std::copy(freqData.begin(), freqData.end(), vizData.frequencies.begin());
         vizData.currentBeat = m_audioEngine->getCurrentBeat();
-        vizData.currentSection = static_cast<SectionType>(m_audioEngine->getCurrentSectionIndex());
+        auto song = m_audioEngine->getSong();
+        auto sectionIndex = static_cast<size_t>(m_audioEngine->getCurrentSectionIndex());
+        if (song && sectionIndex < song->sections.size()) {
+            vizData.currentSection = song->sections[sectionIndex].section.type;
+        }
         vizData.sectionProgress = m_audioEngine->getSectionProgress();
         
         m_visualizer->update(vizData, deltaTime);
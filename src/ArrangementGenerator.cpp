@@ -0,0 +1,145 @@
+#include "ArrangementGenerator.h"
+
+namespace IndustrialMusic {
+
+namespace {
+
+constexpr size_t typeIndex(SectionType type) {
+    return static_cast<size_t>(type);
+}
+
+// Uniform in [0, 1) from one generator step
+float unitRandom(std::minstd_rand& rng) {
+    return static_cast<float>(rng() - std::minstd_rand::min()) /
+           static_cast<float>(std::minstd_rand::max() - std::minstd_rand::min() + 1);
+}
+
+// Index of the first running total above target, or npos when the totals are empty or all zero
+size_t pick(std::span<const float> cumulative, float unit) {
+    if (cumulative.empty() || cumulative.back() <= 0.0f) return std::string::npos;
+    float target = unit * cumulative.back();
+    auto found = std::ranges::upper_bound(cumulative, target);
+    return std::min(static_cast<size_t>(found - cumulative.begin()), cumulative.size() - 1);
+}
+
+} // namespace
+
+ArrangementRules ArrangementRules::industrial() {
+    using enum SectionType;
+    ArrangementRules rules;
+
+    auto row = [&](SectionType from, std::initializer_list<std::pair<SectionType, float>> weights) {
+        for (const auto& [to, weight] : weights) {
+            rules.transitions[typeIndex(from)][typeIndex(to)] = weight;
+        }
+    };
+    row(Intro, {{Verse, 0.6f}, {Breakdown, 0.25f}, {Instrumental, 0.15f}});
+    row(Verse, {{PreChorus, 0.4f}, {Chorus, 0.35f}, {Instrumental, 0.15f}, {Breakdown, 0.1f}});
+    row(PreChorus, {{Chorus, 0.9f}, {Breakdown, 0.1f}});
+    row(Chorus, {{Verse, 0.35f}, {Breakdown, 0.25f}, {Bridge, 0.2f}, {Instrumental, 0.1f}, {Chorus, 0.05f}, {Outro, 0.05f}});
+    row(Bridge, {{Chorus, 0.6f}, {Breakdown, 0.25f}, {Instrumental, 0.15f}});
+    row(Instrumental, {{Verse, 0.4f}, {Chorus, 0.3f}, {Breakdown, 0.2f}, {Bridge, 0.1f}});
+    row(Breakdown, {{Verse, 0.35f}, {Chorus, 0.35f}, {Instrumental, 0.2f}, {Outro, 0.1f}});
+    row(Outro, {{Intro, 1.0f}});
+
+    rules.barLengths[typeIndex(Intro)] = {{2, 0.3f}, {4, 0.6f}, {8, 0.1f}};
+    rules.barLengths[typeIndex(Verse)] = {{4, 0.5f}, {8, 0.5f}};
+    rules.barLengths[typeIndex(PreChorus)] = {{2, 0.7f}, {4, 0.3f}};
+    rules.barLengths[typeIndex(Chorus)] = {{4, 0.6f}, {8, 0.4f}};
+    rules.barLengths[typeIndex(Bridge)] = {{4, 0.8f}, {8, 0.2f}};
+    rules.barLengths[typeIndex(Instrumental)] = {{4, 0.5f}, {8, 0.4f}, {16, 0.1f}};
+    rules.barLengths[typeIndex(Breakdown)] = {{2, 0.4f}, {4, 0.6f}};
+    rules.barLengths[typeIndex(Outro)] = {{2, 0.5f}, {4, 0.5f}};
+    return rules;
+}
+
+ArrangementGenerator::ArrangementGenerator(ArrangementRules rules, uint32_t seed)
+    : m_rules(std::move(rules)), m_seed(seed) {
+    for (size_t from = 0; from < SECTION_TYPE_COUNT; ++from) {
+        float total = 0.0f;
+        for (size_t to = 0; to < SECTION_TYPE_COUNT; ++to) {
+            total += std::max(m_rules.transitions[from][to], 0.0f);
+            m_cumulativeTransitions[from][to] = total;
+        }
+
+        total = 0.0f;
+        for (const auto& choice : m_rules.barLengths[from]) {
+            total += std::max(choice.weight, 0.0f);
+            m_cumulativeBars[from].push_back(total);
+        }
+    }
+}
+
+void ArrangementGenerator::continueFrom(SectionType previous, uint64_t index) {
+    m_previous = previous;
+    m_index = index;
+}
+
+Section ArrangementGenerator::next() {
+    // Generated sections never move, so their number in the stream seeds them
+    std::minstd_rand rng((m_seed + static_cast<uint32_t>(m_index) * 0x9E3779B9u) | 1u);
+    rng.discard(2); // The first outputs are close to linear in the seed
+
+    SectionType type = SectionType::Intro;
+    if (m_previous) {
+        size_t to = pick(m_cumulativeTransitions[typeIndex(*m_previous)], unitRandom(rng));
+        type = to == std::string::npos ? SectionType::Verse : static_cast<SectionType>(to);
+    }
+
+    int bars = 4;
+    const auto& lengths = m_rules.barLengths[typeIndex(type)];
+    if (size_t choice = pick(m_cumulativeBars[typeIndex(type)], unitRandom(rng)); choice != std::string::npos) {
+        bars = std::max(lengths[choice].bars, 1);
+    }
+
+    m_previous = type;
+    ++m_index;
+    return {type, sectionTypeToString(type), bars, m_rules.beatsPerBar};
+}
+
+EndlessArrangement::EndlessArrangement(std::vector<Section> intro, ArrangementRules rules, uint32_t seed, size_t lookahead)
+    : m_generator(std::move(rules), seed), m_intro(std::move(intro)), m_lookahead(std::max<size_t>(lookahead, 1)) {
+    if (!m_intro.empty()) {
+        m_generator.continueFrom(m_intro.back().type, m_intro.size());
+    }
+    for (const auto& section : m_intro) {
+        m_variations.reserve(section);
+    }
+    advance(0);
+}
+
+bool EndlessArrangement::advance(uint64_t playingSection) {
+    bool changed = false;
+
+    // Retire everything before the playing section
+    size_t retire = static_cast<size_t>(std::min<uint64_t>(playingSection - std::min(playingSection, m_firstSection), m_window.size()));
+    if (retire > 0) {
+        for (size_t i = 0; i < retire; ++i) {
+            m_firstBeat += m_window[i].totalBeats();
+        }
+        m_window.erase(m_window.begin(), m_window.begin() + static_cast<ptrdiff_t>(retire));
+        m_firstSection += retire;
+        changed = true;
+    }
+
+    while (m_window.size() < m_lookahead + 1) {
+        m_window.push_back(nextSection());
+        changed = true;
+    }
+    return changed;
+}
+
+Section EndlessArrangement::nextSection() {
+    if (m_introNext < m_intro.size()) {
+        Section section = m_intro[m_introNext++];
+        if (m_introNext == m_intro.size()) {
+            m_intro = {};
+        }
+        return section;
+    }
+    Section section = m_generator.next();
+    m_variations.assign(section);
+    return section;
+}
+
+} // namespace IndustrialMusic
\ No newline at end of file
@@ -0,0 +1,406 @@
+#include "ArrangementSearch.h"
+#include "AliasTable.h"
+#include "Hash.h"
+#include "ThreadPool.h"
+#include <bit>
+#include <future>
+
+namespace IndustrialMusic {
+
+namespace {
+
+// Candidates scored together; the scoring arrays for one batch stay in L2
+constexpr size_t BATCH = 1024;
+constexpr size_t BATCHES_PER_TASK = 16;
+
+// Cost of a transition the rules never make: log(1e-3)
+constexpr float IMPOSSIBLE_TRANSITION = 6.9f;
+
+constexpr size_t BAR_CODES = 4; // 2, 4, 8 or 16 bars
+constexpr size_t MAX_SECTIONS = ArrangementSearch::MAX_SECTIONS;
+
+constexpr int barsForCode(uint8_t code) {
+    return 2 << code;
+}
+
+// One byte per section: type in the high bits, bar code in the low two
+struct PackedArrangement {
+    std::array<uint8_t, MAX_SECTIONS> codes{};
+    uint8_t count = 0;
+};
+
+struct Candidate {
+    float cost = 0.0f;
+    float seconds = 0.0f;
+    float energyError = 0.0f;
+    uint64_t index = 0;
+    PackedArrangement arrangement;
+};
+
+// Orders by cost, then by candidate index so ties do not depend on scheduling
+struct Better {
+    bool operator()(const Candidate& a, const Candidate& b) const {
+        return a.cost < b.cost || (a.cost == b.cost && a.index < b.index);
+    }
+};
+
+bool sameArrangement(const PackedArrangement& a, const PackedArrangement& b) {
+    return a.count == b.count && std::equal(a.codes.begin(), a.codes.begin() + a.count, b.codes.begin());
+}
+
+// The best distinct arrangements seen so far, kept as a heap with the worst on top
+class TopK {
+public:
+    explicit TopK(size_t keep) : m_keep(keep) { m_heap.reserve(keep); }
+
+    // Cheap rejection before a candidate is filled in
+    [[nodiscard]] bool admits(const Candidate& candidate) const {
+        return m_heap.size() < m_keep || Better{}(candidate, m_heap.front());
+    }
+
+    void add(const Candidate& candidate) {
+        // Likely arrangements are drawn many times; keep the first draw only
+        for (auto& kept : m_heap) {
+            if (sameArrangement(kept.arrangement, candidate.arrangement)) {
+                if (Better{}(candidate, kept)) {
+                    kept = candidate;
+                    std::ranges::make_heap(m_heap, Better{});
+                }
+                return;
+            }
+        }
+
+        if (m_heap.size() == m_keep) {
+            std::ranges::pop_heap(m_heap, Better{});
+            m_heap.pop_back();
+        }
+        m_heap.push_back(candidate);
+        std::ranges::push_heap(m_heap, Better{});
+    }
+
+    [[nodiscard]] std::vector<Candidate> take() { return std::move(m_heap); }
+
+private:
+    size_t m_keep;
+    std::vector<Candidate> m_heap;
+};
+
+// splitmix64; one stream per batch. Stream starts are hashed, since
+// nearby starting states would replay each other's sequences shifted.
+class Random {
+public:
+    Random(uint32_t seed, uint64_t stream) : m_state(mix64(mix64(seed) ^ (stream * GOLDEN_GAMMA))) {}
+
+    uint32_t next() {
+        return static_cast<uint32_t>(mix64(m_state += GOLDEN_GAMMA) >> 32);
+    }
+
+    uint32_t below(uint32_t bound) { return static_cast<uint32_t>((static_cast<uint64_t>(next()) * bound) >> 32); }
+
+private:
+    uint64_t m_state;
+};
+
+// Walker alias table over N (a power of two) outcomes: the top bits of a
+// random word pick a column, the rest decide between the column and its
+// alias. One draw and no data-dependent branches, unlike a running-total
+// search, whose mispredictions dominated candidate generation.
+template<size_t N>
+class AliasTable {
+public:
+    static_assert(std::has_single_bit(N));
+
+    AliasTable() = default;
+
+    // All-zero weights always give fallback
+    AliasTable(const std::array<float, N>& weights, size_t fallback) {
+        double total = 0.0;
+        for (float weight : weights) {
+            total += std::max(weight, 0.0f);
+        }
+        if (total <= 0.0) {
+            m_threshold.fill(0);
+            m_alias.fill(static_cast<uint8_t>(fallback));
+            return;
+        }
+
+        const auto clamped = weights | std::views::transform([](float weight) { return std::max(weight, 0.0f); });
+        buildAliasTable(clamped, [this](size_t column, double probability, size_t alias) {
+            setColumn(column, probability, alias);
+        });
+    }
+
+    [[nodiscard]] size_t sample(uint32_t random) const {
+        size_t column = random >> (32 - COLUMN_BITS);
+        return (random & LOW_MASK) < m_threshold[column] ? column : m_alias[column];
+    }
+
+private:
+    static constexpr int COLUMN_BITS = std::countr_zero(N);
+    static constexpr uint32_t LOW_MASK = static_cast<uint32_t>((1ull << (32 - COLUMN_BITS)) - 1);
+
+    std::array<uint32_t, N> m_threshold{};
+    std::array<uint8_t, N> m_alias{};
+
+    void setColumn(size_t column, double probability, size_t alias) {
+        m_threshold[column] = static_cast<uint32_t>(std::min(probability, 1.0) * (static_cast<double>(LOW_MASK) + 1.0));
+        m_alias[column] = static_cast<uint8_t>(alias);
+        // Exactly 1 does not fit; the alias is the column itself then
+        if (probability >= 1.0) m_threshold[column] = LOW_MASK;
+    }
+};
+
+// Everything derived from the brief once per search
+struct SearchTables {
+    std::array<AliasTable<SECTION_TYPE_COUNT>, SECTION_TYPE_COUNT> transitions;
+    std::array<std::array<float, SECTION_TYPE_COUNT>, SECTION_TYPE_COUNT> transitionCost{}; // -log probability
+    std::array<AliasTable<BAR_CODES>, SECTION_TYPE_COUNT> barCodes;
+    std::array<float, SECTION_TYPE_COUNT> energy{};
+    std::vector<float> curve;
+    float secondsPerBeat = 0.0f;
+    float targetSeconds = 0.0f;
+    float beatsPerBar = 4.0f;
+    uint32_t minSections = 0;
+    uint32_t sectionRange = 0;
+    bool startWithIntro = false;
+    bool endWithOutro = false;
+    float durationWeight = 0.0f;
+    float energyWeight = 0.0f;
+    float transitionWeight = 0.0f;
+
+    explicit SearchTables(const ArrangementBrief& brief) {
+        const auto& rules = brief.rules;
+        for (size_t from = 0; from < SECTION_TYPE_COUNT; ++from) {
+            transitions[from] = AliasTable<SECTION_TYPE_COUNT>(rules.transitions[from], static_cast<size_t>(SectionType::Verse));
+            float total = 0.0f;
+            for (float weight : rules.transitions[from]) {
+                total += std::max(weight, 0.0f);
+            }
+            for (size_t to = 0; to < SECTION_TYPE_COUNT; ++to) {
+                float weight = std::max(rules.transitions[from][to], 0.0f);
+                transitionCost[from][to] = weight > 0.0f ? std::min(-std::log(weight / total), IMPOSSIBLE_TRANSITION)
+                                                         : IMPOSSIBLE_TRANSITION;
+            }
+
+            // Lengths outside the encodable set go to the nearest code
+            std::array<float, BAR_CODES> weights{};
+            for (const auto& choice : rules.barLengths[from]) {
+                int code = static_cast<int>(std::lround(std::log2(std::max(choice.bars, 1)))) - 1;
+                weights[static_cast<size_t>(std::clamp(code, 0, static_cast<int>(BAR_CODES) - 1))] += std::max(choice.weight, 0.0f);
+            }
+            barCodes[from] = AliasTable<BAR_CODES>(weights, 1);
+
+            energy[from] = brief.sectionEnergy[from];
+        }
+
+        curve = brief.energyCurve;
+        secondsPerBeat = 60.0f / static_cast<float>(brief.tempo);
+        targetSeconds = brief.targetSeconds;
+        beatsPerBar = static_cast<float>(rules.beatsPerBar);
+        minSections = static_cast<uint32_t>(brief.minSections);
+        sectionRange = static_cast<uint32_t>(brief.maxSections - brief.minSections + 1);
+        startWithIntro = brief.startWithIntro;
+        endWithOutro = brief.endWithOutro;
+        durationWeight = brief.durationWeight;
+        energyWeight = brief.energyWeight;
+        transitionWeight = brief.transitionWeight;
+    }
+};
+
+// Scoring arrays for one batch, position-major: [section * BATCH + candidate].
+// Fixed-size members, so the compiler can see they never overlap.
+struct BatchBuffers {
+    std::array<float, MAX_SECTIONS * BATCH> beats;
+    std::array<float, MAX_SECTIONS * BATCH> energy;
+    std::array<float, BATCH> transitionCost;
+    std::array<float, BATCH> totalBeats;
+    std::array<float, BATCH> energyError;
+    std::array<float, BATCH> sectionStart;
+    std::array<float, BATCH> sampled;
+    std::array<PackedArrangement, BATCH> packed;
+};
+
+// Walk the rules' Markov chain for every candidate in the batch
+void propose(const SearchTables& tables, Random& rng, size_t count, BatchBuffers& buffers) {
+    for (size_t c = 0; c < count; ++c) {
+        auto& packed = buffers.packed[c];
+        packed.count = static_cast<uint8_t>(tables.minSections + rng.below(tables.sectionRange));
+
+        size_t previous = 0;
+        float transitionCost = 0.0f;
+        for (size_t p = 0; p < MAX_SECTIONS; ++p) {
+            if (p >= packed.count) {
+                buffers.beats[p * BATCH + c] = 0.0f;
+                buffers.energy[p * BATCH + c] = 0.0f;
+                continue;
+            }
+
+            size_t type;
+            if (p == 0) {
+                type = tables.startWithIntro ? static_cast<size_t>(SectionType::Intro) : rng.below(SECTION_TYPE_COUNT);
+            } else if (p + 1 == packed.count && tables.endWithOutro) {
+                type = static_cast<size_t>(SectionType::Outro);
+            } else {
+                type = tables.transitions[previous].sample(rng.next());
+            }
+            if (p > 0) {
+                transitionCost += tables.transitionCost[previous][type];
+            }
+
+            auto barCode = static_cast<uint8_t>(tables.barCodes[type].sample(rng.next()));
+            packed.codes[p] = static_cast<uint8_t>(type << 2 | barCode);
+            buffers.beats[p * BATCH + c] = static_cast<float>(barsForCode(barCode)) * tables.beatsPerBar;
+            buffers.energy[p * BATCH + c] = tables.energy[type];
+            previous = type;
+        }
+        buffers.transitionCost[c] = packed.count > 1 ? transitionCost / static_cast<float>(packed.count - 1) : 0.0f;
+    }
+}
+
+// Duration and energy terms for a whole batch. Every loop runs across
+// candidates with no branches, so it vectorizes.
+void score(const SearchTables& tables, BatchBuffers& buffers) {
+    buffers.totalBeats.fill(0.0f);
+    for (size_t p = 0; p < MAX_SECTIONS; ++p) {
+        for (size_t c = 0; c < BATCH; ++c) {
+            buffers.totalBeats[c] += buffers.beats[p * BATCH + c];
+        }
+    }
+
+    // Energy at each curve point is that of the section playing there
+    buffers.energyError.fill(0.0f);
+    const size_t points = tables.curve.size();
+    for (size_t j = 0; j < points; ++j) {
+        const float position = (static_cast<float>(j) + 0.5f) / static_cast<float>(points);
+        const float target = tables.curve[j];
+        buffers.sectionStart.fill(0.0f);
+        buffers.sampled.fill(0.0f);
+        for (size_t p = 0; p < MAX_SECTIONS; ++p) {
+            for (size_t c = 0; c < BATCH; ++c) {
+                float at = position * buffers.totalBeats[c];
+                float start = buffers.sectionStart[c];
+                float end = start + buffers.beats[p * BATCH + c];
+                // Exactly one section covers the point, so a select-free sum works
+                float inside = static_cast<float>((at >= start) & (at < end));
+                buffers.sampled[c] += inside * buffers.energy[p * BATCH + c];
+                buffers.sectionStart[c] = end;
+            }
+        }
+        for (size_t c = 0; c < BATCH; ++c) {
+            float difference = buffers.sampled[c] - target;
+            buffers.energyError[c] += difference * difference;
+        }
+    }
+
+    const float inversePoints = points > 0 ? 1.0f / static_cast<float>(points) : 0.0f;
+    for (size_t c = 0; c < BATCH; ++c) {
+        buffers.energyError[c] = std::sqrt(buffers.energyError[c] * inversePoints);
+    }
+}
+
+// Best `keep` candidates of a run of batches
+std::vector<Candidate> searchBatches(const SearchTables& tables, uint32_t seed, uint64_t firstBatch, uint64_t batches,
+                                     uint64_t candidates, size_t keep) {
+    auto buffers = std::make_unique<BatchBuffers>();
+    TopK best(keep);
+
+    for (uint64_t batch = firstBatch; batch < firstBatch + batches; ++batch) {
+        const uint64_t firstIndex = batch * BATCH;
+        const size_t count = static_cast<size_t>(std::min<uint64_t>(BATCH, candidates - firstIndex));
+
+        Random rng(seed, batch);
+        propose(tables, rng, count, *buffers);
+        score(tables, *buffers);
+
+        for (size_t c = 0; c < count; ++c) {
+            float seconds = buffers->totalBeats[c] * tables.secondsPerBeat;
+            float durationError = std::abs(seconds - tables.targetSeconds) / tables.targetSeconds;
+            Candidate candidate;
+            candidate.cost = tables.durationWeight * durationError + tables.energyWeight * buffers->energyError[c] +
+                             tables.transitionWeight * buffers->transitionCost[c];
+            candidate.index = firstIndex + c;
+            if (!best.admits(candidate)) continue;
+
+            candidate.seconds = seconds;
+            candidate.energyError = buffers->energyError[c];
+            candidate.arrangement = buffers->packed[c];
+            best.add(candidate);
+        }
+    }
+    return best.take();
+}
+
+std::vector<Section> unpack(const PackedArrangement& packed, int beatsPerBar) {
+    std::vector<Section> sections;
+    sections.reserve(packed.count);
+    for (size_t p = 0; p < packed.count; ++p) {
+        auto type = static_cast<SectionType>(packed.codes[p] >> 2);
+        sections.push_back({type, sectionTypeToString(type), barsForCode(packed.codes[p] & 3), beatsPerBar});
+    }
+    return numberVariations(std::move(sections));
+}
+
+} // namespace
+
+Result<std::vector<ScoredArrangement>> ArrangementSearch::search(const ArrangementBrief& brief, uint64_t candidates,
+                                                                 size_t topK, uint32_t seed) const {
+    if (candidates == 0 || topK == 0 || brief.tempo <= 0 || brief.targetSeconds <= 0.0f || brief.rules.beatsPerBar <= 0 ||
+        brief.minSections == 0 || brief.minSections > brief.maxSections || brief.maxSections > MAX_SECTIONS) {
+        return std::unexpected(ErrorCode::InvalidParameter);
+    }
+
+    const SearchTables tables(brief);
+    const uint64_t batches = (candidates + BATCH - 1) / BATCH;
+    const uint64_t tasks = (batches + BATCHES_PER_TASK - 1) / BATCHES_PER_TASK;
+
+    std::vector<std::vector<Candidate>> results(tasks);
+    auto runTask = [&](uint64_t task) {
+        uint64_t first = task * BATCHES_PER_TASK;
+        results[task] = searchBatches(tables, seed, first, std::min<uint64_t>(BATCHES_PER_TASK, batches - first),
+                                      candidates, topK);
+    };
+
+    if (m_threadPool) {
+        std::vector<std::future<void>> pending;
+        pending.reserve(tasks);
+        for (uint64_t task = 0; task < tasks; ++task) {
+            pending.push_back(m_threadPool->submit([&runTask, task] { runTask(task); }));
+        }
+
+        // Let every task finish before rethrowing, since they write into `results`
+        for (auto& result : pending) {
+            result.wait();
+        }
+        for (auto& result : pending) {
+            result.get();
+        }
+    } else {
+        for (uint64_t task = 0; task < tasks; ++task) {
+            runTask(task);
+        }
+    }
+
+    // Every task kept its own top-K; the same arrangement may be in several
+    std::vector<Candidate> merged;
+    for (auto& taskResult : results) {
+        merged.insert(merged.end(), taskResult.begin(), taskResult.end());
+    }
+    std::ranges::sort(merged, Better{});
+    std::vector<Candidate> distinct;
+    for (const auto& candidate : merged) {
+        if (distinct.size() == topK) break;
+        if (std::ranges::none_of(distinct, [&](const Candidate& kept) { return sameArrangement(kept.arrangement, candidate.arrangement); })) {
+            distinct.push_back(candidate);
+        }
+    }
+
+    std::vector<ScoredArrangement> best;
+    best.reserve(distinct.size());
+    for (const auto& candidate : distinct) {
+        best.push_back({unpack(candidate.arrangement, brief.rules.beatsPerBar), candidate.cost, candidate.seconds,
+                        candidate.energyError, candidate.index});
+    }
+    return best;
+}
+
+} // namespace IndustrialMusic
\ No newline at end of file
@@ -69,27 +69,22 @@ void AudioEngine::updateDistortion(int distortion) {
 }
 
 float AudioEngine::getSectionProgress() const {
-    std::lock_guard<std::mutex> lock(m_sectionMutex);
-    if (m_sections.empty() || m_currentSection >= m_sections.size()) {
+    auto song = m_song.load();
+    size_t index = static_cast<size_t>(m_currentSection.load());
+    if (!song || index >= song->sections.size()) {
         return 0.0f;
     }
     
-    const auto& section = m_sections[m_currentSection];
-    float sectionBeats = static_cast<float>(section.totalBeats());
-    float beatInSection = std::fmod(m_currentBeat.load(), sectionBeats);
-    return beatInSection / sectionBeats;
+    float sectionBeats = static_cast<float>(song->sections[index].section.totalBeats());
+    if (sectionBeats <= 0.0f) return 0.0f;
+    float beatInSection = m_currentBeat.load() - static_cast<float>(song->sectionStartBeat(index));
+    return std::clamp(beatInSection / sectionBeats, 0.0f, 1.0f);
 }
 
 float AudioEngine::getTotalProgress() const {
-    if (m_sections.empty()) return 0.0f;
-    
-    int totalBeats = 0;
-    for (const auto& section : m_sections) {
-        totalBeats += section.totalBeats();
-    }
-    
-    if (totalBeats == 0) return 0.0f;
-    return m_currentBeat.load() / static_cast<float>(totalBeats);
+    auto song = m_song.load();
+    if (!song || song->totalBeats() == 0) return 0.0f;
+    return m_currentBeat.load() / static_cast<float>(song->totalBeats());
 }
 
 std::span<const float> AudioEngine::getFrequencyData() const {
@@ -101,9 +96,8 @@ float AudioEngine::getAverageVolume() const {
     return m_averageVolume.load();
 }
 
-void AudioEngine::setSongSections(const std::vector<Section>& sections) {
-    std::lock_guard<std::mutex> lock(m_sectionMutex);
-    m_sections = sections;
+std::shared_ptr<const SongSnapshot> AudioEngine::publishSong(SongSections sections, uint64_t firstSection, int64_t firstBeat) {
+    return m_song.publish(std::move(sections), firstSection, firstBeat);
 }
 
 void AudioEngine::audioThreadFunc() {
@@ -130,33 +124,63 @@ void AudioEngine::processAudioFrame() {
     float beatsPerSecond = m_currentTempo.load() / 60.0f;
     m_currentBeat = elapsed * beatsPerSecond;
     
-    // Update section
-    std::lock_guard<std::mutex> lock(m_sectionMutex);
-    if (!m_sections.empty()) {
-        int beatCount = 0;
-        for (size_t i = 0; i < m_sections.size(); ++i) {
-            int sectionBeats = m_sections[i].totalBeats();
-            if (m_currentBeat < beatCount + sectionBeats) {
-                m_currentSection = static_cast<int>(i);
-                break;
-            }
-            beatCount += sectionBeats;
+    // Update section from the current snapshot; the UI may publish a new
+    // one at any time without waiting for this frame
+    auto song = m_song.load();
+    
+    // A window further into an endless song starts later; move the origin
+    // with it so the position stays small and playback does not jump
+    if (song && song->firstBeat != m_songFirstBeat) {
+        if (song->firstBeat > m_songFirstBeat) {
+            float shift = static_cast<float>(song->firstBeat - m_songFirstBeat);
+            m_currentBeat = std::max(m_currentBeat.load() - shift, 0.0f);
+            m_startTime += std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<float>(shift / beatsPerSecond));
         }
-        
+        m_songFirstBeat = song->firstBeat;
+    }
+    
+    if (song && !song->sections.empty()) {
         // Loop if needed
-        if (m_isLooping && m_currentBeat >= beatCount) {
-            m_currentBeat = std::fmod(m_currentBeat.load(), static_cast<float>(beatCount));
-            m_startTime = std::chrono::steady_clock::now();
+        int totalBeats = song->totalBeats();
+        if (m_isLooping && totalBeats > 0 && m_currentBeat >= totalBeats) {
+            m_currentBeat = std::fmod(m_currentBeat.load(), static_cast<float>(totalBeats));
+            m_startTime = now - std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<float>(m_currentBeat.load() / beatsPerSecond));
+        }
+        
+        size_t index = song->sectionAt(m_currentBeat.load());
+        if (index < song->sections.size()) {
+            m_currentSection = static_cast<int>(index);
+            m_playingSectionNumber = song->firstSection + index;
         }
     }
     
+    // Visualization follows the notes actually playing: the current
+    // section's, and those held over from the one before it
+    float activity = 1.0f;
+    if (song && !song->sections.empty()) {
+        auto [index, start] = song->sections.find(static_cast<int64_t>(m_currentBeat.load()));
+        float sounding = 0.0f;
+        if (index < song->sections.size()) {
+            auto tick = static_cast<uint32_t>((m_currentBeat.load() - static_cast<float>(start)) * PatternEngine::TICKS_PER_QUARTER);
+            sounding = noteActivity(song->sections[index], tick);
+            if (index > 0) {
+                const SongSection& previous = song->sections[index - 1];
+                auto previousTicks = static_cast<uint32_t>(previous.section.totalBeats()) * PatternEngine::TICKS_PER_QUARTER;
+                sounding = std::max(sounding, noteActivity(previous, previousTicks + tick));
+            }
+        }
+        activity = 0.25f + 0.75f * sounding;
+    }
+    
     // Generate some fake frequency data for visualization
     std::lock_guard<std::mutex> audioLock(m_audioDataMutex);
     for (size_t i = 0; i < m_frequencyData.size(); ++i) {
         float freq = i / static_cast<float>(m_frequencyData.size());
         float value = std::sin(m_currentBeat * freq * 10.0f) * 0.5f + 0.5f;
         value *= (1.0f - freq * 0.8f); // Decrease amplitude for higher frequencies
-        value *= m_currentIntensity.load() / 10.0f;
+        value *= m_currentIntensity.load() / 10.0f * activity;
         m_frequencyData[i] = value;
     }
     
@@ -168,54 +192,24 @@ void AudioEngine::processAudioFrame() {
     m_averageVolume = sum / m_frequencyData.size();
 }
 
-AudioEngine::DrumPattern AudioEngine::getDrumPattern(const Section& section, int beat, int intensity, float random) const {
-    DrumPattern pattern;
-    
-    // Basic 4/4 pattern with variations based on section
-    bool isBeat = (beat % 4) == 0;
-    bool isOffBeat = (beat % 2) == 1;
+float AudioEngine::noteActivity(const SongSection& section, uint32_t tick) {
+    // Drum hits are short, so every note counts for at least a beat
+    const uint32_t minimumLength = PatternEngine::TICKS_PER_QUARTER;
+    const uint32_t lookback = PatternEngine::TICKS_PER_QUARTER * 16;
     
-    switch (section.type) {
-        case SectionType::Intro:
-            pattern.kick = isBeat && beat > 8;
-            pattern.hihat = true;
-            pattern.hihatVelocity = 0.5f;
-            break;
-            
-        case SectionType::Verse:
-            pattern.kick = isBeat;
-            pattern.snare = (beat % 8) == 4;
-            pattern.hihat = true;
-            break;
-            
-        case SectionType::Chorus:
-            pattern.kick = isBeat || (intensity > 7 && isOffBeat);
-            pattern.snare = (beat % 4) == 2;
-            pattern.hihat = true;
-            pattern.kickVelocity = 1.0f;
-            break;
-            
-        case SectionType::Breakdown:
-            pattern.kick = (beat % 8) == 0;
-            pattern.snare = random > 0.7f;
-            pattern.hihat = random > 0.5f;
-            pattern.snareVelocity = random;
-            break;
-            
-        default:
-            pattern.kick = isBeat;
-            pattern.snare = (beat % 4) == 2;
-            pattern.hihat = true;
-            break;
+    float activity = 0.0f;
+    for (const auto& notes : section.notes) {
+        if (!notes) continue;
+        const NoteStream& part = *notes;
+        // Notes are in start order; only recent starts can still be sounding
+        size_t end = std::ranges::upper_bound(part.ticks, tick) - part.ticks.begin();
+        for (size_t i = end; i-- > 0 && tick - part.ticks[i] < lookback;) {
+            if (tick < part.ticks[i] + std::max(part.durations[i], minimumLength)) {
+                activity = std::max(activity, part.velocities[i] / 127.0f);
+            }
+        }
     }
-    
-    // Intensity affects velocity
-    float intensityFactor = intensity / 10.0f;
-    pattern.kickVelocity *= intensityFactor;
-    pattern.snareVelocity *= intensityFactor;
-    pattern.hihatVelocity *= intensityFactor * 0.7f;
-    
-    return pattern;
+    return activity;
 }
 
 float AudioEngine::seededRandom(uint32_t seed) const {
@@ -0,0 +1,28 @@
+#include "BinaryRecords.h"
+#include <fstream>
+
+namespace IndustrialMusic {
+
+Result<void> writeFileAtomically(const std::filesystem::path& filepath, std::span<const uint8_t> bytes) {
+    std::error_code error;
+    auto tempPath = filepath;
+    tempPath += ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        file.close();
+        if (!file) {
+            std::filesystem::remove(tempPath, error);
+            return std::unexpected(ErrorCode::FileWriteFailed);
+        }
+    }
+
+    std::filesystem::rename(tempPath, filepath, error);
+    if (error) {
+        std::filesystem::remove(tempPath, error);
+        return std::unexpected(ErrorCode::FileWriteFailed);
+    }
+    return {};
+}
+
+} // namespace IndustrialMusic
\ No newline at end of file
@@ -0,0 +1,150 @@
+#include "ChannelVocoder.h"
+#include <cmath>
+#include <numbers>
+
+namespace IndustrialMusic {
+
+namespace {
+
+// Added to the modulator and to band levels so filters and envelopes
+// settle on tiny normal values in silence instead of decaying into
+// denormals, which are many times slower to compute with
+constexpr float DENORMAL_GUARD = 1e-18f;
+
+float followerCoefficient(float seconds, float sampleRate) {
+    return 1.0f - std::exp(-1.0f / (std::max(seconds, 1e-5f) * sampleRate));
+}
+
+} // namespace
+
+void ChannelVocoder::setSettings(const VocoderSettings& settings) {
+    m_settings = settings;
+    m_sampleRate = 0.0f;
+}
+
+size_t ChannelVocoder::getBandCount() const {
+    size_t bands = std::clamp(m_settings.bands, MIN_BANDS, MAX_BANDS);
+    return (bands + LANES - 1) / LANES * LANES;
+}
+
+void ChannelVocoder::reset() {
+    m_analysisZ1 = {};
+    m_analysisZ2 = {};
+    m_synthesisZ1 = {};
+    m_synthesisZ2 = {};
+    m_envelope = {};
+    m_phaseA = 0.0f;
+    m_phaseB = 0.5f;
+    m_subPhase = 0.0f;
+}
+
+void ChannelVocoder::updateCoefficients(float sampleRate) {
+    m_sampleRate = sampleRate;
+    m_bands = getBandCount();
+    m_attack = followerCoefficient(m_settings.attack, sampleRate);
+    m_release = followerCoefficient(m_settings.release, sampleRate);
+
+    // Log-spaced centres; each band is as wide as the step between them
+    const float low = std::max(m_settings.lowFrequency, 20.0f);
+    const float high = std::clamp(m_settings.highFrequency, low, sampleRate * 0.45f);
+    const float ratio = std::pow(high / low, 1.0f / static_cast<float>(m_bands - 1));
+    const float q = std::sqrt(ratio) / (ratio - 1.0f);
+    for (size_t band = 0; band < MAX_BANDS; ++band) {
+        if (band >= m_bands) {
+            m_b0.values[band] = m_b2.values[band] = m_a1.values[band] = m_a2.values[band] = 0.0f;
+            continue;
+        }
+        float centre = low * std::pow(ratio, static_cast<float>(band));
+        float omega = 2.0f * std::numbers::pi_v<float> * centre / sampleRate;
+        float alpha = std::sin(omega) / (2.0f * q);
+        float a0 = 1.0f + alpha;
+        m_b0.values[band] = alpha / a0;
+        m_b2.values[band] = -alpha / a0;
+        m_a1.values[band] = -2.0f * std::cos(omega) / a0;
+        m_a2.values[band] = (1.0f - alpha) / a0;
+    }
+}
+
+void ChannelVocoder::process(std::span<float> buffer, float sampleRate) {
+    if (sampleRate <= 0.0f) {
+        return;
+    }
+    if (sampleRate != m_sampleRate) {
+        updateCoefficients(sampleRate);
+    }
+
+    const size_t bands = m_bands;
+    const float attack = m_attack;
+    const float release = m_release;
+    // More, narrower bands each pass less; keep the level the same
+    const float gain = m_settings.gain * std::sqrt(static_cast<float>(bands) / static_cast<float>(MIN_BANDS));
+    const float noiseLevel = m_settings.noise;
+    const float baseStep = m_settings.carrierPitch / sampleRate;
+    const float stepA = baseStep * 1.007f;
+    const float stepB = baseStep * 0.993f;
+    const float subStep = baseStep * 0.5f;
+
+    // Locals, so the compiler knows the banks do not alias the buffer
+    const Bands b0 = m_b0, b2 = m_b2, a1 = m_a1, a2 = m_a2;
+    Bands analysisZ1 = m_analysisZ1, analysisZ2 = m_analysisZ2;
+    Bands synthesisZ1 = m_synthesisZ1, synthesisZ2 = m_synthesisZ2;
+    Bands envelope = m_envelope;
+
+    for (float& sample : buffer) {
+        m_noise ^= m_noise << 13;
+        m_noise ^= m_noise >> 17;
+        m_noise ^= m_noise << 5;
+        float noise = static_cast<int32_t>(m_noise) * (1.0f / 2147483648.0f);
+        float carrier = (2.0f * m_phaseA - 1.0f) + (2.0f * m_phaseB - 1.0f) + (m_subPhase < 0.5f ? 0.5f : -0.5f) +
+                        noiseLevel * noise;
+        m_phaseA += stepA;
+        m_phaseA -= std::floor(m_phaseA);
+        m_phaseB += stepB;
+        m_phaseB -= std::floor(m_phaseB);
+        m_subPhase += subStep;
+        m_subPhase -= std::floor(m_subPhase);
+
+        const float modulator = sample + DENORMAL_GUARD;
+        Bands mixed;
+        // A group of LANES bands at a time; the fixed inner count lets the
+        // compiler turn each group into single vector operations
+        for (size_t group = 0; group < bands; group += LANES) {
+            for (size_t band = group; band < group + LANES; ++band) {
+                // Analysis: follow the modulator's level in this band
+                float y = b0.values[band] * modulator + analysisZ1.values[band];
+                analysisZ1.values[band] = analysisZ2.values[band] - a1.values[band] * y;
+                analysisZ2.values[band] = b2.values[band] * modulator - a2.values[band] * y;
+                float level = std::abs(y) + DENORMAL_GUARD;
+                float rate = level > envelope.values[band] ? attack : release;
+                envelope.values[band] += (level - envelope.values[band]) * rate;
+
+                // Synthesis: the same band of the carrier at that level
+                float c = b0.values[band] * carrier + synthesisZ1.values[band];
+                synthesisZ1.values[band] = synthesisZ2.values[band] - a1.values[band] * c;
+                synthesisZ2.values[band] = b2.values[band] * carrier - a2.values[band] * c;
+                mixed.values[band] = c * envelope.values[band];
+            }
+        }
+
+        // Sum lane-wise first so the additions vectorize too
+        std::array<float, LANES> partial{};
+        for (size_t group = 0; group < bands; group += LANES) {
+            for (size_t lane = 0; lane < LANES; ++lane) {
+                partial[lane] += mixed.values[group + lane];
+            }
+        }
+        float sum = 0.0f;
+        for (float value : partial) {
+            sum += value;
+        }
+        sample = sum * gain;
+    }
+
+    m_analysisZ1 = analysisZ1;
+    m_analysisZ2 = analysisZ2;
+    m_synthesisZ1 = synthesisZ1;
+    m_synthesisZ2 = synthesisZ2;
+    m_envelope = envelope;
+}
+
+} // namespace IndustrialMusic
\ No newline at end of file
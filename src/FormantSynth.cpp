@@ -0,0 +1,336 @@
+#include "FormantSynth.h"
+#include <cmath>
+#include <numbers>
+
+namespace IndustrialMusic {
+
+namespace {
+
+// Formants (Hz) at the start and end of a phoneme (they differ for
+// diphthongs), how it is excited, and its length at normal speed
+struct PhonemeSound {
+    std::array<float, 3> start;
+    std::array<float, 3> end;
+    float voicing;       // Glottal source level
+    float aspiration;    // Breath noise through the formants
+    float frication;     // Noise through the high resonances
+    float fricationFreq; // Centre of the high resonances
+    float seconds;
+    bool plosive;        // Silent closure, then a burst
+    bool nasal;          // Formants above F1 damped
+};
+
+constexpr PhonemeSound vowel(float f1, float f2, float f3, float seconds) {
+    return {{f1, f2, f3}, {f1, f2, f3}, 1.0f, 0.0f, 0.0f, 0.0f, seconds, false, false};
+}
+
+constexpr PhonemeSound glide(std::array<float, 3> start, std::array<float, 3> end) {
+    return {start, end, 1.0f, 0.0f, 0.0f, 0.0f, 0.2f, false, false};
+}
+
+constexpr PhonemeSound sonorant(float f1, float f2, float f3, float voicing, bool nasal) {
+    return {{f1, f2, f3}, {f1, f2, f3}, voicing, 0.0f, 0.0f, 0.0f, 0.07f, false, nasal};
+}
+
+constexpr PhonemeSound fricative(float f1, float f2, float f3, float voicing, float frication, float centre) {
+    return {{f1, f2, f3}, {f1, f2, f3}, voicing, 0.0f, frication, centre, 0.1f, false, false};
+}
+
+constexpr PhonemeSound plosive(float f1, float f2, float f3, float voicing, float burst, float centre, float seconds = 0.08f) {
+    return {{f1, f2, f3}, {f1, f2, f3}, voicing, 0.0f, burst, centre, seconds, true, false};
+}
+
+constexpr std::array<float, 3> AA_FORMANTS = {730.0f, 1090.0f, 2440.0f};
+constexpr std::array<float, 3> AO_FORMANTS = {570.0f, 840.0f, 2410.0f};
+constexpr std::array<float, 3> EH_FORMANTS = {530.0f, 1840.0f, 2480.0f};
+constexpr std::array<float, 3> IY_END = {300.0f, 2200.0f, 2950.0f};
+constexpr std::array<float, 3> UW_END = {320.0f, 870.0f, 2240.0f};
+
+// Indexed by Phoneme; adult male formants after Peterson and Barney
+constexpr std::array<PhonemeSound, PHONEME_COUNT> PHONEME_SOUNDS = {{
+    {{640.0f, 1190.0f, 2390.0f}, {640.0f, 1190.0f, 2390.0f}, 0.0f, 0.0f, 0.0f, 0.0f, 0.12f, false, false}, // Pause
+    vowel(730.0f, 1090.0f, 2440.0f, 0.13f),  // AA
+    vowel(660.0f, 1720.0f, 2410.0f, 0.13f),  // AE
+    vowel(640.0f, 1190.0f, 2390.0f, 0.09f),  // AH
+    vowel(570.0f, 840.0f, 2410.0f, 0.13f),   // AO
+    vowel(530.0f, 1840.0f, 2480.0f, 0.11f),  // EH
+    vowel(490.0f, 1350.0f, 1690.0f, 0.13f),  // ER
+    vowel(390.0f, 1990.0f, 2550.0f, 0.09f),  // IH
+    vowel(270.0f, 2290.0f, 3010.0f, 0.13f),  // IY
+    vowel(440.0f, 1020.0f, 2240.0f, 0.09f),  // UH
+    vowel(300.0f, 870.0f, 2240.0f, 0.13f),   // UW
+    glide(AA_FORMANTS, IY_END),              // AY
+    glide(AA_FORMANTS, UW_END),              // AW
+    glide(EH_FORMANTS, IY_END),              // EY
+    glide(AO_FORMANTS, UW_END),              // OW
+    glide(AO_FORMANTS, IY_END),              // OY
+    sonorant(480.0f, 1270.0f, 2130.0f, 0.6f, true),  // M
+    sonorant(480.0f, 1340.0f, 2470.0f, 0.6f, true),  // N
+    sonorant(480.0f, 2000.0f, 2900.0f, 0.6f, true),  // NG
+    sonorant(360.0f, 1300.0f, 3000.0f, 0.8f, false), // L
+    sonorant(330.0f, 1060.0f, 1380.0f, 0.8f, false), // R
+    sonorant(290.0f, 610.0f, 2150.0f, 0.8f, false),  // W
+    sonorant(260.0f, 2070.0f, 3020.0f, 0.8f, false), // Y
+    {{640.0f, 1190.0f, 2390.0f}, {640.0f, 1190.0f, 2390.0f}, 0.0f, 0.8f, 0.0f, 0.0f, 0.06f, false, false}, // HH
+    fricative(340.0f, 1100.0f, 2080.0f, 0.0f, 0.3f, 7000.0f),  // F
+    fricative(340.0f, 1100.0f, 2080.0f, 0.5f, 0.2f, 7000.0f),  // V
+    fricative(320.0f, 1290.0f, 2540.0f, 0.0f, 0.25f, 6500.0f), // TH
+    fricative(320.0f, 1290.0f, 2540.0f, 0.5f, 0.15f, 6500.0f), // DH
+    fricative(320.0f, 1390.0f, 2530.0f, 0.0f, 1.0f, 6000.0f),  // S
+    fricative(320.0f, 1390.0f, 2530.0f, 0.5f, 0.7f, 6000.0f),  // Z
+    fricative(300.0f, 1840.0f, 2750.0f, 0.0f, 0.9f, 2800.0f),  // SH
+    fricative(300.0f, 1840.0f, 2750.0f, 0.5f, 0.6f, 2800.0f),  // ZH
+    plosive(400.0f, 1100.0f, 2150.0f, 0.0f, 0.5f, 1500.0f),    // P
+    plosive(400.0f, 1100.0f, 2150.0f, 0.4f, 0.3f, 1500.0f),    // B
+    plosive(400.0f, 1600.0f, 2600.0f, 0.0f, 0.7f, 4500.0f),    // T
+    plosive(400.0f, 1600.0f, 2600.0f, 0.4f, 0.4f, 4500.0f),    // D
+    plosive(300.0f, 1990.0f, 2850.0f, 0.0f, 0.6f, 2500.0f),    // K
+    plosive(300.0f, 1990.0f, 2850.0f, 0.4f, 0.4f, 2500.0f),    // G
+    plosive(300.0f, 1840.0f, 2750.0f, 0.0f, 0.9f, 2800.0f, 0.12f), // CH
+    plosive(300.0f, 1840.0f, 2750.0f, 0.4f, 0.6f, 2800.0f, 0.12f), // JH
+}};
+
+// F4 and F5 barely move between phonemes
+constexpr float F4 = 3300.0f;
+constexpr float F5 = 3750.0f;
+
+// Lanes 0-4 are F1-F5, 5-7 the frication resonances
+constexpr std::array<float, FormantSynth::RESONATORS> BANDWIDTHS = {80.0f, 100.0f, 150.0f, 250.0f, 300.0f, 0.0f, 0.0f, 0.0f};
+// Alternating signs keep parallel formants from cancelling between peaks
+constexpr std::array<float, FormantSynth::RESONATORS> VOICE_GAINS = {1.0f, -0.6f, 0.3f, -0.12f, 0.06f, 0.0f, 0.0f, 0.0f};
+constexpr std::array<float, FormantSynth::RESONATORS> ASPIRATION_GAINS = {0.3f, -0.5f, 0.5f, -0.3f, 0.2f, 0.0f, 0.0f, 0.0f};
+constexpr std::array<float, 3> FRICATION_SPREAD = {1.0f, 1.3f, 0.75f};
+constexpr std::array<float, 3> FRICATION_GAINS = {0.5f, -0.25f, 0.2f};
+constexpr float FRICATION_BANDWIDTH = 0.25f; // Fraction of the centre frequency
+constexpr float NASAL_DAMPING = 0.25f;
+
+// Glides between phonemes and level changes, in seconds
+constexpr float FORMANT_GLIDE = 0.012f;
+constexpr float LEVEL_GLIDE = 0.006f;
+constexpr float RELEASE_SECONDS = 0.04f;
+// Plosives are silent for this part of their length, then burst
+constexpr float CLOSURE = 0.5f;
+// Pitch falls by this much across a line
+constexpr float DECLINATION = 0.1f;
+
+float baseSeconds(const PhonemeEvent& event) {
+    float seconds = PHONEME_SOUNDS[static_cast<size_t>(event.phoneme)].seconds;
+    if (isVowel(event.phoneme)) {
+        seconds *= event.stressed ? 1.3f : 0.8f;
+    }
+    return seconds;
+}
+
+float smoothing(float seconds, float timeConstant) {
+    return 1.0f - std::exp(-seconds / timeConstant);
+}
+
+} // namespace
+
+float FormantSynth::naturalSeconds(const PhonemeLine& line) {
+    float seconds = 0.0f;
+    for (const auto& event : line) {
+        seconds += baseSeconds(event);
+    }
+    return seconds;
+}
+
+void FormantSynth::start(std::shared_ptr<const PhonemeLine> line, const VoiceSettings& settings, float maxSeconds) {
+    if (!line || line->empty()) {
+        m_line.reset();
+        return;
+    }
+
+    bool legato = isActive();
+    m_line = std::move(line);
+    m_settings = settings;
+    m_speed = std::max(settings.rate, 0.1f);
+    if (maxSeconds > 0.0f) {
+        m_speed *= std::clamp(naturalSeconds(*m_line) / (maxSeconds * m_speed), 1.0f, 2.0f);
+    }
+    m_index = 0;
+    m_elapsed = 0.0f;
+    m_duration = phonemeSeconds(m_line->front());
+    m_release = RELEASE_SECONDS;
+
+    if (!legato) {
+        // Start on the first phoneme's formants rather than gliding in from silence
+        const PhonemeSound& sound = PHONEME_SOUNDS[static_cast<size_t>(m_line->front().phoneme)];
+        for (size_t lane = 0; lane < 3; ++lane) {
+            m_frequency[lane] = sound.start[lane];
+        }
+        m_frequency[3] = F4;
+        m_frequency[4] = F5;
+        for (size_t lane = 0; lane < 3; ++lane) {
+            m_frequency[5 + lane] = std::max(sound.fricationFreq, 1000.0f) * FRICATION_SPREAD[lane];
+        }
+        m_y1 = {};
+        m_y2 = {};
+        m_pitch = settings.pitch;
+        m_periodPitch = settings.pitch;
+    }
+}
+
+float FormantSynth::phonemeSeconds(const PhonemeEvent& event) const {
+    return baseSeconds(event) / m_speed;
+}
+
+float FormantSynth::noise() {
+    m_noise ^= m_noise << 13;
+    m_noise ^= m_noise >> 17;
+    m_noise ^= m_noise << 5;
+    return static_cast<int32_t>(m_noise) * (1.0f / 2147483648.0f);
+}
+
+void FormantSynth::updateControls(float sampleRate, float seconds) {
+    const PhonemeLine& line = *m_line;
+
+    // Move on through the line
+    m_elapsed += seconds;
+    while (m_index < line.size() && m_elapsed >= m_duration) {
+        m_elapsed -= m_duration;
+        ++m_index;
+        if (m_index < line.size()) {
+            m_duration = phonemeSeconds(line[m_index]);
+        }
+    }
+
+    // Targets for this block; after the last phoneme everything fades
+    bool finished = m_index >= line.size();
+    const PhonemeEvent& event = line[std::min(m_index, line.size() - 1)];
+    const PhonemeSound& sound = PHONEME_SOUNDS[static_cast<size_t>(event.phoneme)];
+    float progress = finished ? 1.0f : std::clamp(m_elapsed / m_duration, 0.0f, 1.0f);
+
+    float voice = sound.voicing;
+    float aspiration = sound.aspiration + m_settings.aspiration * sound.voicing;
+    float frication = sound.frication;
+    if (sound.plosive) {
+        // Voice bar during the closure, then a decaying burst
+        bool closed = progress < CLOSURE;
+        voice *= closed ? 0.3f : 1.0f;
+        frication *= closed ? 0.0f : std::exp(-8.0f * (progress - CLOSURE));
+    }
+    // Whispering moves the voicing into breath noise
+    aspiration += voice * (1.0f - m_settings.voicing);
+    voice *= m_settings.voicing;
+    if (finished) {
+        m_release -= seconds;
+        voice = aspiration = frication = 0.0f;
+    }
+
+    std::array<float, RESONATORS> target{};
+    for (size_t lane = 0; lane < 3; ++lane) {
+        target[lane] = sound.start[lane] + (sound.end[lane] - sound.start[lane]) * progress;
+    }
+    target[3] = F4;
+    target[4] = F5;
+    for (size_t lane = 0; lane < 3; ++lane) {
+        target[5 + lane] = std::max(sound.fricationFreq, 1000.0f) * FRICATION_SPREAD[lane];
+    }
+
+    float glide = smoothing(seconds, FORMANT_GLIDE);
+    float level = smoothing(seconds, LEVEL_GLIDE);
+    for (size_t lane = 0; lane < RESONATORS; ++lane) {
+        m_frequency[lane] += (target[lane] - m_frequency[lane]) * glide;
+    }
+    m_voiceLevel += (voice - m_voiceLevel) * level;
+    m_noiseLevel += (aspiration - m_noiseLevel) * level;
+    m_fricationLevel += (frication - m_fricationLevel) * level;
+
+    float lineProgress = static_cast<float>(m_index) / static_cast<float>(line.size());
+    float pitch = m_settings.pitch * (1.0f - DECLINATION * lineProgress);
+    if (event.stressed) {
+        pitch *= 1.0f + m_settings.stressPitch;
+    }
+    m_pitch += (pitch - m_pitch) * glide;
+
+    // Two-pole resonators normalized to unity gain at their peak
+    const float nyquist = sampleRate * 0.45f;
+    const float damping = sound.nasal ? NASAL_DAMPING : 1.0f;
+    for (size_t lane = 0; lane < RESONATORS; ++lane) {
+        float frequency = std::min(m_frequency[lane], nyquist);
+        float bandwidth = lane < 5 ? BANDWIDTHS[lane] : frequency * FRICATION_BANDWIDTH;
+        float r = std::exp(-std::numbers::pi_v<float> * bandwidth / sampleRate);
+        float theta = 2.0f * std::numbers::pi_v<float> * frequency / sampleRate;
+        m_b.values[lane] = 2.0f * r * std::cos(theta);
+        m_c.values[lane] = -r * r;
+        m_a.values[lane] = (1.0f - r) * std::sqrt(1.0f - 2.0f * r * std::cos(2.0f * theta) + r * r);
+
+        if (lane < 5) {
+            float laneDamping = lane == 0 ? 1.0f : damping;
+            m_voiceGain.values[lane] = VOICE_GAINS[lane] * m_voiceLevel * laneDamping;
+            m_noiseGain.values[lane] = ASPIRATION_GAINS[lane] * m_noiseLevel * laneDamping;
+        } else {
+            m_voiceGain.values[lane] = 0.0f;
+            m_noiseGain.values[lane] = FRICATION_GAINS[lane - 5] * m_fricationLevel;
+        }
+    }
+}
+
+bool FormantSynth::render(std::span<float> out, float sampleRate) {
+    if (!m_line || sampleRate <= 0.0f) {
+        return false;
+    }
+
+    const float openQuotient = std::clamp(m_settings.openQuotient, 0.1f, 0.95f);
+    const float gain = m_settings.gain;
+    for (size_t begin = 0; begin < out.size() && m_release > 0.0f; begin += CONTROL_SAMPLES) {
+        size_t end = std::min(begin + CONTROL_SAMPLES, out.size());
+        updateControls(sampleRate, static_cast<float>(end - begin) / sampleRate);
+
+        // The block's excitation first, so the period and jitter branches
+        // stay out of the resonator loop below
+        const size_t count = end - begin;
+        std::array<float, CONTROL_SAMPLES> glottal;
+        std::array<float, CONTROL_SAMPLES> breath;
+        for (size_t i = 0; i < count; ++i) {
+            // Differentiated polynomial glottal pulse, scaled so its size
+            // does not depend on the pitch
+            m_phase += m_periodPitch / sampleRate;
+            if (m_phase >= 1.0f) {
+                m_phase -= 1.0f;
+                m_periodPitch = m_pitch * (1.0f + m_settings.jitter * noise());
+            }
+            float u = m_phase / openQuotient;
+            float flow = u < 1.0f ? 6.75f * u * u * (1.0f - u) : 0.0f;
+            glottal[i] = (flow - m_previousFlow) * (openQuotient * sampleRate / m_periodPitch) * 0.4f;
+            m_previousFlow = flow;
+            breath[i] = noise();
+        }
+
+        // Copies the compiler can keep in registers across the block
+        const Lanes a = m_a, b = m_b, c = m_c, voiceGain = m_voiceGain, noiseGain = m_noiseGain;
+        Lanes y1 = m_y1, y2 = m_y2;
+        for (size_t i = 0; i < count; ++i) {
+            // Every resonator at once: the same operations on each lane
+            Lanes y;
+            for (size_t lane = 0; lane < RESONATORS; ++lane) {
+                float x = voiceGain.values[lane] * glottal[i] + noiseGain.values[lane] * breath[i];
+                y.values[lane] = a.values[lane] * x + b.values[lane] * y1.values[lane] + c.values[lane] * y2.values[lane];
+                y2.values[lane] = y1.values[lane];
+                y1.values[lane] = y.values[lane];
+            }
+
+            // Fold the halves together lane-wise, then one horizontal add
+            std::array<float, RESONATORS / 2> partial;
+            for (size_t lane = 0; lane < RESONATORS / 2; ++lane) {
+                partial[lane] = y.values[lane] + y.values[lane + RESONATORS / 2];
+            }
+            float sum = 0.0f;
+            for (float value : partial) {
+                sum += value;
+            }
+            out[begin + i] += sum * gain;
+        }
+        m_y1 = y1;
+        m_y2 = y2;
+    }
+
+    if (m_release <= 0.0f) {
+        m_line.reset();
+        return false;
+    }
+    return true;
+}
+
+} // namespace IndustrialMusic
\ No newline at end of file
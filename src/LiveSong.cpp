@@ -0,0 +1,94 @@
+#include "LiveSong.h"
+#include "VocalSynthesizer.h"
+
+namespace IndustrialMusic {
+
+LiveSong::LiveSong(const PatternEngine& patterns, LyricsGenerator& lyrics, VocalSynthesizer& vocals)
+    : m_patterns(patterns), m_lyrics(lyrics), m_vocals(vocals) {}
+
+void LiveSong::rebuild(const SectionList& sections, const Settings& settings) {
+    m_settings = settings;
+    m_sections = {};
+    splice(0, 0, sections);
+}
+
+void LiveSong::splice(size_t index, size_t removed, const SectionList& inserted) {
+    std::vector<SongSection> built;
+    built.reserve(inserted.size());
+    inserted.forEach([&](const Section& section) { built.push_back(build(section)); });
+
+    m_sections = m_sections.erase(index, index + removed).insert(index, SongSections(built));
+}
+
+void LiveSong::rebuildLyrics(uint32_t lyricsSeed) {
+    m_settings.lyricsSeed = lyricsSeed;
+
+    std::vector<SongSection> rebuilt;
+    rebuilt.reserve(m_sections.size());
+    m_sections.forEach([&](const SongSection& entry) {
+        rebuilt.push_back(withLyrics(entry, m_lyrics.generateSection(entry.section, lyricsSeed)));
+    });
+    m_sections = SongSections(rebuilt);
+}
+
+void LiveSong::setLyrics(const std::vector<std::string>& lyrics) {
+    auto isHeader = [&](size_t line) { return lyrics[line].starts_with('['); };
+
+    // A section takes its header, if it has one, and every line up to the
+    // next header; lines before the first header go to the first section
+    std::vector<SongSection> rebuilt;
+    rebuilt.reserve(m_sections.size());
+    size_t next = 0;
+    int verseCount = 0;
+    m_sections.forEach([&](const SongSection& entry) {
+        if (LyricsGenerator::sectionHeader(entry.section, verseCount) && next < lyrics.size() && isHeader(next)) {
+            ++next;
+        }
+        SectionLyrics lines;
+        for (; next < lyrics.size() && !isHeader(next); ++next) {
+            lines.lines.push_back(lyrics[next]);
+        }
+        rebuilt.push_back(withLyrics(entry, std::make_shared<const SectionLyrics>(std::move(lines))));
+    });
+    m_sections = SongSections(rebuilt);
+}
+
+std::vector<std::string> LiveSong::getLyrics() const {
+    std::vector<std::string> lyrics;
+    int verseCount = 0;
+    m_sections.forEach([&](const SongSection& entry) {
+        if (auto header = LyricsGenerator::sectionHeader(entry.section, verseCount)) {
+            lyrics.push_back(std::move(*header));
+        }
+        if (entry.lyrics) {
+            lyrics.insert(lyrics.end(), entry.lyrics->lines.begin(), entry.lyrics->lines.end());
+        }
+    });
+    return lyrics;
+}
+
+SongSection LiveSong::build(const Section& section) const {
+    SongSection entry{section, {}, {}, {}};
+
+    // Seeded as PatternEngine::generateSong seeds them, so the notes match
+    // a song generated in one go
+    NoteStream buffer;
+    for (size_t part = 0; part < PATTERN_PART_COUNT; ++part) {
+        auto which = static_cast<PatternPart>(part);
+        uint32_t seed = sectionSeed(PatternEngine::partSeed(m_settings.seed, which), section);
+        std::shared_ptr<const NoteStream> cached;
+        const NoteStream& notes = m_patterns.sectionNotes(which, section, m_settings.intensity, seed, buffer, cached);
+        entry.notes[part] = cached ? std::move(cached) : std::make_shared<const NoteStream>(notes);
+    }
+
+    return withLyrics(entry, m_lyrics.generateSection(section, m_settings.lyricsSeed));
+}
+
+SongSection LiveSong::withLyrics(const SongSection& entry, std::shared_ptr<const SectionLyrics> lyrics) const {
+    SongSection updated = entry;
+    updated.vocals = m_vocals.compileVocals(entry.section, *lyrics);
+    updated.lyrics = std::move(lyrics);
+    return updated;
+}
+
+} // namespace IndustrialMusic
\ No newline at end of file
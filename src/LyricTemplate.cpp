@@ -0,0 +1,62 @@
+#include "LyricTemplate.h"
+
+namespace IndustrialMusic {
+
+namespace {
+
+constexpr std::array<std::pair<std::string_view, LyricSlot>, LYRIC_SLOT_COUNT> PLACEHOLDERS = {{
+    {"{adj}", LyricSlot::Adjective},
+    {"{noun}", LyricSlot::Noun},
+    {"{verb}", LyricSlot::Verb},
+    {"{theme}", LyricSlot::Theme},
+}};
+
+} // namespace
+
+LyricTemplate::LyricTemplate(std::string_view pattern) : m_text(pattern) {
+    size_t literalStart = 0;
+    auto flushLiteral = [&](size_t end) {
+        if (end > literalStart) {
+            // Letters straight after a slot continue its word ("{verb}ing")
+            bool attached = !m_tokens.empty() && m_tokens.back().slot != LITERAL;
+            auto text = std::string_view(m_text).substr(literalStart, end - literalStart);
+            m_tokens.push_back({static_cast<uint32_t>(literalStart), static_cast<uint32_t>(end - literalStart), LITERAL,
+                                analyzeText(text, attached)});
+            m_literalLength += end - literalStart;
+        }
+    };
+
+    size_t pos = 0;
+    while ((pos = m_text.find('{', pos)) != std::string::npos) {
+        std::string_view rest = std::string_view(m_text).substr(pos);
+        auto placeholder = std::ranges::find_if(PLACEHOLDERS, [&](const auto& entry) {
+            return rest.starts_with(entry.first);
+        });
+        if (placeholder == PLACEHOLDERS.end() || m_slots.size() == MAX_SLOTS) {
+            ++pos;
+            continue;
+        }
+
+        flushLiteral(pos);
+        m_tokens.push_back({0, 0, static_cast<uint8_t>(m_slots.size()), {}});
+        m_slots.push_back(placeholder->second);
+        pos += placeholder->first.size();
+        literalStart = pos;
+    }
+    flushLiteral(m_text.size());
+
+    auto rhyming = std::ranges::find_if(m_tokens.rbegin(), m_tokens.rend(), [](const Token& token) {
+        return token.slot != LITERAL || token.prosody.rhyme != 0;
+    });
+    m_fixedRhyme = rhyming != m_tokens.rend() && rhyming->slot == LITERAL;
+
+    for (size_t kind = 0; kind < LYRIC_SLOT_COUNT; ++kind) {
+        for (size_t slot = 0; slot < m_slots.size(); ++slot) {
+            if (static_cast<size_t>(m_slots[slot]) == kind) {
+                m_drawOrder.push_back(static_cast<uint8_t>(slot));
+            }
+        }
+    }
+}
+
+} // namespace IndustrialMusic
\ No newline at end of file
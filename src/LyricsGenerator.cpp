@@ -1,97 +1,260 @@
 #include "LyricsGenerator.h"
+#include "Hash.h"
+#include "NgramModel.h"
+#include "WordBankPack.h"
+#include <cctype>
 #include <fstream>
-#include <sstream>
 
 namespace IndustrialMusic {
 
-// Industrial-themed word banks
-const std::vector<std::string> LyricsGenerator::INDUSTRIAL_NOUNS = {
+namespace {
+
+// Industrial-themed word banks, with their prosody worked out at compile time
+constexpr std::array<std::string_view, 24> INDUSTRIAL_NOUNS = {
     "machine", "steel", "factory", "gear", "piston", "wire", "circuit", "motor",
     "concrete", "iron", "chrome", "rust", "smoke", "steam", "oil", "metal",
     "engine", "turbine", "hammer", "anvil", "chain", "bolt", "rivet", "forge"
 };
 
-const std::vector<std::string> LyricsGenerator::INDUSTRIAL_VERBS = {
+constexpr std::array<std::string_view, 24> INDUSTRIAL_VERBS = {
     "grind", "crush", "forge", "burn", "spark", "weld", "break", "shatter",
     "pound", "drill", "cut", "slice", "tear", "rip", "smash", "crash",
     "pulse", "throb", "vibrate", "resonate", "echo", "scream", "roar", "hiss"
 };
 
-const std::vector<std::string> LyricsGenerator::INDUSTRIAL_ADJECTIVES = {
+constexpr std::array<std::string_view, 21> INDUSTRIAL_ADJECTIVES = {
     "cold", "hard", "dark", "heavy", "sharp", "raw", "brutal", "relentless",
     "mechanical", "synthetic", "electric", "metallic", "industrial", "savage",
     "primal", "violent", "harsh", "bitter", "toxic", "corrosive", "explosive"
 };
 
-const std::vector<std::string> LyricsGenerator::THEMES = {
+constexpr std::array<std::string_view, 10> THEMES = {
     "dehumanization", "mechanization", "rebellion", "dystopia", "transformation",
     "destruction", "reconstruction", "isolation", "connection", "evolution"
 };
 
+constexpr auto NOUN_PROSODY = analyzeWords(INDUSTRIAL_NOUNS);
+constexpr auto VERB_PROSODY = analyzeWords(INDUSTRIAL_VERBS);
+constexpr auto ADJECTIVE_PROSODY = analyzeWords(INDUSTRIAL_ADJECTIVES);
+constexpr auto THEME_PROSODY = analyzeWords(THEMES);
+
+struct WordBank {
+    std::span<const std::string_view> words;
+    std::span<const WordProsody> prosody;
+};
+
+constexpr std::array<WordBank, LYRIC_SLOT_COUNT> WORD_BANKS = {{
+    {INDUSTRIAL_ADJECTIVES, ADJECTIVE_PROSODY},
+    {INDUSTRIAL_NOUNS, NOUN_PROSODY},
+    {INDUSTRIAL_VERBS, VERB_PROSODY},
+    {THEMES, THEME_PROSODY},
+}};
+
+// Longest word in any bank, for sizing lines
+constexpr size_t MAX_WORD_LENGTH = [] {
+    size_t longest = 0;
+    for (const auto& bank : WORD_BANKS) {
+        for (auto word : bank.words) {
+            longest = std::max(longest, word.size());
+        }
+    }
+    return longest;
+}();
+
+// Neighbouring seeds give visibly correlated minstd sequences, so hash them
+// first (splitmix64 finalizer)
+uint32_t scrambleSeed(uint32_t seed) {
+    return static_cast<uint32_t>(mix64(seed * GOLDEN_GAMMA));
+}
+
+// Compiled once at startup and rendered for every line
+const LyricTemplate INTRO_LINE{"The {adj} {noun} {verb}s in silence"};
+const std::array<LyricTemplate, 2> PRE_CHORUS_LINES = {
+    LyricTemplate{"We are the {adj} {noun}s"},
+    LyricTemplate{"{verb}ing through the {adj} night"}
+};
+const LyricTemplate OUTRO_LINE{"Until the {noun} {verb}s no more"};
+const LyricTemplate DEFAULT_LINE{"{adj} {noun} {verb}s"};
+const LyricTemplate BREAKDOWN_LINE{"{verb}! {verb}! {verb}!"};
+
+const std::array<LyricTemplate, 4> CHORUS_LINES = {
+    LyricTemplate{"{verb}! {verb}! The {adj} {noun}!"},
+    LyricTemplate{"We are {adj}, we are {noun}"},
+    LyricTemplate{"{verb} the {noun}, {verb} the system"},
+    LyricTemplate{"No more {noun}s, only {adj} {noun}s"}
+};
+
+const std::array<LyricTemplate, 4> VERSE_LINES = {
+    LyricTemplate{"In the {adj} {noun} of {noun}s"},
+    LyricTemplate{"Where {noun}s {verb} and {verb}"},
+    LyricTemplate{"The {adj} {noun} {verb}s forever"},
+    LyricTemplate{"And we become {adj} {noun}s"}
+};
+
+const std::array<LyricTemplate, 3> BRIDGE_LINES = {
+    LyricTemplate{"This is our {theme}"},
+    LyricTemplate{"Where {noun}s and {noun}s collide"},
+    LyricTemplate{"We {verb} against the {adj} machine"}
+};
+
+// Sung lines per section type, from templates or a language model
+constexpr std::array<size_t, SECTION_TYPE_COUNT> SECTION_LINE_COUNTS = {
+    1, // Intro
+    4, // Verse
+    2, // PreChorus
+    1, // Chorus
+    3, // Bridge
+    0, // Instrumental
+    1, // Breakdown
+    1  // Outro
+};
+constexpr size_t MAX_MODEL_WORDS = 12;
+// Draws per line while it runs over its syllable budget, and how many of
+// those may be spent looking for a rhyme with the line before
+constexpr int FIT_ATTEMPTS = 8;
+constexpr int RHYME_ATTEMPTS = 3;
+
+// Lexicographic (syllables over budget, not rhyming) for choosing between draws
+struct FitScore {
+    size_t over = 0;
+    bool missesRhyme = false;
+
+    FitScore(const LineProsody& line, size_t budget, uint16_t rhymeWith)
+        : over(line.syllables > budget ? line.syllables - budget : 0),
+          missesRhyme(rhymeWith != 0 && line.rhyme != rhymeWith) {}
+
+    [[nodiscard]] bool goodEnough(int attempt) const {
+        return over == 0 && (!missesRhyme || attempt + 1 >= RHYME_ATTEMPTS);
+    }
+    auto operator<=>(const FitScore&) const = default;
+};
+
+} // namespace
+
 LyricsGenerator::LyricsGenerator() : m_rng(std::random_device{}()) {}
 
 std::vector<std::string> LyricsGenerator::generate(
     const std::vector<Section>& sections,
-    uint32_t seed) {
+    uint32_t seed,
+    std::vector<LineProsody>* prosody) {
     
     m_lastSeed = seed;
-    m_rng.seed(seed);
     
     std::vector<std::string> lyrics;
+    if (prosody) {
+        prosody->clear();
+    }
     int verseCount = 0;
     
-    for (const auto& section : sections) {
-        switch (section.type) {
-            case SectionType::Intro:
-                lyrics.push_back("[INTRO]");
-                lyrics.push_back(generateLine(section.type, 0));
-                break;
-                
-            case SectionType::Verse:
-                lyrics.push_back("[VERSE " + std::to_string(++verseCount) + "]");
-                lyrics.push_back(generateVerse(verseCount));
-                break;
-                
-            case SectionType::PreChorus:
-                lyrics.push_back("[PRE-CHORUS]");
-                lyrics.push_back(generateLine(section.type, 0));
-                lyrics.push_back(generateLine(section.type, 1));
-                break;
-                
-            case SectionType::Chorus:
-                lyrics.push_back("[CHORUS]");
-                lyrics.push_back(generateChorus());
-                break;
-                
-            case SectionType::Bridge:
-                lyrics.push_back("[BRIDGE]");
-                lyrics.push_back(generateBridge());
-                break;
-                
-            case SectionType::Breakdown:
-                lyrics.push_back("[BREAKDOWN]");
-                lyrics.push_back(pickRandom(INDUSTRIAL_VERBS) + "! " + 
-                               pickRandom(INDUSTRIAL_VERBS) + "! " +
-                               pickRandom(INDUSTRIAL_VERBS) + "!");
-                break;
-                
-            case SectionType::Outro:
-                lyrics.push_back("[OUTRO]");
-                lyrics.push_back(generateLine(section.type, 0));
-                break;
-                
-            default:
-                break;
+    for (const Section& section : sections) {
+        if (auto header = sectionHeader(section, verseCount)) {
+            lyrics.push_back(std::move(*header));
+            if (prosody) {
+                prosody->emplace_back();
+            }
         }
         
-        lyrics.push_back(""); // Empty line between sections
+        auto lines = generateSection(section, seed);
+        lyrics.insert(lyrics.end(), lines->lines.begin(), lines->lines.end());
+        if (prosody) {
+            prosody->insert(prosody->end(), lines->prosody.begin(), lines->prosody.end());
+        }
     }
     
     return lyrics;
 }
 
-std::vector<std::string> LyricsGenerator::regenerate() {
-    return generate({}, m_lastSeed + 1);
+std::shared_ptr<const SectionLyrics> LyricsGenerator::generateSection(const Section& section, uint32_t seed) {
+    uint32_t derivedSeed = sectionSeed(seed, section);
+    if (!m_sectionCache) {
+        return std::make_shared<const SectionLyrics>(buildSection(section, derivedSeed));
+    }
+    
+    // Lyrics do not depend on intensity
+    SectionKey key(section, 0, derivedSeed, 0);
+    return m_sectionCache->getOrBuild(key, [&] {
+        return buildSection(section, derivedSeed);
+    });
+}
+
+std::optional<std::string> LyricsGenerator::sectionHeader(const Section& section, int& verseCount) {
+    // Headers carry the verse number, so they stay out of the cache
+    if (SECTION_LINE_COUNTS[static_cast<size_t>(section.type)] == 0) {
+        return std::nullopt;
+    }
+    return section.type == SectionType::Verse
+        ? std::format("[{} {}]", sectionTypeToString(section.type), ++verseCount)
+        : std::format("[{}]", sectionTypeToString(section.type));
+}
+
+void LyricsGenerator::setSectionCacheCapacity(size_t sections) {
+    if (sections == 0) {
+        m_sectionCache.reset();
+    } else {
+        m_sectionCache = std::make_unique<SectionCache<SectionLyrics>>(sections);
+    }
+}
+
+void LyricsGenerator::setLanguageModel(SectionType type, std::shared_ptr<const NgramModel> model) {
+    LanguageModel entry;
+    if (model) {
+        // Analyze the vocabulary once per model, however many types share it
+        for (const auto& existing : m_models) {
+            if (existing.model == model) {
+                entry.prosody = existing.prosody;
+            }
+        }
+        if (!entry.prosody) {
+            entry.prosody = std::make_shared<const std::vector<WordProsody>>(model->analyzeVocabulary());
+        }
+        entry.model = std::move(model);
+    }
+    m_models[static_cast<size_t>(type)] = std::move(entry);
+    
+    if (m_sectionCache) {
+        m_sectionCache->clear();
+    }
+}
+
+void LyricsGenerator::setWordBankPack(std::shared_ptr<const WordBankPack> pack) {
+    m_wordPack = std::move(pack);
+    
+    if (m_sectionCache) {
+        m_sectionCache->clear();
+    }
+}
+
+SectionLyrics LyricsGenerator::buildSection(const Section& section, uint32_t seed) {
+    m_rng.seed(scrambleSeed(seed));
+    
+    SectionLyrics lyrics;
+    size_t lineCount = SECTION_LINE_COUNTS[static_cast<size_t>(section.type)];
+    
+    // Each line gets an even share of the section
+    size_t beatsPerLine = lineCount > 0 ? static_cast<size_t>(std::max(section.totalBeats(), 1)) / lineCount : 0;
+    size_t budget = std::max<size_t>(beatsPerLine, 1) * MAX_SYLLABLES_PER_BEAT;
+    
+    const LanguageModel& model = m_models[static_cast<size_t>(section.type)];
+    uint16_t previousRhyme = 0;
+    for (size_t line = 0; line < lineCount; ++line) {
+        LineProsody prosody;
+        lyrics.lines.push_back(model.model
+            ? fitModelLine(model, budget, previousRhyme, prosody)
+            : fitTemplateLine(chooseTemplate(section.type, line), budget, previousRhyme, prosody));
+        lyrics.prosody.push_back(prosody);
+        previousRhyme = prosody.rhyme;
+    }
+    
+    lyrics.lines.push_back(""); // Empty line between sections
+    lyrics.prosody.emplace_back();
+    return lyrics;
+}
+
+std::vector<std::string> LyricsGenerator::regenerate(
+    const std::vector<Section>& sections,
+    std::vector<LineProsody>* prosody) {
+    
+    return generate(sections, m_lastSeed + 1, prosody);
 }
 
 Result<void> LyricsGenerator::exportToFile(
@@ -110,96 +273,109 @@ Result<void> LyricsGenerator::exportToFile(
     return {};
 }
 
-std::string LyricsGenerator::generateLine(SectionType type, int lineIndex) {
-    std::string pattern;
-    
+const LyricTemplate& LyricsGenerator::chooseTemplate(SectionType type, size_t lineIndex) {
     switch (type) {
         case SectionType::Intro:
-            pattern = "The {adj} {noun} {verb}s in silence";
-            break;
+            return INTRO_LINE;
+        case SectionType::Verse:
+            return VERSE_LINES[lineIndex % VERSE_LINES.size()];
         case SectionType::PreChorus:
-            pattern = lineIndex == 0 ? 
-                "We are the {adj} {noun}s" :
-                "{verb}ing through the {adj} night";
-            break;
+            return PRE_CHORUS_LINES[lineIndex % PRE_CHORUS_LINES.size()];
+        case SectionType::Chorus:
+            return CHORUS_LINES[pickIndex(CHORUS_LINES.size())];
+        case SectionType::Bridge:
+            return BRIDGE_LINES[lineIndex % BRIDGE_LINES.size()];
+        case SectionType::Breakdown:
+            return BREAKDOWN_LINE;
         case SectionType::Outro:
-            pattern = "Until the {noun} {verb}s no more";
-            break;
+            return OUTRO_LINE;
         default:
-            pattern = "{adj} {noun} {verb}s";
-            break;
+            return DEFAULT_LINE;
     }
-    
-    return generatePhrase(pattern);
 }
 
-std::string LyricsGenerator::generateChorus() {
-    std::vector<std::string> chorusPatterns = {
-        "{verb}! {verb}! The {adj} {noun}!",
-        "We are {adj}, we are {noun}",
-        "{verb} the {noun}, {verb} the system",
-        "No more {noun}s, only {adj} {noun}s"
-    };
+std::string LyricsGenerator::fitTemplateLine(const LyricTemplate& line, size_t budget, uint16_t rhymeWith,
+                                             LineProsody& prosody) {
+    LyricTemplate::Words best{};
+    std::optional<FitScore> bestScore;
+    for (int attempt = 0; attempt < FIT_ATTEMPTS; ++attempt) {
+        LyricTemplate::Words words{};
+        line.draw(words, [this](LyricSlot slot) { return pickWord(slot); });
+        LineProsody drawn = line.prosody(words);
+        FitScore score(drawn, budget, line.hasFixedRhyme() ? 0 : rhymeWith);
+        if (!bestScore || score < *bestScore) {
+            best = words;
+            bestScore = score;
+            prosody = drawn;
+        }
+        if (bestScore->goodEnough(attempt)) break;
+    }
     
-    return generatePhrase(pickRandom(chorusPatterns));
+    std::string text;
+    size_t longestWord = m_wordPack ? std::max(MAX_WORD_LENGTH, m_wordPack->getMaxWordLength()) : MAX_WORD_LENGTH;
+    text.reserve(line.maxLength(longestWord));
+    line.render(text, best);
+    return text;
 }
 
-std::string LyricsGenerator::generateVerse(int verseNumber) {
-    std::ostringstream verse;
-    
-    // First line
-    verse << generatePhrase("In the {adj} {noun} of {noun}s") << "\n";
-    
-    // Second line
-    verse << generatePhrase("Where {noun}s {verb} and {verb}") << "\n";
-    
-    // Third line
-    verse << generatePhrase("The {adj} {noun} {verb}s forever") << "\n";
-    
-    // Fourth line
-    verse << generatePhrase("And we become {adj} {noun}s");
+std::string LyricsGenerator::fitModelLine(const LanguageModel& model, size_t budget, uint16_t rhymeWith,
+                                          LineProsody& prosody) {
+    const auto& vocabulary = *model.prosody;
+    std::array<NgramModel::Token, MAX_MODEL_WORDS> best{};
+    size_t bestCount = 0;
+    std::optional<FitScore> bestScore;
+    for (int attempt = 0; attempt < FIT_ATTEMPTS; ++attempt) {
+        std::array<NgramModel::Token, MAX_MODEL_WORDS> tokens{};
+        size_t count = model.model->sampleLine(tokens, m_rng);
+        LineProsody drawn;
+        for (size_t i = 0; i < count; ++i) {
+            if (tokens[i] < vocabulary.size()) {
+                drawn.append(vocabulary[tokens[i]]);
+            }
+        }
+        FitScore score(drawn, budget, rhymeWith);
+        if (!bestScore || score < *bestScore) {
+            best = tokens;
+            bestCount = count;
+            bestScore = score;
+            prosody = drawn;
+        }
+        if (bestScore->goodEnough(attempt)) break;
+    }
     
-    return verse.str();
+    std::string text;
+    for (size_t i = 0; i < bestCount; ++i) {
+        if (i > 0) text += ' ';
+        text.append(model.model->word(best[i]));
+    }
+    if (!text.empty()) {
+        text[0] = static_cast<char>(std::toupper(static_cast<unsigned char>(text[0])));
+    }
+    return text;
 }
 
-std::string LyricsGenerator::generateBridge() {
-    std::ostringstream bridge;
-    
-    std::string theme = pickRandom(THEMES);
-    bridge << "This is our " << theme << "\n";
-    bridge << generatePhrase("Where {noun}s and {noun}s collide") << "\n";
-    bridge << generatePhrase("We {verb} against the {adj} machine");
-    
-    return bridge.str();
+size_t LyricsGenerator::pickIndex(size_t count) {
+    std::uniform_int_distribution<size_t> dist(0, count - 1);
+    return dist(m_rng);
 }
 
-std::string LyricsGenerator::pickRandom(const std::vector<std::string>& words) {
-    if (words.empty()) return "";
-    
-    std::uniform_int_distribution<size_t> dist(0, words.size() - 1);
-    return words[dist(m_rng)];
+uint64_t LyricsGenerator::randomBits() {
+    // minstd gives 31 bits per call; two calls fill both halves
+    uint64_t high = m_rng();
+    uint64_t low = m_rng();
+    return (high << 33) | (low << 1);
 }
 
-std::string LyricsGenerator::generatePhrase(const std::string& pattern) {
-    std::string result = pattern;
-    
-    // Replace placeholders
-    size_t pos = 0;
-    while ((pos = result.find("{adj}", pos)) != std::string::npos) {
-        result.replace(pos, 5, pickRandom(INDUSTRIAL_ADJECTIVES));
-    }
-    
-    pos = 0;
-    while ((pos = result.find("{noun}", pos)) != std::string::npos) {
-        result.replace(pos, 6, pickRandom(INDUSTRIAL_NOUNS));
+LyricWord LyricsGenerator::pickWord(LyricSlot slot) {
+    if (m_wordPack && m_wordPack->hasWords(slot)) {
+        return m_wordPack->pick(slot, randomBits());
     }
     
-    pos = 0;
-    while ((pos = result.find("{verb}", pos)) != std::string::npos) {
-        result.replace(pos, 6, pickRandom(INDUSTRIAL_VERBS));
-    }
+    const WordBank& bank = WORD_BANKS[static_cast<size_t>(slot)];
+    if (bank.words.empty()) return {};
     
-    return result;
+    size_t index = pickIndex(bank.words.size());
+    return {bank.words[index], bank.prosody[index]};
 }
 
 } // namespace IndustrialMusic
\ No newline at end of file
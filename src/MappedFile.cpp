@@ -0,0 +1,112 @@
+#include "MappedFile.h"
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace IndustrialMusic {
+
+MappedFile::~MappedFile() {
+    release();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : m_data(std::exchange(other.m_data, nullptr)),
+      m_size(std::exchange(other.m_size, 0)) {
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        release();
+        m_data = std::exchange(other.m_data, nullptr);
+        m_size = std::exchange(other.m_size, 0);
+    }
+    return *this;
+}
+
+Result<MappedFile> MappedFile::open(const std::filesystem::path& filepath) {
+    MappedFile file;
+
+#ifdef _WIN32
+    HANDLE handle = CreateFileW(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+        return std::unexpected(ErrorCode::FileReadFailed);
+    }
+
+    LARGE_INTEGER size{};
+    if (!GetFileSizeEx(handle, &size)) {
+        CloseHandle(handle);
+        return std::unexpected(ErrorCode::FileReadFailed);
+    }
+
+    // Empty files cannot be mapped, but are still valid
+    if (size.QuadPart > 0) {
+        HANDLE mapping = CreateFileMappingW(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(handle);
+        if (!mapping) {
+            return std::unexpected(ErrorCode::FileReadFailed);
+        }
+
+        void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping);
+        if (!view) {
+            return std::unexpected(ErrorCode::FileReadFailed);
+        }
+
+        file.m_data = static_cast<const uint8_t*>(view);
+        file.m_size = static_cast<size_t>(size.QuadPart);
+    } else {
+        CloseHandle(handle);
+    }
+#else
+    int fd = ::open(filepath.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return std::unexpected(ErrorCode::FileReadFailed);
+    }
+
+    struct stat info{};
+    if (fstat(fd, &info) != 0) {
+        ::close(fd);
+        return std::unexpected(ErrorCode::FileReadFailed);
+    }
+
+    // Empty files cannot be mapped, but are still valid
+    if (info.st_size > 0) {
+        void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (view == MAP_FAILED) {
+            ::close(fd);
+            return std::unexpected(ErrorCode::FileReadFailed);
+        }
+
+        file.m_data = static_cast<const uint8_t*>(view);
+        file.m_size = static_cast<size_t>(info.st_size);
+    }
+    ::close(fd);
+#endif
+
+    return file;
+}
+
+void MappedFile::release() {
+    if (!m_data) return;
+
+#ifdef _WIN32
+    UnmapViewOfFile(m_data);
+#else
+    munmap(const_cast<uint8_t*>(m_data), m_size);
+#endif
+
+    m_data = nullptr;
+    m_size = 0;
+}
+
+} // namespace IndustrialMusic
\ No newline at end of file
@@ -1,4 +1,7 @@
 #include "MidiGenerator.h"
+#include "MidiReader.h"
+#include "ThreadPool.h"
+#include "SongCache.h"
 #include <fstream>
 #include <iostream>
 
@@ -6,7 +9,7 @@ namespace IndustrialMusic {
 
 MidiGenerator::MidiGenerator() = default;
 
-Result<std::vector<uint8_t>> MidiGenerator::generate(
+Result<MidiBytes> MidiGenerator::generate(
     const std::vector<Section>& sections,
     const AudioParams& params,
     uint32_t seed) {
@@ -15,42 +18,204 @@ Result<std::vector<uint8_t>> MidiGenerator::generate(
         return std::unexpected(ErrorCode::InvalidParameter);
     }
     
-    uint32_t microsecondsPerQuarter = static_cast<uint32_t>(60000000 / params.tempo);
+    if (!m_songCache) {
+        return generateUncached(sections, params, seed);
+    }
+    
+    auto key = songCacheKey(sections, params, seed);
+    if (auto cached = m_songCache->find(key)) {
+        return MidiBytes(std::move(*cached));
+    }
+    
+    auto result = generateUncached(sections, params, seed);
+    if (result) {
+        // A failed store only costs a regeneration next time
+        (void)m_songCache->store(key, *result);
+    }
+    return result;
+}
+
+Result<std::vector<uint8_t>> MidiGenerator::generateUncached(
+    const std::vector<Section>& sections,
+    const AudioParams& params,
+    uint32_t seed) const {
     
-    // MIDI file header
-    std::vector<uint8_t> midiData;
+    if (!m_threadPool) {
+        // Single output buffer for the whole file, sized once up front
+        MidiWriter out(estimateFileSize(sections));
+        out.writeHeader(1, TRACK_COUNT, TICKS_PER_QUARTER); // Format type 1
+        
+        for (size_t track = 0; track < TRACK_COUNT; ++track) {
+            createTrack(out, track, sections, params, seed);
+        }
+        return out.release();
+    }
     
-    // Header chunk
-    midiData.insert(midiData.end(), {'M', 'T', 'h', 'd'});
-    midiData.insert(midiData.end(), {0x00, 0x00, 0x00, 0x06}); // Header length
-    midiData.insert(midiData.end(), {0x00, 0x01}); // Format type 1
-    midiData.insert(midiData.end(), {0x00, 0x06}); // Number of tracks
-    midiData.insert(midiData.end(), {
-        static_cast<uint8_t>((TICKS_PER_QUARTER >> 8) & 0xFF),
-        static_cast<uint8_t>(TICKS_PER_QUARTER & 0xFF)
-    });
+    // Each track only depends on the sections, params and its own seed offset,
+    // so build them concurrently into separate buffers
+    std::array<MidiWriter, TRACK_COUNT> tracks;
+    std::array<std::future<void>, TRACK_COUNT> pending;
+    const size_t trackEstimate = estimateFileSize(sections) / 3;
+    for (size_t track = 0; track < TRACK_COUNT; ++track) {
+        tracks[track] = MidiWriter(trackEstimate);
+        pending[track] = m_threadPool->submit([&, track] {
+            createTrack(tracks[track], track, sections, params, seed);
+        });
+    }
     
-    // Create tracks
-    auto track1 = createTempoTrack(microsecondsPerQuarter, sections);
-    auto track2 = createDrumTrack(sections, params.tempo, params.intensity, seed);
-    auto track3 = createBassTrack(sections, params.intensity, seed + 1);
-    auto track4 = createLeadTrack(sections, params.intensity, seed + 2);
-    auto track5 = createPadTrack(sections, params.intensity, seed + 3);
-    auto track6 = createEffectsTrack(sections, params.intensity, seed + 4);
+    // Let every task finish before rethrowing, since they write into `tracks`
+    for (auto& result : pending) {
+        result.wait();
+    }
+    for (auto& result : pending) {
+        result.get();
+    }
     
-    // Append all tracks
-    midiData.insert(midiData.end(), track1.begin(), track1.end());
-    midiData.insert(midiData.end(), track2.begin(), track2.end());
-    midiData.insert(midiData.end(), track3.begin(), track3.end());
-    midiData.insert(midiData.end(), track4.begin(), track4.end());
-    midiData.insert(midiData.end(), track5.begin(), track5.end());
-    midiData.insert(midiData.end(), track6.begin(), track6.end());
+    // Concatenate in fixed track order
+    size_t totalSize = 14;
+    for (const auto& track : tracks) {
+        totalSize += track.size();
+    }
     
-    return midiData;
+    MidiWriter out(totalSize);
+    out.writeHeader(1, TRACK_COUNT, TICKS_PER_QUARTER); // Format type 1
+    for (const auto& track : tracks) {
+        out.writeBytes(track.data());
+    }
+    return out.release();
+}
+
+std::string MidiGenerator::songCacheKey(const std::vector<Section>& sections, const AudioParams& params, uint32_t seed) const {
+    // Only what the generated bytes depend on: names, distortion and vocals
+    // do not change the MIDI output
+    ContentHasher hasher;
+    hasher.add(GENERATOR_VERSION);
+    hasher.add(seed);
+    hasher.add(params.tempo);
+    hasher.add(params.intensity);
+    
+    hasher.add(sections.size());
+    for (const auto& section : sections) {
+        hasher.add(section.type);
+        hasher.add(section.bars);
+        hasher.add(section.beatsPerBar);
+        hasher.add(section.variation);
+    }
+    
+    for (size_t part = 0; part < PATTERN_PART_COUNT; ++part) {
+        hasher.add(m_patternEngine.getTransforms(static_cast<PatternPart>(part)).fingerprint());
+        const auto& groove = m_patternEngine.getGrooveTemplate(static_cast<PatternPart>(part));
+        hasher.add(groove.has_value());
+        if (!groove) continue;
+        hasher.add(groove->lengthTicks);
+        hasher.add(groove->notes.size());
+        for (const auto& note : groove->notes) {
+            hasher.add(note.note);
+            hasher.add(note.velocity);
+            hasher.add(note.startTick);
+            hasher.add(note.duration);
+        }
+    }
+    return hasher.hex();
+}
+
+void MidiGenerator::createTrack(MidiWriter& out, size_t trackIndex, const std::vector<Section>& sections, const AudioParams& params, uint32_t seed) const {
+    out.beginTrack();
+    for (auto chunk : encodeTrack(trackIndex, sections, params, seed)) {
+        out.writeBytes(chunk);
+    }
+    out.endTrack();
+}
+
+Result<void> MidiGenerator::generateToFile(
+    const std::vector<Section>& sections,
+    const AudioParams& params,
+    const std::filesystem::path& filepath,
+    uint32_t seed) {
+    
+    if (sections.empty()) {
+        return std::unexpected(ErrorCode::InvalidParameter);
+    }
+    
+    if (!m_songCache) {
+        return streamToFile(sections, params, filepath, seed);
+    }
+    
+    auto key = songCacheKey(sections, params, seed);
+    if (auto cached = m_songCache->find(key)) {
+        return saveToFile(cached->bytes(), filepath);
+    }
+    
+    if (auto result = streamToFile(sections, params, filepath, seed); !result) {
+        return result;
+    }
+    if (auto written = MappedFile::open(filepath)) {
+        (void)m_songCache->store(key, written->bytes());
+    }
+    return {};
+}
+
+Result<void> MidiGenerator::streamToFile(
+    const std::vector<Section>& sections,
+    const AudioParams& params,
+    const std::filesystem::path& filepath,
+    uint32_t seed) const {
+    
+    MidiFileSink sink(filepath);
+    if (!sink.isOpen()) {
+        return std::unexpected(ErrorCode::FileWriteFailed);
+    }
+    
+    MidiWriter header(14);
+    header.writeHeader(1, TRACK_COUNT, TICKS_PER_QUARTER); // Format type 1
+    sink.write(header.data());
+    
+    // Tracks are pulled through the pipeline one chunk at a time
+    for (size_t track = 0; track < TRACK_COUNT; ++track) {
+        sink.beginTrack();
+        for (auto chunk : encodeTrack(track, sections, params, seed)) {
+            sink.write(chunk);
+        }
+        sink.endTrack();
+    }
+    
+    return sink.close();
+}
+
+Result<void> MidiGenerator::loadGrooveTemplate(Part part, const std::filesystem::path& filepath) {
+    auto reader = MidiReader::open(filepath);
+    if (!reader) {
+        return std::unexpected(reader.error());
+    }
+    
+    auto groove = reader->extractGroove(TICKS_PER_QUARTER);
+    if (!groove) {
+        return std::unexpected(groove.error());
+    }
+    
+    setGrooveTemplate(part, std::move(*groove));
+    return {};
+}
+
+void MidiGenerator::setGrooveTemplate(Part part, std::optional<GrooveTemplate> groove) {
+    m_patternEngine.setGrooveTemplate(part, std::move(groove));
+}
+
+size_t MidiGenerator::estimateFileSize(const std::vector<Section>& sections) {
+    size_t totalBeats = 0;
+    for (const auto& section : sections) {
+        totalBeats += static_cast<size_t>(std::max(section.totalBeats(), 0));
+    }
+    
+    // Header and per-track overhead (names, meta events, end of track), plus
+    // a handful of 3-4 byte running-status events per beat across the tracks
+    constexpr size_t FIXED_BYTES = 14 + TRACK_COUNT * 64;
+    constexpr size_t BYTES_PER_BEAT = 24;
+    return FIXED_BYTES + totalBeats * BYTES_PER_BEAT;
 }
 
 Result<void> MidiGenerator::saveToFile(
-    const std::vector<uint8_t>& midiData,
+    std::span<const uint8_t> midiData,
     const std::filesystem::path& filepath) {
     
     std::ofstream file(filepath, std::ios::binary);
@@ -64,9 +229,11 @@ Result<void> MidiGenerator::saveToFile(
 
 Result<void> MidiGenerator::initializeMidiOutput() {
     try {
-        // For now, just create a dummy MIDI output
-        // The new libremidi API requires configuration objects
-        // TODO: Update to use the new libremidi API properly
+        auto sink = LibremidiSink::open(m_selectedOutput);
+        if (!sink) {
+            return std::unexpected(sink.error());
+        }
+        setMidiOutput(std::move(*sink));
         return {};
         
     } catch (const std::exception& e) {
@@ -75,228 +242,185 @@ Result<void> MidiGenerator::initializeMidiOutput() {
     }
 }
 
+void MidiGenerator::setMidiOutput(std::unique_ptr<MidiSink> sink) {
+    // Stop the old output thread before the new one starts sending
+    m_midiScheduler.reset();
+    if (sink) {
+        m_midiScheduler = std::make_unique<MidiScheduler>(std::move(sink));
+    }
+}
+
 void MidiGenerator::sendMidiNote(uint8_t channel, uint8_t note, uint8_t velocity) {
-    if (!m_midiOut) return;
+    if (!m_midiScheduler) return;
     
-    std::vector<unsigned char> message;
     if (velocity > 0) {
-        message = {static_cast<unsigned char>(0x90 + channel), note, velocity};
+        m_midiScheduler->sendNow(MidiMessage::noteOn(channel, note, velocity));
     } else {
-        message = {static_cast<unsigned char>(0x80 + channel), note, 0};
+        m_midiScheduler->sendNow(MidiMessage::noteOff(channel, note));
     }
-    
-    m_midiOut->send_message(message);
 }
 
-std::vector<uint8_t> MidiGenerator::createTempoTrack(uint32_t microsecondsPerQuarter, const std::vector<Section>& sections) {
-    std::vector<uint8_t> track;
-    
-    // Track header
-    track.insert(track.end(), {'M', 'T', 'r', 'k'});
-    track.insert(track.end(), {0x00, 0x00, 0x00, 0x00}); // Length placeholder
-    
-    // Tempo meta event
-    track.push_back(0x00); // Delta time
-    track.insert(track.end(), {0xFF, 0x51, 0x03}); // Tempo meta event
-    track.push_back((microsecondsPerQuarter >> 16) & 0xFF);
-    track.push_back((microsecondsPerQuarter >> 8) & 0xFF);
-    track.push_back(microsecondsPerQuarter & 0xFF);
-    
-    // Time signature (4/4)
-    track.push_back(0x00); // Delta time
-    track.insert(track.end(), {0xFF, 0x58, 0x04, 0x04, 0x02, 0x18, 0x08});
-    
-    // Track name
-    track.push_back(0x00);
-    track.insert(track.end(), {0xFF, 0x03}); // Track name meta event
-    const std::string trackName = "Tempo Track";
-    track.push_back(static_cast<uint8_t>(trackName.length()));
-    track.insert(track.end(), trackName.begin(), trackName.end());
-    
-    // End of track
-    track.push_back(0x00);
-    track.insert(track.end(), {0xFF, 0x2F, 0x00});
-    
-    // Update track length
-    updateTrackLength(track);
-    
-    return track;
+void MidiGenerator::sendMidiCC(uint8_t channel, uint8_t controller, uint8_t value) {
+    if (!m_midiScheduler) return;
+    m_midiScheduler->sendNow(MidiMessage::controlChange(channel, controller, value));
 }
 
-std::vector<uint8_t> MidiGenerator::createDrumTrack(const std::vector<Section>& sections, int tempo, int intensity, uint32_t seed) {
-    std::vector<uint8_t> track;
-    
-    // Track header
-    track.insert(track.end(), {'M', 'T', 'r', 'k'});
-    track.insert(track.end(), {0x00, 0x00, 0x00, 0x00}); // Length placeholder
-    
-    // Track name
-    track.push_back(0x00);
-    track.insert(track.end(), {0xFF, 0x03}); // Track name meta event
-    const std::string trackName = "Drums";
-    track.push_back(static_cast<uint8_t>(trackName.length()));
-    track.insert(track.end(), trackName.begin(), trackName.end());
-    
-    // Generate drum patterns for each section
-    uint32_t currentTick = 0;
-    std::mt19937 rng(seed);
-    std::uniform_real_distribution<float> dist(0.0f, 1.0f);
-    
-    for (const auto& section : sections) {
-        int totalBeats = section.totalBeats();
-        
-        for (int beat = 0; beat < totalBeats; ++beat) {
-            // Simple kick pattern
-            if (beat % 4 == 0) {
-                addNoteOn(track, currentTick, DRUM_CHANNEL, KICK_NOTE, 100);
-                currentTick = TICKS_PER_QUARTER / 8; // Short note
-                addNoteOff(track, currentTick, DRUM_CHANNEL, KICK_NOTE);
-                currentTick = TICKS_PER_QUARTER - TICKS_PER_QUARTER / 8;
-            }
-            // Snare on 2 and 4
-            else if (beat % 4 == 2) {
-                addNoteOn(track, currentTick, DRUM_CHANNEL, SNARE_NOTE, 90);
-                currentTick = TICKS_PER_QUARTER / 8;
-                addNoteOff(track, currentTick, DRUM_CHANNEL, SNARE_NOTE);
-                currentTick = TICKS_PER_QUARTER - TICKS_PER_QUARTER / 8;
-            }
-            else {
-                currentTick += TICKS_PER_QUARTER;
-            }
-        }
-    }
-    
-    // End of track
-    track.push_back(0x00);
-    track.insert(track.end(), {0xFF, 0x2F, 0x00});
-    
-    updateTrackLength(track);
-    return track;
+void MidiGenerator::sendMidiProgramChange(uint8_t channel, uint8_t program) {
+    if (!m_midiScheduler) return;
+    m_midiScheduler->sendNow(MidiMessage::programChange(channel, program));
 }
 
-std::vector<uint8_t> MidiGenerator::createBassTrack(const std::vector<Section>& sections, int intensity, uint32_t seed) {
-    std::vector<uint8_t> track;
-    
-    // Track header
-    track.insert(track.end(), {'M', 'T', 'r', 'k'});
-    track.insert(track.end(), {0x00, 0x00, 0x00, 0x00}); // Length placeholder
-    
-    // Track name
-    track.push_back(0x00);
-    track.insert(track.end(), {0xFF, 0x03});
-    const std::string trackName = "Bass";
-    track.push_back(static_cast<uint8_t>(trackName.length()));
-    track.insert(track.end(), trackName.begin(), trackName.end());
-    
-    // Program change to synth bass
-    track.push_back(0x00);
-    track.insert(track.end(), {0xC0, 38}); // Synth Bass 1
-    
-    // Simple bass pattern
-    uint32_t currentTick = 0;
-    for (const auto& section : sections) {
-        for (int bar = 0; bar < section.bars; ++bar) {
-            // Root note pattern
-            addNoteOn(track, currentTick, 0, BASS_NOTES[0], 80);
-            currentTick = TICKS_PER_QUARTER * 2;
-            addNoteOff(track, currentTick, 0, BASS_NOTES[0]);
-            
-            addNoteOn(track, 0, 0, BASS_NOTES[5], 70);
-            currentTick = TICKS_PER_QUARTER * 2;
-            addNoteOff(track, currentTick, 0, BASS_NOTES[5]);
-        }
+std::vector<std::string> MidiGenerator::getAvailableMidiOutputs() const {
+    try {
+        return LibremidiSink::availableOutputs();
+    } catch (const std::exception& e) {
+        std::cerr << "MIDI port enumeration error: " << e.what() << "\n";
+        return {};
     }
-    
-    // End of track
-    track.push_back(0x00);
-    track.insert(track.end(), {0xFF, 0x2F, 0x00});
-    
-    updateTrackLength(track);
-    return track;
 }
 
-std::vector<uint8_t> MidiGenerator::createLeadTrack(const std::vector<Section>& sections, int intensity, uint32_t seed) {
-    // Similar implementation to bass track but with lead synth
-    // For now, return empty track
-    std::vector<uint8_t> track;
-    track.insert(track.end(), {'M', 'T', 'r', 'k'});
-    track.insert(track.end(), {0x00, 0x00, 0x00, 0x0A}); // Length
-    track.push_back(0x00);
-    track.insert(track.end(), {0xFF, 0x2F, 0x00}); // End of track
-    return track;
+Result<void> MidiGenerator::selectMidiOutput(size_t index) {
+    m_selectedOutput = index;
+    
+    // Reopen if output was already running on another port
+    if (m_midiScheduler) {
+        return initializeMidiOutput();
+    }
+    return {};
 }
 
-std::vector<uint8_t> MidiGenerator::createPadTrack(const std::vector<Section>& sections, int intensity, uint32_t seed) {
-    // Pad/atmosphere track
-    std::vector<uint8_t> track;
-    track.insert(track.end(), {'M', 'T', 'r', 'k'});
-    track.insert(track.end(), {0x00, 0x00, 0x00, 0x0A}); // Length
-    track.push_back(0x00);
-    track.insert(track.end(), {0xFF, 0x2F, 0x00}); // End of track
-    return track;
+std::generator<MidiGenerator::SectionSpan> MidiGenerator::sectionStream(const std::vector<Section>& sections) const {
+    uint32_t startTick = 0;
+    for (size_t i = 0; i < sections.size(); ++i) {
+        co_yield SectionSpan{&sections[i], startTick};
+        startTick += static_cast<uint32_t>(sections[i].totalBeats()) * TICKS_PER_QUARTER;
+    }
 }
 
-std::vector<uint8_t> MidiGenerator::createEffectsTrack(const std::vector<Section>& sections, int intensity, uint32_t seed) {
-    // Sound effects track
-    std::vector<uint8_t> track;
-    track.insert(track.end(), {'M', 'T', 'r', 'k'});
-    track.insert(track.end(), {0x00, 0x00, 0x00, 0x0A}); // Length
-    track.push_back(0x00);
-    track.insert(track.end(), {0xFF, 0x2F, 0x00}); // End of track
-    return track;
+void MidiGenerator::buildSectionEvents(const NoteStream& notes, std::vector<MidiEvent>& events, std::vector<MidiEvent>& scratch) {
+    // Note-offs are sent as note-on with velocity 0 so they share running
+    // status with the note-ons. Releases go in first so that, after the
+    // stable sort, a note ending on the same tick another starts is
+    // released before it is struck again.
+    events.clear();
+    events.reserve(notes.size() * 2);
+    for (size_t i = 0; i < notes.size(); ++i) {
+        events.push_back({notes.ticks[i] + notes.durations[i], static_cast<uint8_t>(0x90 | notes.channels[i]), notes.notes[i], 0});
+    }
+    for (size_t i = 0; i < notes.size(); ++i) {
+        events.push_back({notes.ticks[i], static_cast<uint8_t>(0x90 | notes.channels[i]), notes.notes[i], notes.velocities[i]});
+    }
+    sortEventsByTick(events, scratch);
 }
 
-std::vector<uint8_t> MidiGenerator::encodeVariableLength(uint32_t value) const {
-    std::vector<uint8_t> result;
-    
-    if (value == 0) {
-        result.push_back(0);
-        return result;
+std::generator<const MidiEvent&> MidiGenerator::noteEvents(const std::vector<Section>& sections, int intensity, uint32_t seed, PatternPart part) const {
+    NoteStream built;               // Section notes when not cached
+    std::vector<MidiEvent> chunk;
+    std::vector<MidiEvent> scratch;
+    std::vector<MidiEvent> events;
+    std::vector<MidiEvent> pending; // Note-offs that fall after the end of their section
+    
+    for (const auto& span : sectionStream(sections)) {
+        std::shared_ptr<const NoteStream> cached;
+        const NoteStream& notes = m_patternEngine.sectionNotes(part, *span.section, intensity, sectionSeed(seed, *span.section), built, cached);
+        buildSectionEvents(notes, chunk, scratch);
+        
+        // Splice the chunk in at the section start. Carried-over releases
+        // come first on equal ticks, as if sorted together with the chunk.
+        events.clear();
+        auto carried = pending.begin();
+        for (MidiEvent event : chunk) {
+            event.tick += span.startTick;
+            for (; carried != pending.end() && carried->tick <= event.tick; ++carried) {
+                events.push_back(*carried);
+            }
+            events.push_back(event);
+        }
+        events.insert(events.end(), carried, pending.end());
+        pending.clear();
+        
+        uint32_t endTick = span.startTick + static_cast<uint32_t>(span.section->totalBeats()) * TICKS_PER_QUARTER;
+        for (const auto& event : events) {
+            if (event.tick < endTick) {
+                co_yield event;
+            } else {
+                pending.push_back(event);
+            }
+        }
     }
     
-    // Extract 7-bit chunks
-    std::vector<uint8_t> bytes;
-    while (value > 0) {
-        bytes.push_back(value & 0x7F);
-        value >>= 7;
+    for (const auto& event : pending) {
+        co_yield event;
     }
-    
-    // Reverse and add continuation bits
-    for (int i = static_cast<int>(bytes.size()) - 1; i >= 0; --i) {
-        if (i > 0) {
-            result.push_back(bytes[i] | 0x80);
-        } else {
-            result.push_back(bytes[i]);
+}
+
+std::generator<std::span<const uint8_t>> MidiGenerator::encodeTrack(size_t trackIndex, const std::vector<Section>& sections, const AudioParams& params, uint32_t seed) const {
+    // Track body only; the MTrk header and end of track belong to the sink.
+    // Short songs never fill a whole chunk, so size the buffer to the song.
+    auto part = trackPart(trackIndex);
+    size_t chunkSize = part ? std::min(STREAM_CHUNK_BYTES, estimateFileSize(sections) / 2) : 0;
+    MidiWriter body(chunkSize + 64);
+    writeTrackPrologue(body, trackIndex, params);
+    
+    if (part) {
+        uint32_t trackSeed = PatternEngine::partSeed(seed, *part);
+        for (const auto& event : noteEvents(sections, params.intensity, trackSeed, *part)) {
+            body.writeEvent(event);
+            if (body.size() >= STREAM_CHUNK_BYTES) {
+                co_yield body.data();
+                body.clear();
+            }
         }
     }
     
-    return result;
-}
-
-void MidiGenerator::addNoteOn(std::vector<uint8_t>& track, uint32_t deltaTicks, uint8_t channel, uint8_t note, uint8_t velocity) {
-    auto delta = encodeVariableLength(deltaTicks);
-    track.insert(track.end(), delta.begin(), delta.end());
-    track.push_back(0x90 | channel);
-    track.push_back(note);
-    track.push_back(velocity);
+    if (body.size() > 0) {
+        co_yield body.data();
+    }
 }
 
-void MidiGenerator::addNoteOff(std::vector<uint8_t>& track, uint32_t deltaTicks, uint8_t channel, uint8_t note) {
-    auto delta = encodeVariableLength(deltaTicks);
-    track.insert(track.end(), delta.begin(), delta.end());
-    track.push_back(0x80 | channel);
-    track.push_back(note);
-    track.push_back(0);
+void MidiGenerator::writeTrackPrologue(MidiWriter& out, size_t trackIndex, const AudioParams& params) const {
+    switch (trackIndex) {
+        case 0: {
+            // Tempo meta event
+            uint32_t microsecondsPerQuarter = static_cast<uint32_t>(60000000 / params.tempo);
+            const uint8_t tempo[] = {
+                static_cast<uint8_t>((microsecondsPerQuarter >> 16) & 0xFF),
+                static_cast<uint8_t>((microsecondsPerQuarter >> 8) & 0xFF),
+                static_cast<uint8_t>(microsecondsPerQuarter & 0xFF)
+            };
+            out.writeMetaEvent(0, 0x51, tempo);
+            
+            // Time signature (4/4)
+            const uint8_t timeSignature[] = {0x04, 0x02, 0x18, 0x08};
+            out.writeMetaEvent(0, 0x58, timeSignature);
+            
+            out.writeTextEvent(0, 0x03, "Tempo Track");
+            break;
+        }
+        case 1:
+            out.writeTextEvent(0, 0x03, "Drums");
+            break;
+        case 2:
+            out.writeTextEvent(0, 0x03, "Bass");
+            out.writeChannelEvent(0, 0xC0 | PatternEngine::BASS_CHANNEL, 38); // Synth Bass 1
+            break;
+        case 3:
+            out.writeTextEvent(0, 0x03, "Lead");
+            out.writeChannelEvent(0, 0xC0 | PatternEngine::LEAD_CHANNEL, 81); // Lead 2 (sawtooth)
+            break;
+        default:
+            // Pad and effects tracks are still empty
+            break;
+    }
 }
 
-void MidiGenerator::updateTrackLength(std::vector<uint8_t>& track) {
-    if (track.size() < 8) return;
-    
-    uint32_t length = static_cast<uint32_t>(track.size() - 8);
-    track[4] = (length >> 24) & 0xFF;
-    track[5] = (length >> 16) & 0xFF;
-    track[6] = (length >> 8) & 0xFF;
-    track[7] = length & 0xFF;
+std::optional<PatternPart> MidiGenerator::trackPart(size_t trackIndex) {
+    switch (trackIndex) {
+        case 1: return PatternPart::Drums;
+        case 2: return PatternPart::Bass;
+        case 3: return PatternPart::Lead;
+        default: return std::nullopt;
+    }
 }
 
 } // namespace IndustrialMusic
\ No newline at end of file
@@ -0,0 +1,191 @@
+#include "MidiReader.h"
+#include <cstring>
+
+namespace IndustrialMusic {
+
+namespace {
+
+uint32_t readBigEndian32(const uint8_t* bytes) {
+    return (static_cast<uint32_t>(bytes[0]) << 24) | (static_cast<uint32_t>(bytes[1]) << 16) |
+           (static_cast<uint32_t>(bytes[2]) << 8) | static_cast<uint32_t>(bytes[3]);
+}
+
+uint16_t readBigEndian16(const uint8_t* bytes) {
+    return static_cast<uint16_t>((bytes[0] << 8) | bytes[1]);
+}
+
+} // namespace
+
+bool MidiTrackView::iterator::readVariableLength(uint32_t& value) {
+    value = 0;
+    for (int i = 0; i < 4 && m_pos < m_end; ++i) {
+        uint8_t byte = *m_pos++;
+        value = (value << 7) | (byte & 0x7F);
+        if ((byte & 0x80) == 0) return true;
+    }
+    return false;
+}
+
+void MidiTrackView::iterator::advance() {
+    m_done = true;
+    if (m_pos >= m_end) return;
+
+    uint32_t delta = 0;
+    if (!readVariableLength(delta) || m_pos >= m_end) return;
+    m_event.tick += delta;
+
+    uint8_t status = *m_pos;
+    if (status & 0x80) {
+        ++m_pos;
+    } else if (m_runningStatus != 0) {
+        // Running status: the data byte belongs to the previous status
+        status = m_runningStatus;
+    } else {
+        return;
+    }
+
+    m_event.status = status;
+    m_event.metaType = 0;
+
+    if (status == 0xFF || status == 0xF0 || status == 0xF7) {
+        if (status == 0xFF) {
+            if (m_pos >= m_end) return;
+            m_event.metaType = *m_pos++;
+        }
+
+        uint32_t length = 0;
+        if (!readVariableLength(length) || length > static_cast<size_t>(m_end - m_pos)) return;
+        m_event.data = {m_pos, length};
+        m_pos += length;
+
+        // Meta and sysex events cancel running status
+        m_runningStatus = 0;
+    } else {
+        uint8_t type = status & 0xF0;
+        size_t length = (type == 0xC0 || type == 0xD0) ? 1 : 2;
+        if (length > static_cast<size_t>(m_end - m_pos)) return;
+        m_event.data = {m_pos, length};
+        m_pos += length;
+        m_runningStatus = status;
+    }
+
+    m_done = false;
+}
+
+Result<MidiReader> MidiReader::open(const std::filesystem::path& filepath) {
+    auto file = MappedFile::open(filepath);
+    if (!file) {
+        return std::unexpected(file.error());
+    }
+
+    MidiReader reader;
+    reader.m_file = std::move(*file);
+    reader.m_bytes = reader.m_file.bytes();
+    if (auto result = reader.readChunks(); !result) {
+        return std::unexpected(result.error());
+    }
+    return reader;
+}
+
+Result<MidiReader> MidiReader::parse(std::span<const uint8_t> bytes) {
+    MidiReader reader;
+    reader.m_bytes = bytes;
+    if (auto result = reader.readChunks(); !result) {
+        return std::unexpected(result.error());
+    }
+    return reader;
+}
+
+Result<void> MidiReader::readChunks() {
+    const uint8_t* pos = m_bytes.data();
+    const uint8_t* end = pos + m_bytes.size();
+
+    // Header chunk
+    if (m_bytes.size() < 14 || std::memcmp(pos, "MThd", 4) != 0) {
+        return std::unexpected(ErrorCode::InvalidFileFormat);
+    }
+    uint32_t headerLength = readBigEndian32(pos + 4);
+    if (headerLength < 6 || headerLength > m_bytes.size() - 8) {
+        return std::unexpected(ErrorCode::InvalidFileFormat);
+    }
+    m_format = readBigEndian16(pos + 8);
+    uint16_t declaredTracks = readBigEndian16(pos + 10);
+    m_ticksPerQuarter = readBigEndian16(pos + 12);
+    pos += 8 + headerLength;
+
+    // Track chunks; unknown chunk types are skipped as the spec requires
+    m_tracks.clear();
+    m_tracks.reserve(declaredTracks);
+    while (end - pos >= 8) {
+        uint32_t length = readBigEndian32(pos + 4);
+        if (length > static_cast<size_t>(end - pos - 8)) {
+            return std::unexpected(ErrorCode::InvalidFileFormat);
+        }
+        if (std::memcmp(pos, "MTrk", 4) == 0) {
+            m_tracks.emplace_back(std::span<const uint8_t>(pos + 8, length));
+        }
+        pos += 8 + length;
+    }
+
+    return {};
+}
+
+std::vector<MidiNote> MidiReader::extractNotes(const MidiTrackView& track) {
+    std::vector<MidiNote> notes;
+
+    // Start tick and velocity of the sounding note per channel and key
+    std::array<uint32_t, 16 * 128> startTicks{};
+    std::array<uint8_t, 16 * 128> velocities{};
+
+    for (const auto& event : track) {
+        uint8_t type = event.status & 0xF0;
+        if (type != 0x90 && type != 0x80) continue;
+
+        uint8_t channel = event.status & 0x0F;
+        uint8_t note = event.data[0] & 0x7F;
+        uint8_t velocity = event.data[1] & 0x7F;
+        size_t key = channel * 128u + note;
+
+        if (velocities[key] != 0) {
+            // A note-off, or a re-strike of a sounding note, ends the previous note
+            notes.push_back({channel, note, velocities[key], startTicks[key], event.tick - startTicks[key]});
+            velocities[key] = 0;
+        }
+        if (type == 0x90 && velocity > 0) {
+            startTicks[key] = event.tick;
+            velocities[key] = velocity;
+        }
+    }
+
+    std::ranges::stable_sort(notes, {}, &MidiNote::startTick);
+    return notes;
+}
+
+Result<GrooveTemplate> MidiReader::extractGroove(uint16_t ticksPerQuarter, int beatsPerBar) const {
+    // SMPTE time division has no beat grid to map onto
+    if (m_ticksPerQuarter == 0 || (m_ticksPerQuarter & 0x8000) || beatsPerBar <= 0) {
+        return std::unexpected(ErrorCode::InvalidFileFormat);
+    }
+
+    for (const auto& track : m_tracks) {
+        auto notes = extractNotes(track);
+        if (notes.empty()) continue;
+
+        GrooveTemplate groove;
+        uint64_t lastTick = 0;
+        for (auto& note : notes) {
+            note.startTick = static_cast<uint32_t>(uint64_t(note.startTick) * ticksPerQuarter / m_ticksPerQuarter);
+            note.duration = std::max<uint32_t>(1, static_cast<uint32_t>(uint64_t(note.duration) * ticksPerQuarter / m_ticksPerQuarter));
+            lastTick = std::max<uint64_t>(lastTick, note.startTick + 1);
+        }
+
+        uint64_t barTicks = uint64_t(beatsPerBar) * ticksPerQuarter;
+        groove.lengthTicks = static_cast<uint32_t>((lastTick + barTicks - 1) / barTicks * barTicks);
+        groove.notes = std::move(notes);
+        return groove;
+    }
+
+    return std::unexpected(ErrorCode::InvalidFileFormat);
+}
+
+} // namespace IndustrialMusic
\ No newline at end of file
@@ -0,0 +1,214 @@
+#include "MidiScheduler.h"
+#include <libremidi/libremidi.hpp>
+#include <bit>
+
+namespace IndustrialMusic {
+
+namespace {
+
+// Min-heap on time; equal times dispatch in the order they were queued
+struct LaterFirst {
+    template<typename T>
+    bool operator()(const T& a, const T& b) const {
+        return a.time != b.time ? a.time > b.time : a.order > b.order;
+    }
+};
+
+constexpr uint8_t ALL_NOTES_OFF = 123;
+
+} // namespace
+
+LibremidiSink::~LibremidiSink() = default;
+
+std::vector<std::string> LibremidiSink::availableOutputs() {
+    std::vector<std::string> names;
+    libremidi::observer observer;
+    for (const auto& port : observer.get_output_ports()) {
+        names.push_back(port.display_name);
+    }
+    return names;
+}
+
+Result<std::unique_ptr<LibremidiSink>> LibremidiSink::open(size_t index) {
+    libremidi::observer observer;
+    auto ports = observer.get_output_ports();
+    if (index >= ports.size()) {
+        return std::unexpected(ErrorCode::MidiDeviceNotFound);
+    }
+
+    std::unique_ptr<LibremidiSink> sink(new LibremidiSink());
+    sink->m_out = std::make_unique<libremidi::midi_out>();
+    sink->m_out->open_port(ports[index]);
+    if (!sink->m_out->is_port_open()) {
+        return std::unexpected(ErrorCode::MidiDeviceNotFound);
+    }
+    return sink;
+}
+
+void LibremidiSink::send(std::span<const uint8_t> message) {
+    m_out->send_message(message.data(), message.size());
+}
+
+LoopbackSink::LoopbackSink(size_t capacity) {
+    m_received.reserve(capacity);
+}
+
+void LoopbackSink::send(std::span<const uint8_t> message) {
+    auto now = Clock::now();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_count;
+    if (m_received.size() < m_received.capacity()) {
+        Received received{{}, now};
+        received.message.size = static_cast<uint8_t>(std::min(message.size(), received.message.bytes.size()));
+        std::copy_n(message.begin(), received.message.size, received.message.bytes.begin());
+        m_received.push_back(received);
+    }
+}
+
+std::vector<LoopbackSink::Received> LoopbackSink::received() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_received;
+}
+
+size_t LoopbackSink::count() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_count;
+}
+
+void LoopbackSink::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_received.clear();
+    m_count = 0;
+}
+
+MidiScheduler::MidiScheduler(std::unique_ptr<MidiSink> sink)
+    : m_sink(std::move(sink)) {
+    m_pending.reserve(LOOKAHEAD_CAPACITY);
+    m_thread = std::thread(&MidiScheduler::run, this);
+}
+
+MidiScheduler::~MidiScheduler() {
+    m_stopping.store(true, std::memory_order_release);
+    m_wake.fetch_add(1, std::memory_order_release);
+    m_wake.notify_one();
+
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+bool MidiScheduler::schedule(const MidiMessage& message, Clock::time_point time) {
+    if (!m_queue.tryPush({time, message})) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    m_wake.fetch_add(1, std::memory_order_release);
+    m_wake.notify_one();
+    return true;
+}
+
+void MidiScheduler::run() {
+    while (true) {
+        uint32_t wake = m_wake.load(std::memory_order_acquire);
+        if (m_stopping.load(std::memory_order_acquire)) break;
+
+        drainQueue();
+
+        while (!m_pending.empty() && m_pending.front().time <= Clock::now()) {
+            std::pop_heap(m_pending.begin(), m_pending.end(), LaterFirst{});
+            dispatch(m_pending.back());
+            m_pending.pop_back();
+        }
+
+        if (m_pending.empty()) {
+            // Nothing due: block until a producer pushes or we are stopped
+            m_wake.wait(wake, std::memory_order_acquire);
+            continue;
+        }
+
+        auto remaining = m_pending.front().time - Clock::now();
+        if (remaining > SPIN_WINDOW) {
+            std::this_thread::sleep_for(std::min<Clock::duration>(remaining - SPIN_WINDOW, POLL_INTERVAL));
+        } else {
+            auto due = m_pending.front().time;
+            while (Clock::now() < due && m_wake.load(std::memory_order_acquire) == wake) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    // Discard what was still pending and silence anything left sounding
+    m_pending.clear();
+    for (uint8_t channel = 0; channel < 16; ++channel) {
+        if (m_activeChannels & (1u << channel)) {
+            m_sink->send(MidiMessage::controlChange(channel, ALL_NOTES_OFF, 0).view());
+        }
+    }
+}
+
+void MidiScheduler::drainQueue() {
+    // Leave messages in the queue while the lookahead is full; they are taken
+    // once earlier ones have been dispatched
+    ScheduledMessage scheduled;
+    while (m_pending.size() < LOOKAHEAD_CAPACITY && m_queue.tryPop(scheduled)) {
+        m_pending.push_back({scheduled.time, m_nextOrder++, scheduled.message});
+        std::push_heap(m_pending.begin(), m_pending.end(), LaterFirst{});
+    }
+}
+
+void MidiScheduler::dispatch(const PendingMessage& pending) {
+    m_sink->send(pending.message.view());
+    recordJitter(Clock::now() - pending.time);
+
+    uint8_t status = pending.message.bytes[0];
+    if ((status & 0xF0) == 0x90) {
+        m_activeChannels |= static_cast<uint16_t>(1u << (status & 0x0F));
+    }
+}
+
+void MidiScheduler::recordJitter(Clock::duration lateness) {
+    auto ns = static_cast<uint64_t>(std::max<int64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(lateness).count(), 0));
+
+    // Bucket i holds lateness below 2^i ns
+    size_t bucket = std::min<size_t>(std::bit_width(ns), HISTOGRAM_BUCKETS - 1);
+    m_histogram[bucket].fetch_add(1, std::memory_order_relaxed);
+    m_jitterSumNs.fetch_add(ns, std::memory_order_relaxed);
+    if (ns > m_jitterMaxNs.load(std::memory_order_relaxed)) {
+        m_jitterMaxNs.store(ns, std::memory_order_relaxed);
+    }
+    m_dispatched.fetch_add(1, std::memory_order_relaxed);
+}
+
+MidiScheduler::JitterStats MidiScheduler::getJitterStats() const {
+    JitterStats stats;
+    stats.messages = m_dispatched.load(std::memory_order_relaxed);
+    stats.dropped = m_dropped.load(std::memory_order_relaxed);
+    stats.max = std::chrono::nanoseconds(m_jitterMaxNs.load(std::memory_order_relaxed));
+    if (stats.messages == 0) return stats;
+
+    stats.mean = std::chrono::nanoseconds(m_jitterSumNs.load(std::memory_order_relaxed) / stats.messages);
+
+    uint64_t seen = 0;
+    uint64_t target = stats.messages - stats.messages / 100;
+    for (size_t bucket = 0; bucket < HISTOGRAM_BUCKETS; ++bucket) {
+        seen += m_histogram[bucket].load(std::memory_order_relaxed);
+        if (seen >= target) {
+            stats.p99 = std::min(std::chrono::nanoseconds(int64_t{1} << bucket), stats.max);
+            break;
+        }
+    }
+    return stats;
+}
+
+void MidiScheduler::resetJitterStats() {
+    m_dispatched.store(0, std::memory_order_relaxed);
+    m_dropped.store(0, std::memory_order_relaxed);
+    m_jitterSumNs.store(0, std::memory_order_relaxed);
+    m_jitterMaxNs.store(0, std::memory_order_relaxed);
+    for (auto& count : m_histogram) {
+        count.store(0, std::memory_order_relaxed);
+    }
+}
+
+} // namespace IndustrialMusic
\ No newline at end of file
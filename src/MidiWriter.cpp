@@ -0,0 +1,185 @@
+#include "MidiWriter.h"
+#include <cstring>
+
+namespace IndustrialMusic {
+
+void sortEventsByTick(std::vector<MidiEvent>& events, std::vector<MidiEvent>& scratch) {
+    // Per-section lists are short and mostly in order already, where a
+    // stable insertion sort beats setting up the radix histograms
+    constexpr size_t INSERTION_SORT_LIMIT = 64;
+    if (events.size() <= INSERTION_SORT_LIMIT) {
+        for (size_t i = 1; i < events.size(); ++i) {
+            MidiEvent event = events[i];
+            size_t j = i;
+            for (; j > 0 && events[j - 1].tick > event.tick; --j) {
+                events[j] = events[j - 1];
+            }
+            events[j] = event;
+        }
+        return;
+    }
+    
+    // Histogram every byte of the tick in one scan
+    std::array<std::array<uint32_t, 256>, 4> counts{};
+    for (const auto& event : events) {
+        ++counts[0][event.tick & 0xFF];
+        ++counts[1][(event.tick >> 8) & 0xFF];
+        ++counts[2][(event.tick >> 16) & 0xFF];
+        ++counts[3][event.tick >> 24];
+    }
+    
+    scratch.resize(events.size());
+    for (int pass = 0; pass < 4; ++pass) {
+        auto& count = counts[pass];
+        
+        // Skip bytes that are the same for every event
+        if (count[events.front().tick >> (pass * 8) & 0xFF] == events.size()) continue;
+        
+        uint32_t offset = 0;
+        for (auto& c : count) {
+            uint32_t n = c;
+            c = offset;
+            offset += n;
+        }
+        for (const auto& event : events) {
+            scratch[count[(event.tick >> (pass * 8)) & 0xFF]++] = event;
+        }
+        events.swap(scratch);
+    }
+}
+
+MidiWriter::MidiWriter(size_t expectedSize) {
+    m_data.resize(expectedSize);
+}
+
+void MidiWriter::writeHeader(uint16_t format, uint16_t trackCount, uint16_t ticksPerQuarter) {
+    const uint8_t header[] = {
+        'M', 'T', 'h', 'd',
+        0x00, 0x00, 0x00, 0x06, // Header length
+        static_cast<uint8_t>(format >> 8), static_cast<uint8_t>(format & 0xFF),
+        static_cast<uint8_t>(trackCount >> 8), static_cast<uint8_t>(trackCount & 0xFF),
+        static_cast<uint8_t>(ticksPerQuarter >> 8), static_cast<uint8_t>(ticksPerQuarter & 0xFF)
+    };
+    writeBytes(header);
+}
+
+void MidiWriter::beginTrack() {
+    m_trackStart = m_size;
+    m_trackTick = 0;
+    m_runningStatus = 0;
+    const uint8_t header[] = {'M', 'T', 'r', 'k', 0x00, 0x00, 0x00, 0x00}; // Length placeholder
+    writeBytes(header);
+}
+
+void MidiWriter::endTrack() {
+    // End of track
+    const uint8_t endOfTrack[] = {0x00, 0xFF, 0x2F, 0x00};
+    writeBytes(endOfTrack);
+
+    uint32_t length = static_cast<uint32_t>(m_size - m_trackStart - 8);
+    uint8_t* lengthField = m_data.data() + m_trackStart + 4;
+    lengthField[0] = (length >> 24) & 0xFF;
+    lengthField[1] = (length >> 16) & 0xFF;
+    lengthField[2] = (length >> 8) & 0xFF;
+    lengthField[3] = length & 0xFF;
+}
+
+void MidiWriter::writeMetaEvent(uint32_t deltaTicks, uint8_t type, std::span<const uint8_t> data) {
+    uint8_t* out = grow(4 + 2 + 4 + data.size());
+    out = encodeVariableLength(out, deltaTicks);
+    *out++ = 0xFF;
+    *out++ = type;
+    out = encodeVariableLength(out, static_cast<uint32_t>(data.size()));
+    if (!data.empty()) {
+        std::memcpy(out, data.data(), data.size());
+    }
+    m_size = static_cast<size_t>(out + data.size() - m_data.data());
+    m_trackTick += deltaTicks;
+    
+    // Meta events cancel running status
+    m_runningStatus = 0;
+}
+
+void MidiWriter::writeTextEvent(uint32_t deltaTicks, uint8_t type, std::string_view text) {
+    writeMetaEvent(deltaTicks, type, {reinterpret_cast<const uint8_t*>(text.data()), text.size()});
+}
+
+void MidiWriter::writeEvents(std::span<const MidiEvent> events) {
+    for (const auto& event : events) {
+        writeEvent(event);
+    }
+}
+
+void MidiWriter::writeBytes(std::span<const uint8_t> bytes) {
+    if (bytes.empty()) return;
+    std::memcpy(grow(bytes.size()), bytes.data(), bytes.size());
+    m_size += bytes.size();
+}
+
+std::vector<uint8_t> MidiWriter::release() {
+    m_data.resize(m_size);
+    m_size = 0;
+    m_trackStart = 0;
+    m_trackTick = 0;
+    m_runningStatus = 0;
+    return std::move(m_data);
+}
+
+MidiFileSink::MidiFileSink(const std::filesystem::path& filepath, size_t bufferSize)
+    : m_file(filepath, std::ios::binary), m_buffer(std::max<size_t>(bufferSize, 64)) {
+}
+
+void MidiFileSink::write(std::span<const uint8_t> bytes) {
+    if (m_used + bytes.size() > m_buffer.size()) {
+        flush();
+    }
+    
+    // Large writes bypass the buffer
+    if (bytes.size() >= m_buffer.size()) {
+        m_file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    } else if (!bytes.empty()) {
+        std::memcpy(m_buffer.data() + m_used, bytes.data(), bytes.size());
+        m_used += bytes.size();
+    }
+    m_written += bytes.size();
+}
+
+void MidiFileSink::beginTrack() {
+    m_trackStart = m_written;
+    const uint8_t header[] = {'M', 'T', 'r', 'k', 0x00, 0x00, 0x00, 0x00}; // Length placeholder
+    write(header);
+}
+
+void MidiFileSink::endTrack() {
+    const uint8_t endOfTrack[] = {0x00, 0xFF, 0x2F, 0x00};
+    write(endOfTrack);
+    flush();
+    
+    uint32_t length = static_cast<uint32_t>(m_written - m_trackStart - 8);
+    const char lengthField[] = {
+        static_cast<char>((length >> 24) & 0xFF),
+        static_cast<char>((length >> 16) & 0xFF),
+        static_cast<char>((length >> 8) & 0xFF),
+        static_cast<char>(length & 0xFF)
+    };
+    m_file.seekp(static_cast<std::streamoff>(m_trackStart + 4));
+    m_file.write(lengthField, sizeof(lengthField));
+    m_file.seekp(static_cast<std::streamoff>(m_written));
+}
+
+Result<void> MidiFileSink::close() {
+    flush();
+    m_file.close();
+    if (m_file.fail()) {
+        return std::unexpected(ErrorCode::FileWriteFailed);
+    }
+    return {};
+}
+
+void MidiFileSink::flush() {
+    if (m_used == 0) return;
+    m_file.write(reinterpret_cast<const char*>(m_buffer.data()), static_cast<std::streamsize>(m_used));
+    m_used = 0;
+}
+
+} // namespace IndustrialMusic
\ No newline at end of file
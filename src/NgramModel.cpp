@@ -0,0 +1,395 @@
+#include "NgramModel.h"
+#include "AliasTable.h"
+#include "Hash.h"
+#include <cctype>
+#include <numeric>
+
+namespace IndustrialMusic {
+
+namespace {
+
+using Token = NgramModel::Token;
+constexpr size_t CONTEXT_TOKENS = NgramModel::MAX_ORDER - 1;
+using Context = std::array<Token, CONTEXT_TOKENS>;
+
+struct FileHeader {
+    char magic[4];
+    uint16_t version;
+    uint16_t headerSize;
+    uint32_t order;
+    uint32_t contextCount;
+    TableHeader vocabulary;    // StringRef per token
+    TableHeader displacements; // uint32_t per bucket
+    TableHeader slots;         // ContextRecord per slot
+    TableHeader successors;    // SuccessorRecord, grouped by context
+    uint32_t stringsOffset;
+    uint32_t stringsSize;
+};
+
+// Unused context tokens (orders below MAX_ORDER) are zero; a slot with no
+// successors is empty
+struct ContextRecord {
+    Token tokens[CONTEXT_TOKENS];
+    uint32_t firstSuccessor;
+    uint32_t successorCount;
+};
+
+// One column of a context's alias table: the column's own token is kept
+// when the low 16 random bits are below threshold, otherwise the token of
+// column `alias` is used
+struct SuccessorRecord {
+    Token token;
+    uint16_t threshold;
+    uint16_t alias;
+};
+
+static_assert(sizeof(FileHeader) == 72);
+static_assert(sizeof(ContextRecord) == 20);
+static_assert(sizeof(SuccessorRecord) == 8);
+
+constexpr char MAGIC[4] = {'I', 'M', 'L', 'M'};
+
+constexpr size_t MAX_SUCCESSORS = UINT16_MAX;
+constexpr uint32_t QUANTIZATION = 1u << 16;
+
+// Average contexts per perfect-hash bucket, and slots per context
+constexpr size_t BUCKET_SIZE = 4;
+constexpr double SLOT_LOAD = 0.9;
+
+uint64_t contextHash(const Context& context) {
+    uint64_t hash = mix64(context[0] ^ (static_cast<uint64_t>(context[1]) << 32));
+    return mix64(hash ^ context[2] ^ GOLDEN_GAMMA);
+}
+
+// Maps 32 random bits onto [0, range) without a division
+size_t scaleTo(uint64_t bits32, size_t range) {
+    return static_cast<size_t>((bits32 & 0xFFFFFFFFull) * range >> 32);
+}
+
+size_t bucketOf(uint64_t hash, size_t buckets) {
+    return scaleTo(hash, buckets);
+}
+
+size_t slotOf(uint64_t hash, uint32_t displacement, size_t slots) {
+    return scaleTo(mix64(hash + displacement * GOLDEN_GAMMA) >> 32, slots);
+}
+
+// Lowercased words of one line; bytes above 0x7F count as letters so UTF-8 survives
+template<typename Visit>
+void forEachWord(std::string_view line, Visit&& visit) {
+    std::string word;
+    auto flush = [&] {
+        if (!word.empty()) {
+            visit(std::string_view(word));
+            word.clear();
+        }
+    };
+    for (char c : line) {
+        auto byte = static_cast<unsigned char>(c);
+        if (std::isalnum(byte) || c == '\'' || byte > 0x7F) {
+            word += static_cast<char>(byte <= 0x7F ? std::tolower(byte) : byte);
+        } else {
+            flush();
+        }
+    }
+    flush();
+}
+
+struct Gram {
+    Context context;
+    Token next;
+
+    auto operator<=>(const Gram&) const = default;
+};
+
+// Walker alias table over successor counts, quantized to 16 bits
+void appendAliasTable(std::vector<SuccessorRecord>& out, std::span<const std::pair<Token, uint32_t>> counts) {
+    size_t first = out.size();
+    for (const auto& [token, count] : counts) {
+        out.push_back({token, 0, 0});
+    }
+    buildAliasTable(counts | std::views::values, [&](size_t column, double probability, size_t alias) {
+        auto threshold = std::clamp(std::lround(probability * QUANTIZATION), 0l, static_cast<long>(QUANTIZATION - 1));
+        out[first + column].threshold = static_cast<uint16_t>(threshold);
+        out[first + column].alias = static_cast<uint16_t>(alias);
+    });
+}
+
+// Hash-and-displace: buckets are placed largest first, each trying
+// displacements until all its contexts land in free slots
+bool buildPerfectHash(const std::vector<Context>& contexts, size_t slotCount,
+                      std::vector<uint32_t>& displacements, std::vector<uint32_t>& slotOfContext) {
+    size_t bucketCount = contexts.size() / BUCKET_SIZE + 1;
+    std::vector<uint64_t> hashes(contexts.size());
+    std::vector<std::vector<uint32_t>> buckets(bucketCount);
+    for (size_t i = 0; i < contexts.size(); ++i) {
+        hashes[i] = contextHash(contexts[i]);
+        buckets[bucketOf(hashes[i], bucketCount)].push_back(static_cast<uint32_t>(i));
+    }
+
+    std::vector<uint32_t> order(bucketCount);
+    std::iota(order.begin(), order.end(), 0u);
+    std::ranges::stable_sort(order, std::greater<>{}, [&](uint32_t bucket) { return buckets[bucket].size(); });
+
+    constexpr uint32_t MAX_DISPLACEMENT = 1u << 20;
+    displacements.assign(bucketCount, 0);
+    slotOfContext.assign(contexts.size(), 0);
+    std::vector<bool> used(slotCount, false);
+    std::vector<size_t> placed;
+
+    for (uint32_t bucket : order) {
+        const auto& members = buckets[bucket];
+        if (members.empty()) break;
+
+        bool found = false;
+        for (uint32_t displacement = 0; displacement < MAX_DISPLACEMENT && !found; ++displacement) {
+            placed.clear();
+            found = true;
+            for (uint32_t context : members) {
+                size_t slot = slotOf(hashes[context], displacement, slotCount);
+                if (used[slot] || std::ranges::find(placed, slot) != placed.end()) {
+                    found = false;
+                    break;
+                }
+                placed.push_back(slot);
+            }
+            if (found) {
+                displacements[bucket] = displacement;
+                for (size_t i = 0; i < members.size(); ++i) {
+                    used[placed[i]] = true;
+                    slotOfContext[members[i]] = static_cast<uint32_t>(placed[i]);
+                }
+            }
+        }
+        if (!found) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+Result<std::vector<uint8_t>> NgramModel::train(std::string_view corpus, int order) {
+    if (order < MIN_ORDER || order > MAX_ORDER) {
+        return std::unexpected(ErrorCode::InvalidParameter);
+    }
+    auto contextLength = static_cast<size_t>(order - 1);
+
+    // Vocabulary, with token 0 reserved for line boundaries
+    std::vector<std::string> words(1);
+    std::unordered_map<std::string, Token> ids;
+    std::vector<Gram> grams;
+    std::vector<Token> line;
+
+    for (size_t start = 0; start < corpus.size();) {
+        size_t end = std::min(corpus.find('\n', start), corpus.size());
+        line.clear();
+        forEachWord(corpus.substr(start, end - start), [&](std::string_view word) {
+            auto [it, inserted] = ids.try_emplace(std::string(word), static_cast<Token>(words.size()));
+            if (inserted) {
+                words.emplace_back(word);
+            }
+            line.push_back(it->second);
+        });
+        start = end + 1;
+        if (line.empty()) continue;
+
+        line.push_back(BOUNDARY);
+        Context context{};
+        for (Token token : line) {
+            grams.push_back({context, token});
+            std::shift_left(context.begin(), context.begin() + static_cast<ptrdiff_t>(contextLength), 1);
+            context[contextLength - 1] = token;
+        }
+    }
+    if (words.size() == 1) {
+        return std::unexpected(ErrorCode::InvalidParameter);
+    }
+
+    // Count each (context, next) run and build the contexts' alias tables
+    std::ranges::sort(grams);
+    std::vector<Context> contexts;
+    std::vector<std::pair<uint32_t, uint32_t>> successorRanges; // first, count
+    std::vector<SuccessorRecord> successors;
+    std::vector<std::pair<Token, uint32_t>> counts;
+
+    for (size_t i = 0; i < grams.size();) {
+        const Context& context = grams[i].context;
+        counts.clear();
+        while (i < grams.size() && grams[i].context == context) {
+            Token next = grams[i].next;
+            uint32_t count = 0;
+            for (; i < grams.size() && grams[i].context == context && grams[i].next == next; ++i) {
+                ++count;
+            }
+            counts.emplace_back(next, count);
+        }
+
+        std::ranges::sort(counts, [](const auto& a, const auto& b) {
+            return a.second != b.second ? a.second > b.second : a.first < b.first;
+        });
+        counts.resize(std::min(counts.size(), MAX_SUCCESSORS));
+
+        contexts.push_back(context);
+        successorRanges.emplace_back(static_cast<uint32_t>(successors.size()), static_cast<uint32_t>(counts.size()));
+        appendAliasTable(successors, counts);
+    }
+
+    std::vector<uint32_t> displacements;
+    std::vector<uint32_t> slotOfContext;
+    auto slotCount = static_cast<size_t>(contexts.size() / SLOT_LOAD) + 1;
+    while (!buildPerfectHash(contexts, slotCount, displacements, slotOfContext)) {
+        slotCount += slotCount / 8 + 1;
+    }
+
+    std::vector<ContextRecord> slots(slotCount, ContextRecord{});
+    for (size_t i = 0; i < contexts.size(); ++i) {
+        ContextRecord& record = slots[slotOfContext[i]];
+        std::ranges::copy(contexts[i], record.tokens);
+        record.firstSuccessor = successorRanges[i].first;
+        record.successorCount = successorRanges[i].second;
+    }
+
+    StringTableBuilder strings;
+    std::vector<uint8_t> out(sizeof(FileHeader), 0);
+
+    FileHeader header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = FORMAT_VERSION;
+    header.headerSize = sizeof(FileHeader);
+    header.order = static_cast<uint32_t>(order);
+    header.contextCount = static_cast<uint32_t>(contexts.size());
+
+    header.vocabulary = {beginTable(out), static_cast<uint32_t>(words.size()), sizeof(StringRef)};
+    for (const auto& word : words) {
+        appendRecord(out, strings.add(word));
+    }
+
+    header.displacements = {beginTable(out), static_cast<uint32_t>(displacements.size()), sizeof(uint32_t)};
+    for (uint32_t displacement : displacements) {
+        appendRecord(out, displacement);
+    }
+
+    header.slots = {beginTable(out), static_cast<uint32_t>(slots.size()), sizeof(ContextRecord)};
+    for (const auto& record : slots) {
+        appendRecord(out, record);
+    }
+
+    header.successors = {beginTable(out), static_cast<uint32_t>(successors.size()), sizeof(SuccessorRecord)};
+    for (const auto& record : successors) {
+        appendRecord(out, record);
+    }
+
+    header.stringsOffset = beginTable(out);
+    header.stringsSize = static_cast<uint32_t>(strings.bytes().size());
+    out.insert(out.end(), strings.bytes().begin(), strings.bytes().end());
+
+    // Offsets are 32-bit
+    if (out.size() > UINT32_MAX) {
+        return std::unexpected(ErrorCode::InvalidParameter);
+    }
+    std::memcpy(out.data(), &header, sizeof(header));
+    return out;
+}
+
+Result<NgramModel> NgramModel::open(const std::filesystem::path& filepath) {
+    auto file = MappedFile::open(filepath);
+    if (!file) {
+        return std::unexpected(file.error());
+    }
+
+    NgramModel model;
+    model.m_file = std::move(*file);
+    model.m_bytes = model.m_file.bytes();
+    if (auto result = model.readHeader(); !result) {
+        return std::unexpected(result.error());
+    }
+    return model;
+}
+
+Result<NgramModel> NgramModel::parse(std::span<const uint8_t> bytes) {
+    NgramModel model;
+    model.m_bytes = bytes;
+    if (auto result = model.readHeader(); !result) {
+        return std::unexpected(result.error());
+    }
+    return model;
+}
+
+Result<void> NgramModel::readHeader() {
+    if (m_bytes.size() < sizeof(FileHeader) || std::memcmp(m_bytes.data(), MAGIC, sizeof(MAGIC)) != 0) {
+        return std::unexpected(ErrorCode::InvalidFileFormat);
+    }
+
+    auto header = readRecord<FileHeader>(m_bytes.data());
+    if (header.version == 0 || header.version > FORMAT_VERSION ||
+        header.headerSize < sizeof(FileHeader) || header.headerSize > m_bytes.size() ||
+        header.order < MIN_ORDER || header.order > MAX_ORDER) {
+        return std::unexpected(ErrorCode::InvalidFileFormat);
+    }
+    m_order = static_cast<int>(header.order);
+    m_contextCount = header.contextCount;
+
+    auto mapTable = [&](const TableHeader& table, size_t recordSize, RecordTable& out) {
+        return RecordTable::map(m_bytes, table, header.headerSize, recordSize, out);
+    };
+    if (!mapTable(header.vocabulary, sizeof(StringRef), m_vocabulary) ||
+        !mapTable(header.displacements, sizeof(uint32_t), m_displacements) ||
+        !mapTable(header.slots, sizeof(ContextRecord), m_slots) ||
+        !mapTable(header.successors, sizeof(SuccessorRecord), m_successors)) {
+        return std::unexpected(ErrorCode::InvalidFileFormat);
+    }
+
+    if (static_cast<uint64_t>(header.stringsOffset) + header.stringsSize > m_bytes.size()) {
+        return std::unexpected(ErrorCode::InvalidFileFormat);
+    }
+    m_strings = m_bytes.subspan(header.stringsOffset, header.stringsSize);
+    return {};
+}
+
+std::string_view NgramModel::word(Token token) const {
+    if (token >= m_vocabulary.count) {
+        return {};
+    }
+    auto ref = readRecord<StringRef>(m_vocabulary.record(token));
+    if (static_cast<uint64_t>(ref.offset) + ref.length > m_strings.size()) {
+        return {};
+    }
+    return {reinterpret_cast<const char*>(m_strings.data()) + ref.offset, ref.length};
+}
+
+std::vector<WordProsody> NgramModel::analyzeVocabulary() const {
+    std::vector<WordProsody> prosody(m_vocabulary.count);
+    for (Token token = 1; token < m_vocabulary.count; ++token) {
+        prosody[token] = analyzeWord(word(token));
+    }
+    return prosody;
+}
+
+NgramModel::Token NgramModel::next(std::span<const Token> history, uint64_t random) const {
+    if (m_displacements.count == 0 || m_slots.count == 0) {
+        return BOUNDARY;
+    }
+
+    Context context{};
+    auto length = std::min(history.size(), static_cast<size_t>(m_order - 1));
+    std::ranges::copy(history.last(length), context.begin());
+
+    uint64_t hash = contextHash(context);
+    auto displacement = readRecord<uint32_t>(m_displacements.record(bucketOf(hash, m_displacements.count)));
+    auto record = readRecord<ContextRecord>(m_slots.record(slotOf(hash, displacement, m_slots.count)));
+
+    // Checks are per lookup, since open() does not scan the tables
+    if (record.successorCount == 0 || !std::ranges::equal(record.tokens, context) ||
+        static_cast<uint64_t>(record.firstSuccessor) + record.successorCount > m_successors.count) {
+        return BOUNDARY;
+    }
+
+    size_t column = scaleTo(random >> 32, record.successorCount);
+    auto successor = readRecord<SuccessorRecord>(m_successors.record(record.firstSuccessor + column));
+    if ((random & 0xFFFF) < successor.threshold || successor.alias >= record.successorCount) {
+        return successor.token;
+    }
+    return readRecord<SuccessorRecord>(m_successors.record(record.firstSuccessor + successor.alias)).token;
+}
+
+} // namespace IndustrialMusic
\ No newline at end of file
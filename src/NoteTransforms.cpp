@@ -0,0 +1,232 @@
+#include "NoteTransforms.h"
+#include "PatternEngine.h"
+#include "Hash.h"
+#include <bit>
+
+namespace IndustrialMusic {
+
+namespace {
+
+// Integer hash with good avalanche; cheap enough to run per note
+constexpr uint32_t mixBits(uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x7FEB352Du;
+    x ^= x >> 15;
+    x *= 0x846CA68Bu;
+    x ^= x >> 16;
+    return x;
+}
+
+// Uniform integer in [-range, range] from a hash, without a division
+constexpr int32_t signedOffset(uint32_t hash, uint32_t range) {
+    uint32_t span = 2 * range + 1;
+    return static_cast<int32_t>((static_cast<uint64_t>(hash) * span) >> 32) - static_cast<int32_t>(range);
+}
+
+// Division by a divisor fixed for a whole pass, as a multiply and two
+// shifts (Granlund and Montgomery); exact for every 32-bit dividend
+class Divider {
+public:
+    explicit constexpr Divider(uint32_t divisor) {
+        // ceil(log2(divisor)); 0 for 1
+        const uint32_t log = static_cast<uint32_t>(std::bit_width(divisor - 1));
+        m_multiplier = static_cast<uint32_t>((((uint64_t{1} << log) - divisor) << 32) / divisor + 1);
+        m_shift1 = std::min(log, 1u);
+        m_shift2 = log > 0 ? log - 1 : 0;
+    }
+
+    [[nodiscard]] constexpr uint32_t divide(uint32_t value) const {
+        uint32_t high = static_cast<uint32_t>((static_cast<uint64_t>(value) * m_multiplier) >> 32);
+        return (high + ((value - high) >> m_shift1)) >> m_shift2;
+    }
+
+private:
+    uint32_t m_multiplier = 0;
+    uint32_t m_shift1 = 0;
+    uint32_t m_shift2 = 0;
+};
+
+static_assert(Divider(1).divide(UINT32_MAX) == UINT32_MAX);
+static_assert(Divider(120).divide(UINT32_MAX) == UINT32_MAX / 120);
+static_assert(Divider(0x80000001u).divide(UINT32_MAX) == 1);
+
+// Move starts and ends through the same monotonic time map, so notes keep
+// their relative order and notes that did not overlap still do not
+template<typename TimeMap>
+void remapTimes(NoteStream& notes, TimeMap map) {
+    uint32_t* ticks = notes.ticks.data();
+    uint32_t* durations = notes.durations.data();
+    const size_t count = notes.size();
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t start = map(ticks[i]);
+        uint32_t end = map(ticks[i] + durations[i]);
+        ticks[i] = start;
+        durations[i] = std::max(end - start, 1u);
+    }
+}
+
+void quantize(NoteStream& notes, const Quantize& step) {
+    if (step.grid == 0) return;
+
+    // Fixed-point weight keeps the loop in integers
+    const int64_t weight = std::lround(std::clamp(step.strength, 0.0f, 1.0f) * 256.0f);
+    const uint32_t grid = step.grid;
+    const Divider byGrid(grid);
+    remapTimes(notes, [=](uint32_t tick) {
+        uint32_t nearest = byGrid.divide(tick + grid / 2) * grid;
+        return static_cast<uint32_t>(tick + (((static_cast<int64_t>(nearest) - tick) * weight) >> 8));
+    });
+}
+
+void swing(NoteStream& notes, const Swing& step) {
+    if (step.grid == 0) return;
+
+    const uint32_t grid = step.grid;
+    const uint32_t cell = grid * 2;
+    const uint32_t offset = std::min(static_cast<uint32_t>(std::lround(std::clamp(step.amount, 0.0f, 1.0f) * grid)), grid - 1);
+    if (offset == 0) return;
+
+    // The first subdivision stretches and the second shrinks by the same amount
+    const Divider byCell(cell);
+    const Divider byGrid(grid);
+    remapTimes(notes, [=](uint32_t tick) {
+        uint32_t base = byCell.divide(tick) * cell;
+        uint32_t position = tick - base;
+        uint32_t early = byGrid.divide(position * (grid + offset));
+        uint32_t late = grid + offset + byGrid.divide((position - grid) * (grid - offset));
+        return base + (position < grid ? early : late);
+    });
+}
+
+void humanize(NoteStream& notes, const Humanize& step, uint32_t seed) {
+    const size_t count = notes.size();
+
+    if (step.timing > 0) {
+        uint32_t* ticks = notes.ticks.data();
+        for (size_t i = 0; i < count; ++i) {
+            int64_t moved = static_cast<int64_t>(ticks[i]) + signedOffset(mixBits(seed ^ static_cast<uint32_t>(i) * 0x9E3779B9u), step.timing);
+            ticks[i] = static_cast<uint32_t>(std::max<int64_t>(moved, 0));
+        }
+    }
+
+    if (step.velocity > 0) {
+        uint8_t* velocities = notes.velocities.data();
+        const uint32_t velocitySeed = mixBits(seed + 0x632BE5ABu);
+        for (size_t i = 0; i < count; ++i) {
+            int32_t moved = velocities[i] + signedOffset(mixBits(velocitySeed ^ static_cast<uint32_t>(i) * 0x9E3779B9u), step.velocity);
+            velocities[i] = static_cast<uint8_t>(std::clamp(moved, 1, 127));
+        }
+    }
+
+    // Neighbouring notes may have crossed
+    if (step.timing > 0) {
+        notes.sortByTick();
+    }
+}
+
+void accent(NoteStream& notes, const AccentMap& step, int intensity) {
+    if (step.step == 0 || step.gains.empty()) return;
+
+    // Blend every gain towards 1 by intensity once, not per note
+    const float blend = std::clamp(intensity, 0, 10) / 10.0f;
+    std::vector<float> gains(step.gains.size());
+    for (size_t i = 0; i < gains.size(); ++i) {
+        gains[i] = 1.0f + (step.gains[i] - 1.0f) * blend;
+    }
+
+    const Divider byStep(step.step);
+    const uint32_t cycle = static_cast<uint32_t>(gains.size());
+    const Divider byCycle(cycle);
+    const float* gainTable = gains.data();
+    const uint32_t* ticks = notes.ticks.data();
+    uint8_t* velocities = notes.velocities.data();
+    const size_t count = notes.size();
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t cell = byStep.divide(ticks[i]);
+        float gain = gainTable[cell - byCycle.divide(cell) * cycle];
+        int32_t scaled = static_cast<int32_t>(velocities[i] * gain + 0.5f);
+        velocities[i] = static_cast<uint8_t>(std::clamp(scaled, 1, 127));
+    }
+}
+
+void applyCurve(std::span<uint8_t> velocities, const std::array<uint8_t, 128>& table) {
+    for (uint8_t& velocity : velocities) {
+        velocity = table[velocity & 0x7F];
+    }
+}
+
+std::array<uint8_t, 128> buildCurveTable(const VelocityCurve& curve) {
+    std::array<uint8_t, 128> table{};
+    const float low = curve.floor;
+    const float high = std::max(curve.ceiling, curve.floor);
+    const float exponent = std::max(curve.exponent, 0.01f);
+    for (size_t i = 0; i < table.size(); ++i) {
+        float shaped = low + (high - low) * std::pow(i / 127.0f, exponent);
+        table[i] = static_cast<uint8_t>(std::clamp(std::lround(shaped), 1l, 127l));
+    }
+    return table;
+}
+
+} // namespace
+
+NoteTransformChain::NoteTransformChain(std::initializer_list<NoteTransform> steps) {
+    for (const auto& step : steps) {
+        add(step);
+    }
+}
+
+NoteTransformChain& NoteTransformChain::add(NoteTransform step) {
+    if (const auto* curve = std::get_if<VelocityCurve>(&step)) {
+        m_curveTables.push_back(buildCurveTable(*curve));
+    }
+    m_steps.push_back(std::move(step));
+    return *this;
+}
+
+void NoteTransformChain::apply(NoteStream& notes, int intensity, uint32_t seed) const {
+    size_t curveIndex = 0;
+    for (const auto& step : m_steps) {
+        if (const auto* quantizeStep = std::get_if<Quantize>(&step)) {
+            quantize(notes, *quantizeStep);
+        } else if (const auto* swingStep = std::get_if<Swing>(&step)) {
+            swing(notes, *swingStep);
+        } else if (const auto* humanizeStep = std::get_if<Humanize>(&step)) {
+            humanize(notes, *humanizeStep, seed);
+        } else if (const auto* accentStep = std::get_if<AccentMap>(&step)) {
+            accent(notes, *accentStep, intensity);
+        } else if (std::holds_alternative<VelocityCurve>(step)) {
+            applyCurve(notes.velocities, m_curveTables[curveIndex++]);
+        }
+    }
+}
+
+uint64_t NoteTransformChain::fingerprint() const {
+    ContentHasher hash;
+    hash.add(m_steps.size());
+    for (const auto& step : m_steps) {
+        hash.add(step.index());
+        if (const auto* quantizeStep = std::get_if<Quantize>(&step)) {
+            hash.add(quantizeStep->grid);
+            hash.add(quantizeStep->strength);
+        } else if (const auto* swingStep = std::get_if<Swing>(&step)) {
+            hash.add(swingStep->grid);
+            hash.add(swingStep->amount);
+        } else if (const auto* humanizeStep = std::get_if<Humanize>(&step)) {
+            hash.add(humanizeStep->timing);
+            hash.add(humanizeStep->velocity);
+        } else if (const auto* accentStep = std::get_if<AccentMap>(&step)) {
+            hash.add(accentStep->step);
+            hash.add(accentStep->gains.size());
+            for (float gain : accentStep->gains) {
+                hash.add(gain);
+            }
+        } else if (const auto* curve = std::get_if<VelocityCurve>(&step)) {
+            hash.add(curve->exponent);
+            hash.add(curve->floor);
+            hash.add(curve->ceiling);
+        }
+    }
+    return hash.value();
+}
+
+} // namespace IndustrialMusic
\ No newline at end of file
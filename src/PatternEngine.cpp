@@ -0,0 +1,411 @@
+#include "PatternEngine.h"
+#include <bit>
+
+namespace IndustrialMusic {
+
+namespace {
+
+// One beat of a drum pattern as the rules below describe it; packed into a
+// DrumPattern per section type and intensity
+struct DrumStep {
+    bool kick = false;
+    bool snare = false;
+    bool hihat = false;
+    float snareVelocityRandomness = 0.0f; // 1 scales the snare velocity by the roll
+    float kickThreshold = -1.0f;  // Hit only if the random roll is above this
+    float snareThreshold = -1.0f;
+    float hihatThreshold = -1.0f;
+    float kickVelocity = 1.0f;
+    float snareVelocity = 1.0f;
+    float hihatVelocity = 1.0f;
+};
+
+constexpr size_t INTENSITY_LEVELS = 11; // 0-10
+
+// Beats 0-15 each get their own phase so the intro can hold back its kick;
+// after that every rule repeats every 8 beats
+constexpr size_t DRUM_PHASES = 24;
+
+constexpr size_t drumPhase(int beat) {
+    return beat < 16 ? static_cast<size_t>(std::max(beat, 0)) : 16 + static_cast<size_t>(beat % 8);
+}
+
+constexpr DrumStep makeDrumStep(SectionType type, int intensity, size_t phase) {
+    // Any beat with this phase behaves the same, so use a representative one
+    int beat = static_cast<int>(phase);
+
+    // Basic 4/4 pattern with variations based on section
+    bool isBeat = (beat % 4) == 0;
+    bool isOffBeat = (beat % 2) == 1;
+
+    DrumStep step;
+    switch (type) {
+        case SectionType::Intro:
+            step.kick = isBeat && beat > 8;
+            step.hihat = true;
+            step.hihatVelocity = 0.5f;
+            break;
+
+        case SectionType::Verse:
+            step.kick = isBeat;
+            step.snare = (beat % 8) == 4;
+            step.hihat = true;
+            break;
+
+        case SectionType::Chorus:
+            step.kick = isBeat || (intensity > 7 && isOffBeat);
+            step.snare = (beat % 4) == 2;
+            step.hihat = true;
+            step.kickVelocity = 1.0f;
+            break;
+
+        case SectionType::Breakdown:
+            step.kick = (beat % 8) == 0;
+            step.snare = true;
+            step.snareThreshold = 0.7f;
+            step.hihat = true;
+            step.hihatThreshold = 0.5f;
+            step.snareVelocityRandomness = 1.0f;
+            break;
+
+        default:
+            step.kick = isBeat;
+            step.snare = (beat % 4) == 2;
+            step.hihat = true;
+            break;
+    }
+
+    // Intensity affects velocity
+    float intensityFactor = intensity / 10.0f;
+    step.kickVelocity *= intensityFactor;
+    step.snareVelocity *= intensityFactor;
+    step.hihatVelocity *= intensityFactor * 0.7f;
+
+    return step;
+}
+
+// Drums in the order they are written on a beat
+enum DrumVoice : size_t { KICK, SNARE, HIHAT, DRUM_VOICES };
+
+// Drums of one section type at one intensity, per voice. Each step mask
+// has bit p set when the voice plays on beat phase p; velocities and
+// thresholds are the same on every phase.
+struct DrumPattern {
+    std::array<uint32_t, DRUM_VOICES> steps{};
+    std::array<float, DRUM_VOICES> thresholds{-1.0f, -1.0f, -1.0f}; // Hit only if the random roll is above this
+    std::array<float, DRUM_VOICES> velocities{1.0f, 1.0f, 1.0f};
+    float snareVelocityRandomness = 0.0f;
+};
+
+static_assert(DRUM_PHASES <= 32);
+
+constexpr DrumPattern makeDrumPattern(SectionType type, int intensity) {
+    const DrumStep first = makeDrumStep(type, intensity, 0);
+    DrumPattern pattern;
+    pattern.thresholds = {first.kickThreshold, first.snareThreshold, first.hihatThreshold};
+    pattern.velocities = {first.kickVelocity, first.snareVelocity, first.hihatVelocity};
+    pattern.snareVelocityRandomness = first.snareVelocityRandomness;
+    for (size_t phase = 0; phase < DRUM_PHASES; ++phase) {
+        DrumStep step = makeDrumStep(type, intensity, phase);
+        pattern.steps[KICK] |= static_cast<uint32_t>(step.kick) << phase;
+        pattern.steps[SNARE] |= static_cast<uint32_t>(step.snare) << phase;
+        pattern.steps[HIHAT] |= static_cast<uint32_t>(step.hihat) << phase;
+    }
+    return pattern;
+}
+
+using DrumTable = std::array<std::array<DrumPattern, INTENSITY_LEVELS>, SECTION_TYPE_COUNT>;
+
+constexpr DrumTable makeDrumTable() {
+    DrumTable table{};
+    for (size_t type = 0; type < SECTION_TYPE_COUNT; ++type) {
+        for (size_t intensity = 0; intensity < INTENSITY_LEVELS; ++intensity) {
+            table[type][intensity] = makeDrumPattern(static_cast<SectionType>(type), static_cast<int>(intensity));
+        }
+    }
+    return table;
+}
+
+// Every section type and intensity, built at compile time
+constexpr DrumTable DRUM_TABLE = makeDrumTable();
+
+constexpr uint32_t phaseBit(int beat) {
+    return 1u << drumPhase(beat);
+}
+
+static_assert(DRUM_PHASES > drumPhase(15) && drumPhase(16) == drumPhase(24));
+static_assert(!(DRUM_TABLE[static_cast<size_t>(SectionType::Intro)][10].steps[KICK] & phaseBit(8)));
+static_assert(DRUM_TABLE[static_cast<size_t>(SectionType::Intro)][10].steps[KICK] & phaseBit(32));
+
+// 0-1 velocity to MIDI; anything that plays stays audible
+uint8_t midiVelocity(float velocity) {
+    return static_cast<uint8_t>(std::clamp<long>(std::lround(velocity * 127.0f), 1, 127));
+}
+
+} // namespace
+
+void NoteStream::reserve(size_t count) {
+    ticks.reserve(count);
+    durations.reserve(count);
+    channels.reserve(count);
+    notes.reserve(count);
+    velocities.reserve(count);
+}
+
+void NoteStream::clear() {
+    ticks.clear();
+    durations.clear();
+    channels.clear();
+    notes.clear();
+    velocities.clear();
+}
+
+void NoteStream::push(uint8_t channel, uint8_t note, uint8_t velocity, uint32_t tick, uint32_t duration) {
+    ticks.push_back(tick);
+    durations.push_back(duration);
+    channels.push_back(channel);
+    notes.push_back(note);
+    velocities.push_back(velocity);
+}
+
+void NoteStream::append(const NoteStream& other, uint32_t tickOffset) {
+    size_t first = ticks.size();
+    ticks.insert(ticks.end(), other.ticks.begin(), other.ticks.end());
+    for (size_t i = first; i < ticks.size(); ++i) {
+        ticks[i] += tickOffset;
+    }
+    durations.insert(durations.end(), other.durations.begin(), other.durations.end());
+    channels.insert(channels.end(), other.channels.begin(), other.channels.end());
+    notes.insert(notes.end(), other.notes.begin(), other.notes.end());
+    velocities.insert(velocities.end(), other.velocities.begin(), other.velocities.end());
+}
+
+void NoteStream::sortByTick() {
+    if (std::ranges::is_sorted(ticks)) return;
+
+    // Sort (tick, index) keys; the index makes equal ticks keep their order
+    std::vector<uint64_t> keys(size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+        keys[i] = (static_cast<uint64_t>(ticks[i]) << 32) | i;
+    }
+
+    // Timing changes only move notes a little, so insertion sort is usually
+    // close to linear. Give up on it if the stream turns out to be shuffled.
+    const size_t moveBudget = keys.size() * 32;
+    size_t moves = 0;
+    for (size_t i = 1; i < keys.size() && moves <= moveBudget; ++i) {
+        uint64_t key = keys[i];
+        size_t j = i;
+        for (; j > 0 && keys[j - 1] > key; --j) {
+            keys[j] = keys[j - 1];
+        }
+        keys[j] = key;
+        moves += i - j;
+    }
+    if (moves > moveBudget) {
+        std::ranges::sort(keys);
+    }
+
+    auto permute = [&keys](auto& values) {
+        std::remove_reference_t<decltype(values)> sorted(values.size());
+        for (size_t i = 0; i < keys.size(); ++i) {
+            sorted[i] = values[static_cast<uint32_t>(keys[i])];
+        }
+        values = std::move(sorted);
+    };
+    permute(ticks);
+    permute(durations);
+    permute(channels);
+    permute(notes);
+    permute(velocities);
+}
+
+const NoteStream& PatternEngine::sectionNotes(PatternPart part, const Section& section, int intensity, uint32_t seed,
+                                              NoteStream& buffer, std::shared_ptr<const NoteStream>& cached) const {
+    if (!m_sectionCache) {
+        buildSection(part, section, intensity, seed, buffer);
+        return buffer;
+    }
+
+    SectionKey key(section, intensity, seed, static_cast<uint32_t>(part));
+    cached = m_sectionCache->getOrBuild(key, [&] {
+        NoteStream chunk;
+        buildSection(part, section, intensity, seed, chunk);
+        return chunk;
+    });
+    return *cached;
+}
+
+SongPatterns PatternEngine::generateSong(const std::vector<Section>& sections, int intensity, uint32_t seed) const {
+    SongPatterns song;
+    song.ticksPerQuarter = TICKS_PER_QUARTER;
+    song.sectionStartTicks.reserve(sections.size());
+    for (const auto& section : sections) {
+        song.sectionStartTicks.push_back(song.lengthTicks);
+        song.lengthTicks += static_cast<uint32_t>(section.totalBeats()) * TICKS_PER_QUARTER;
+    }
+
+    NoteStream buffer;
+    for (size_t part = 0; part < PATTERN_PART_COUNT; ++part) {
+        auto which = static_cast<PatternPart>(part);
+        uint32_t trackSeed = partSeed(seed, which);
+        for (size_t i = 0; i < sections.size(); ++i) {
+            std::shared_ptr<const NoteStream> cached;
+            const NoteStream& chunk = sectionNotes(which, sections[i], intensity, sectionSeed(trackSeed, sections[i]), buffer, cached);
+            song.parts[part].append(chunk, song.sectionStartTicks[i]);
+        }
+    }
+    return song;
+}
+
+void PatternEngine::setGrooveTemplate(PatternPart part, std::optional<GrooveTemplate> groove) {
+    m_grooves[static_cast<size_t>(part)] = std::move(groove);
+
+    // Cached sections were built from the old pattern
+    if (m_sectionCache) {
+        m_sectionCache->clear();
+    }
+}
+
+void PatternEngine::setTransforms(PatternPart part, NoteTransformChain transforms) {
+    m_transforms[static_cast<size_t>(part)] = std::move(transforms);
+
+    // Cached sections were built with the old transforms
+    if (m_sectionCache) {
+        m_sectionCache->clear();
+    }
+}
+
+void PatternEngine::setSectionCacheCapacity(size_t sections) {
+    if (sections == 0) {
+        m_sectionCache.reset();
+    } else {
+        m_sectionCache = std::make_unique<SectionCache<NoteStream>>(sections);
+    }
+}
+
+void PatternEngine::buildSection(PatternPart part, const Section& section, int intensity, uint32_t seed, NoteStream& out) const {
+    out.clear();
+    switch (part) {
+        case PatternPart::Drums: generateDrums(section, intensity, seed, out); break;
+        case PatternPart::Bass:  generateBass(section, out); break;
+        case PatternPart::Lead:  generateLead(section, intensity, seed, out); break;
+    }
+
+    if (const auto& transforms = m_transforms[static_cast<size_t>(part)]; !transforms.empty()) {
+        transforms.apply(out, intensity, seed);
+    }
+}
+
+void PatternEngine::generateDrums(const Section& section, int intensity, uint32_t seed, NoteStream& out) const {
+    if (const auto& groove = m_grooves[static_cast<size_t>(PatternPart::Drums)]) {
+        tileGroove(*groove, section, DRUM_CHANNEL, out);
+        return;
+    }
+
+    const DrumPattern& pattern = DRUM_TABLE[static_cast<size_t>(section.type)][std::clamp(intensity, 0, 10)];
+    int totalBeats = section.totalBeats();
+    out.reserve(static_cast<size_t>(std::max(totalBeats, 0)) * 2);
+
+    // One roll per beat decides the random hits and scales random velocities
+    std::minstd_rand rng(seed);
+    std::uniform_real_distribution<float> roll(0.0f, 1.0f);
+    constexpr uint32_t HIT_LENGTH = TICKS_PER_QUARTER / 8;
+    constexpr std::array<uint8_t, DRUM_VOICES> NOTES = {KICK_NOTE, SNARE_NOTE, HIHAT_CLOSED};
+    std::array<uint8_t, DRUM_VOICES> velocities = {
+        midiVelocity(pattern.velocities[KICK]), 0, midiVelocity(pattern.velocities[HIHAT])
+    };
+
+    for (int beat = 0; beat < totalBeats; ++beat) {
+        const uint32_t bit = phaseBit(beat);
+        float random = roll(rng);
+        uint32_t tick = static_cast<uint32_t>(beat) * TICKS_PER_QUARTER;
+
+        // Bit v is set when voice v plays: on one of its steps, with the roll
+        // above its threshold (fixed hits have -1)
+        uint32_t hits = 0;
+        for (size_t voice = 0; voice < DRUM_VOICES; ++voice) {
+            const bool plays = ((pattern.steps[voice] & bit) != 0) & (random > pattern.thresholds[voice]);
+            hits |= static_cast<uint32_t>(plays) << voice;
+        }
+        velocities[SNARE] = midiVelocity(pattern.velocities[SNARE] *
+            (random * pattern.snareVelocityRandomness + (1.0f - pattern.snareVelocityRandomness)));
+
+        // One write per hit, in voice order
+        for (; hits != 0; hits &= hits - 1) {
+            const auto voice = static_cast<size_t>(std::countr_zero(hits));
+            out.push(DRUM_CHANNEL, NOTES[voice], velocities[voice], tick, HIT_LENGTH);
+        }
+    }
+}
+
+void PatternEngine::generateBass(const Section& section, NoteStream& out) const {
+    if (const auto& groove = m_grooves[static_cast<size_t>(PatternPart::Bass)]) {
+        tileGroove(*groove, section, BASS_CHANNEL, out);
+        return;
+    }
+
+    out.reserve(static_cast<size_t>(std::max(section.bars, 0)) * 2);
+
+    uint32_t barTicks = static_cast<uint32_t>(section.beatsPerBar) * TICKS_PER_QUARTER;
+    uint32_t halfBar = barTicks / 2;
+
+    for (int bar = 0; bar < section.bars; ++bar) {
+        uint32_t tick = static_cast<uint32_t>(bar) * barTicks;
+
+        // Root note, then the fifth for the second half of the bar
+        out.push(BASS_CHANNEL, BASS_NOTES[0], 80, tick, halfBar);
+        out.push(BASS_CHANNEL, BASS_NOTES[5], 70, tick + halfBar, halfBar);
+    }
+}
+
+void PatternEngine::generateLead(const Section& section, int intensity, uint32_t seed, NoteStream& out) const {
+    if (const auto& groove = m_grooves[static_cast<size_t>(PatternPart::Lead)]) {
+        tileGroove(*groove, section, LEAD_CHANNEL, out);
+        return;
+    }
+
+    // No lead in the sparse sections
+    if (section.type == SectionType::Intro || section.type == SectionType::Breakdown) {
+        return;
+    }
+
+    // Reseeded for every section, so use a generator that is cheap to seed
+    std::minstd_rand rng(seed);
+    std::uniform_int_distribution<int> percent(0, 99);
+    std::uniform_int_distribution<size_t> noteDist(0, LEAD_NOTES.size() / 2 - 1);
+
+    // Eighth-note grid, denser at higher intensity
+    constexpr uint32_t STEP = TICKS_PER_QUARTER / 2;
+    int density = std::clamp(intensity, 1, 10) * 5; // Percent chance per step
+    uint8_t velocity = static_cast<uint8_t>(60 + std::clamp(intensity, 1, 10) * 5);
+    int steps = section.totalBeats() * 2;
+
+    // Monophonic line: a new note only starts once the previous one has ended
+    for (int step = 0; step < steps; ++step) {
+        if (percent(rng) < density) {
+            int length = (percent(rng) < 50 || step + 1 == steps) ? 1 : 2;
+            out.push(LEAD_CHANNEL, LEAD_NOTES[noteDist(rng)], velocity,
+                     static_cast<uint32_t>(step) * STEP, static_cast<uint32_t>(length) * STEP);
+            step += length - 1;
+        }
+    }
+}
+
+void PatternEngine::tileGroove(const GrooveTemplate& groove, const Section& section, uint8_t channel, NoteStream& out) const {
+    if (groove.lengthTicks == 0) return;
+
+    uint32_t sectionTicks = static_cast<uint32_t>(section.totalBeats()) * TICKS_PER_QUARTER;
+    for (uint32_t loopStart = 0; loopStart < sectionTicks; loopStart += groove.lengthTicks) {
+        for (const auto& note : groove.notes) {
+            uint32_t tick = loopStart + note.startTick;
+            if (note.startTick >= groove.lengthTicks || tick >= sectionTicks) continue;
+
+            // Cut notes at the loop end so repeats never overlap themselves
+            uint32_t duration = std::min(note.duration, groove.lengthTicks - note.startTick);
+            out.push(channel, note.note, note.velocity, tick, duration);
+        }
+    }
+}
+
+} // namespace IndustrialMusic
\ No newline at end of file
@@ -0,0 +1,298 @@
+#include "Phonemizer.h"
+#include "Prosody.h"
+
+namespace IndustrialMusic {
+
+namespace {
+
+using enum Phoneme;
+
+// Spellings read before single letters, longest first where they overlap
+struct SpellingRule {
+    std::string_view spelling;
+    std::array<Phoneme, 3> phonemes;
+    uint8_t count;
+};
+
+constexpr std::array<SpellingRule, 34> SPELLING_RULES = {{
+    {"tion", {SH, AH, N}, 3},
+    {"sion", {ZH, AH, N}, 3},
+    {"tch", {CH}, 1},
+    {"igh", {AY}, 1},
+    {"sh", {SH}, 1},
+    {"ch", {CH}, 1},
+    {"ph", {F}, 1},
+    {"wh", {W}, 1},
+    {"ck", {K}, 1},
+    {"ng", {NG}, 1},
+    {"nk", {NG, K}, 2},
+    {"qu", {K, W}, 2},
+    {"ee", {IY}, 1},
+    {"ea", {IY}, 1},
+    {"oo", {UW}, 1},
+    {"ou", {AW}, 1},
+    {"ai", {EY}, 1},
+    {"ay", {EY}, 1},
+    {"ei", {EY}, 1},
+    {"ey", {EY}, 1},
+    {"oi", {OY}, 1},
+    {"oy", {OY}, 1},
+    {"au", {AO}, 1},
+    {"aw", {AO}, 1},
+    {"oa", {OW}, 1},
+    {"ie", {IY}, 1},
+    {"ue", {UW}, 1},
+    {"ew", {UW}, 1},
+    {"er", {ER}, 1},
+    {"ir", {ER}, 1},
+    {"ur", {ER}, 1},
+    {"ar", {AA, R}, 2},
+    {"or", {AO, R}, 2},
+    {"ow", {AW}, 1},
+}};
+
+// Common words the rules get wrong, sung unstressed
+constexpr std::array<SpellingRule, 12> WORD_EXCEPTIONS = {{
+    {"a", {AH}, 1},
+    {"the", {DH, AH}, 2},
+    {"to", {T, UW}, 2},
+    {"do", {D, UW}, 2},
+    {"you", {Y, UW}, 2},
+    {"of", {AH, V}, 2},
+    {"are", {AA, R}, 2},
+    {"one", {W, AH, N}, 3},
+    {"was", {W, AA, Z}, 3},
+    {"is", {IH, Z}, 2},
+    {"as", {AE, Z}, 2},
+    {"his", {HH, IH, Z}, 3},
+}};
+
+// Function words whose "th" is voiced
+constexpr std::array<std::string_view, 12> VOICED_TH = {
+    "the", "this", "that", "these", "those", "they", "them", "their", "there", "then", "than", "though"};
+
+constexpr bool isVowelLetter(char c) {
+    return c == 'a' || c == 'e' || c == 'i' || c == 'o' || c == 'u';
+}
+
+constexpr bool isSoftening(char c) {
+    return c == 'e' || c == 'i' || c == 'y';
+}
+
+constexpr Phoneme shortVowel(char c) {
+    switch (c) {
+        case 'a': return AE;
+        case 'e': return EH;
+        case 'i': return IH;
+        case 'o': return AA;
+        default:  return AH;
+    }
+}
+
+constexpr Phoneme longVowel(char c) {
+    switch (c) {
+        case 'a': return EY;
+        case 'e': return IY;
+        case 'i': return AY;
+        case 'o': return OW;
+        default:  return UW;
+    }
+}
+
+constexpr bool isVoiceless(Phoneme phoneme) {
+    return phoneme == P || phoneme == T || phoneme == K || phoneme == F || phoneme == TH ||
+           phoneme == S || phoneme == SH || phoneme == CH || phoneme == HH;
+}
+
+} // namespace
+
+std::shared_ptr<const PhonemeLine> Phonemizer::convert(std::string_view line) {
+    return m_cache.getOrBuild(line, [&] {
+        return convertLine(line);
+    });
+}
+
+PhonemeLine Phonemizer::convertLine(std::string_view line) {
+    PhonemeLine phonemes;
+    if (line.starts_with('[')) {
+        return phonemes;
+    }
+
+    std::string word;
+    auto flush = [&] {
+        if (!word.empty()) {
+            convertWord(word, phonemes);
+            word.clear();
+        }
+    };
+    for (char c : line) {
+        char lower = prosody_detail::lower(c);
+        if (lower >= 'a' && lower <= 'z') {
+            word += lower;
+        } else if (c != '\'') {
+            flush();
+            // Punctuation is a breath; spaces run words together
+            if ((c == ',' || c == '.' || c == '!' || c == '?' || c == ';') && !phonemes.empty() &&
+                phonemes.back().phoneme != Pause) {
+                phonemes.push_back({Pause, false});
+            }
+        }
+    }
+    flush();
+    return phonemes;
+}
+
+void Phonemizer::convertWord(std::string_view word, PhonemeLine& out) {
+    if (auto exception = std::ranges::find(WORD_EXCEPTIONS, word, &SpellingRule::spelling);
+        exception != WORD_EXCEPTIONS.end()) {
+        for (uint8_t k = 0; k < exception->count; ++k) {
+            out.push_back({exception->phonemes[k], false});
+        }
+        return;
+    }
+
+    const WordProsody prosody = analyzeWord(word);
+    const size_t n = word.size();
+    const bool multiSyllable = prosody.syllables > 1;
+    size_t syllable = 0;
+
+    auto at = [&](size_t i) { return i < n ? word[i] : '\0'; };
+    auto emit = [&](Phoneme phoneme) {
+        bool stressed = false;
+        if (isVowel(phoneme)) {
+            stressed = syllable < 8 && ((prosody.stress >> syllable) & 1);
+            ++syllable;
+        }
+        out.push_back({phoneme, stressed});
+    };
+    auto nextStressed = [&] { return syllable < 8 && ((prosody.stress >> syllable) & 1); };
+    // Final "e", "es" and "ed" that analyzeWord counts as silent
+    auto silentEnding = [&](size_t i) {
+        if (word[i] != 'e' || syllable == 0) return false;
+        if (i == n - 1) return !(n >= 3 && word[n - 2] == 'l' && !isVowelLetter(word[n - 3]));
+        return i == n - 2 && (word[i + 1] == 's' || word[i + 1] == 'd');
+    };
+
+    for (size_t i = 0; i < n;) {
+        std::string_view rest = word.substr(i);
+        char c = word[i];
+
+        if (rest.starts_with("th")) {
+            emit(std::ranges::find(VOICED_TH, word) != VOICED_TH.end() ? DH : TH);
+            i += 2;
+            continue;
+        }
+        if (i == 0 && (rest.starts_with("kn") || rest.starts_with("wr"))) {
+            ++i;
+            continue;
+        }
+        // "ow" ends a word as in "glow"
+        if (rest == "ow") {
+            emit(OW);
+            break;
+        }
+        // "r" spellings need something other than a vowel after them ("era" is not "er-a")
+        auto rule = std::ranges::find_if(SPELLING_RULES, [&](const SpellingRule& candidate) {
+            if (!rest.starts_with(candidate.spelling)) return false;
+            char last = candidate.spelling.back();
+            char after = at(i + candidate.spelling.size());
+            return last != 'r' || (!isVowelLetter(after) && after != 'y');
+        });
+        if (rule != SPELLING_RULES.end()) {
+            for (uint8_t k = 0; k < rule->count; ++k) {
+                emit(rule->phonemes[k]);
+            }
+            i += rule->spelling.size();
+            continue;
+        }
+
+        if (isVowelLetter(c) || (c == 'y' && i > 0)) {
+            if (silentEnding(i)) {
+                // "es" after a sibilant and "ed" after t or d are sounded
+                char before = word[i - 1];
+                bool soundedEs = i == n - 2 && word[i + 1] == 's' &&
+                                 (before == 's' || before == 'x' || before == 'z' || before == 'c' || before == 'g' || before == 'h');
+                bool soundedEd = i == n - 2 && word[i + 1] == 'd' && (before == 't' || before == 'd');
+                if (soundedEs || soundedEd) {
+                    emit(IH);
+                    emit(word[i + 1] == 's' ? Z : D);
+                } else if (i == n - 2) {
+                    bool voiceless = !out.empty() && isVoiceless(out.back().phoneme);
+                    emit(word[i + 1] == 's' ? (voiceless ? S : Z) : (voiceless ? T : D));
+                }
+                break;
+            }
+            if (c == 'y') {
+                // "my", "cry" against "heavy"; inside a word it is short
+                emit(i == n - 1 ? (prosody.syllables == 1 ? AY : IY) : IH);
+                ++i;
+                continue;
+            }
+
+            // A lone final vowel is long ("we", "go")
+            if (i == n - 1 && syllable == 0 && (c == 'e' || c == 'o')) {
+                emit(longVowel(c));
+                break;
+            }
+
+            // Silent-e lengthening: vowel, one consonant, final e ("forge", "smokes")
+            bool lengthened = !isVowelLetter(at(i + 1)) && at(i + 1) != '\0' && at(i + 2) == 'e' &&
+                              (i + 3 == n || (i + 4 == n && (at(i + 3) == 's' || at(i + 3) == 'd')));
+            if (lengthened) {
+                emit(longVowel(c));
+            } else if (multiSyllable && !nextStressed() && c != 'i') {
+                emit(AH);
+            } else {
+                emit(shortVowel(c));
+            }
+            ++i;
+            continue;
+        }
+
+        // Doubled consonants sound once
+        if (i > 0 && word[i - 1] == c) {
+            ++i;
+            continue;
+        }
+
+        char next = at(i + 1);
+        switch (c) {
+            case 'b': emit(B); break;
+            case 'c': emit(isSoftening(next) ? S : K); break;
+            case 'd': emit(D); break;
+            case 'f': emit(F); break;
+            case 'g': emit(i > 0 && isSoftening(next) ? JH : G); break;
+            case 'h':
+                if (isVowelLetter(next)) emit(HH);
+                break;
+            case 'j': emit(JH); break;
+            case 'k': emit(K); break;
+            case 'l': emit(L); break;
+            case 'm': emit(M); break;
+            case 'n': emit(N); break;
+            case 'p': emit(P); break;
+            case 'q': emit(K); break;
+            case 'r': emit(R); break;
+            case 's': {
+                // Voiced between vowels ("rising") and after voiced sounds at the end ("gears")
+                bool between = i > 0 && isVowelLetter(word[i - 1]) && isVowelLetter(next);
+                bool finalVoiced = i == n - 1 && !out.empty() && !isVoiceless(out.back().phoneme);
+                emit(between || finalVoiced ? Z : S);
+                break;
+            }
+            case 't': emit(T); break;
+            case 'v': emit(V); break;
+            case 'w': emit(W); break;
+            case 'x':
+                emit(K);
+                emit(S);
+                break;
+            case 'y': emit(Y); break;
+            case 'z': emit(Z); break;
+            default: break;
+        }
+        ++i;
+    }
+}
+
+} // namespace IndustrialMusic
\ No newline at end of file
@@ -0,0 +1,321 @@
+#include "ProjectFile.h"
+#include "BinaryRecords.h"
+#include "SectionCache.h"
+#include <cstddef>
+
+namespace IndustrialMusic {
+
+namespace {
+
+struct FileHeader {
+    char magic[4];
+    uint16_t version;
+    uint16_t headerSize;
+    uint32_t songSeed;
+    int32_t tempo;
+    int32_t intensity;
+    int32_t distortion;
+    float songLength;
+    uint32_t vocalType;
+    TableHeader sections;
+    TableHeader lyrics;
+    TableHeader lanes;
+    TableHeader points;
+    uint32_t stringsOffset;
+    uint32_t stringsSize;
+};
+
+struct SectionRecord {
+    StringRef name;
+    int32_t bars;
+    int32_t beatsPerBar;
+    uint8_t type;
+    uint8_t reserved[3];
+    uint32_t variation; // Appended; older files end the record before it
+};
+
+// Records as first written, without a variation
+constexpr size_t SECTION_RECORD_V1_SIZE = offsetof(SectionRecord, variation);
+
+// Longest section a file may hold; anything beyond is damage, not music
+constexpr int32_t MAX_SECTION_BARS = 1024;
+constexpr int32_t MAX_BEATS_PER_BAR = 64;
+
+struct LaneRecord {
+    uint32_t firstPoint;
+    uint32_t pointCount;
+    uint8_t target;
+    uint8_t reserved[3];
+};
+
+struct PointRecord {
+    uint32_t beat;
+    float value;
+};
+
+static_assert(sizeof(FileHeader) == 88);
+static_assert(sizeof(SectionRecord) == 24 && SECTION_RECORD_V1_SIZE == 20);
+static_assert(sizeof(LaneRecord) == 12);
+static_assert(sizeof(PointRecord) == 8);
+
+constexpr char MAGIC[4] = {'I', 'M', 'M', 'P'};
+
+// Fields past the end of a shorter record read as zero
+SectionRecord readSectionRecord(const RecordTable& table, size_t index) {
+    SectionRecord record{};
+    std::memcpy(&record, table.record(index), std::min<size_t>(table.stride, sizeof(SectionRecord)));
+    return record;
+}
+
+} // namespace
+
+Result<ProjectFile> ProjectFile::open(const std::filesystem::path& filepath) {
+    auto file = MappedFile::open(filepath);
+    if (!file) {
+        return std::unexpected(file.error());
+    }
+
+    ProjectFile project;
+    project.m_file = std::move(*file);
+    project.m_bytes = project.m_file.bytes();
+    if (auto result = project.readHeader(); !result) {
+        return std::unexpected(result.error());
+    }
+    return project;
+}
+
+Result<ProjectFile> ProjectFile::parse(std::span<const uint8_t> bytes) {
+    ProjectFile project;
+    project.m_bytes = bytes;
+    if (auto result = project.readHeader(); !result) {
+        return std::unexpected(result.error());
+    }
+    return project;
+}
+
+Result<void> ProjectFile::readHeader() {
+    if (m_bytes.size() < sizeof(FileHeader) || std::memcmp(m_bytes.data(), MAGIC, sizeof(MAGIC)) != 0) {
+        return std::unexpected(ErrorCode::InvalidFileFormat);
+    }
+
+    auto header = readRecord<FileHeader>(m_bytes.data());
+    // Newer major layouts cannot be read; newer header fields are skipped
+    if (header.version == 0 || header.version > FORMAT_VERSION ||
+        header.headerSize < sizeof(FileHeader) || header.headerSize > m_bytes.size()) {
+        return std::unexpected(ErrorCode::InvalidFileFormat);
+    }
+    m_version = header.version;
+
+    auto mapTable = [&](const TableHeader& table, size_t recordSize, RecordTable& out) {
+        return RecordTable::map(m_bytes, table, header.headerSize, recordSize, out);
+    };
+    if (!mapTable(header.sections, SECTION_RECORD_V1_SIZE, m_sections) ||
+        !mapTable(header.lyrics, sizeof(StringRef), m_lyrics) ||
+        !mapTable(header.lanes, sizeof(LaneRecord), m_lanes) ||
+        !mapTable(header.points, sizeof(PointRecord), m_points)) {
+        return std::unexpected(ErrorCode::InvalidFileFormat);
+    }
+
+    if (static_cast<uint64_t>(header.stringsOffset) + header.stringsSize > m_bytes.size()) {
+        return std::unexpected(ErrorCode::InvalidFileFormat);
+    }
+    m_strings = m_bytes.subspan(header.stringsOffset, header.stringsSize);
+    return {};
+}
+
+std::vector<uint8_t> ProjectFile::serialize(const Project& project) {
+    StringTableBuilder strings;
+    std::vector<uint8_t> out(sizeof(FileHeader), 0);
+
+    FileHeader header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = FORMAT_VERSION;
+    header.headerSize = sizeof(FileHeader);
+    header.songSeed = project.songSeed;
+    header.tempo = project.params.tempo;
+    header.intensity = project.params.intensity;
+    header.distortion = project.params.distortion;
+    header.songLength = project.params.songLength;
+    header.vocalType = static_cast<uint32_t>(project.params.vocalType);
+
+    header.sections = {beginTable(out), static_cast<uint32_t>(project.sections.size()), sizeof(SectionRecord)};
+    out.reserve(out.size() + project.sections.size() * sizeof(SectionRecord));
+    for (const auto& section : project.sections) {
+        SectionRecord record{};
+        record.name = strings.add(section.name);
+        record.bars = section.bars;
+        record.beatsPerBar = section.beatsPerBar;
+        record.type = static_cast<uint8_t>(section.type);
+        record.variation = section.variation;
+        appendRecord(out, record);
+    }
+
+    header.lyrics = {beginTable(out), static_cast<uint32_t>(project.lyrics.size()), sizeof(StringRef)};
+    for (const auto& line : project.lyrics) {
+        appendRecord(out, strings.add(line));
+    }
+
+    header.lanes = {beginTable(out), static_cast<uint32_t>(project.automation.size()), sizeof(LaneRecord)};
+    uint32_t pointCount = 0;
+    for (const auto& lane : project.automation) {
+        LaneRecord record{};
+        record.firstPoint = pointCount;
+        record.pointCount = static_cast<uint32_t>(lane.points.size());
+        record.target = static_cast<uint8_t>(lane.target);
+        appendRecord(out, record);
+        pointCount += record.pointCount;
+    }
+
+    header.points = {beginTable(out), pointCount, sizeof(PointRecord)};
+    for (const auto& lane : project.automation) {
+        for (const auto& point : lane.points) {
+            appendRecord(out, PointRecord{point.beat, point.value});
+        }
+    }
+
+    header.stringsOffset = beginTable(out);
+    header.stringsSize = static_cast<uint32_t>(strings.bytes().size());
+    out.insert(out.end(), strings.bytes().begin(), strings.bytes().end());
+
+    std::memcpy(out.data(), &header, sizeof(header));
+    return out;
+}
+
+Result<void> ProjectFile::save(const Project& project, const std::filesystem::path& filepath) {
+    auto bytes = serialize(project);
+    // Offsets are 32-bit
+    if (bytes.size() > UINT32_MAX) {
+        return std::unexpected(ErrorCode::InvalidParameter);
+    }
+
+    return writeFileAtomically(filepath, bytes);
+}
+
+uint32_t ProjectFile::getSongSeed() const {
+    return readRecord<FileHeader>(m_bytes.data()).songSeed;
+}
+
+AudioParams ProjectFile::getParams() const {
+    auto header = readRecord<FileHeader>(m_bytes.data());
+    AudioParams params;
+    params.tempo = header.tempo;
+    params.intensity = header.intensity;
+    params.distortion = header.distortion;
+    params.songLength = header.songLength;
+    if (header.vocalType <= static_cast<uint32_t>(AudioParams::VocalType::Distorted)) {
+        params.vocalType = static_cast<AudioParams::VocalType>(header.vocalType);
+    }
+    return params;
+}
+
+SectionView ProjectFile::getSection(size_t index) const {
+    if (index >= m_sections.count) {
+        return {};
+    }
+    auto record = readSectionRecord(m_sections, index);
+    SectionView section;
+    if (record.type <= static_cast<uint8_t>(SectionType::Outro)) {
+        section.type = static_cast<SectionType>(record.type);
+    }
+    section.name = stringAt(record.name.offset, record.name.length);
+    section.bars = record.bars;
+    section.beatsPerBar = record.beatsPerBar;
+    section.variation = record.variation;
+    return section;
+}
+
+std::string_view ProjectFile::getLyric(size_t index) const {
+    if (index >= m_lyrics.count) {
+        return {};
+    }
+    auto ref = readRecord<StringRef>(m_lyrics.record(index));
+    return stringAt(ref.offset, ref.length);
+}
+
+AutomationLaneView ProjectFile::getAutomationLane(size_t index) const {
+    if (index >= m_lanes.count) {
+        return {};
+    }
+    auto record = readRecord<LaneRecord>(m_lanes.record(index));
+    return {static_cast<AutomationTarget>(record.target), record.firstPoint, record.pointCount};
+}
+
+AutomationPoint ProjectFile::getAutomationPoint(size_t index) const {
+    if (index >= m_points.count) {
+        return {};
+    }
+    auto record = readRecord<PointRecord>(m_points.record(index));
+    return {record.beat, record.value};
+}
+
+Result<Project> ProjectFile::load() const {
+    auto invalid = std::unexpected(ErrorCode::InvalidFileFormat);
+    auto header = readRecord<FileHeader>(m_bytes.data());
+    if (header.vocalType > static_cast<uint32_t>(AudioParams::VocalType::Distorted)) {
+        return invalid;
+    }
+
+    Project project;
+    project.songSeed = header.songSeed;
+    project.params = getParams();
+
+    auto inStrings = [&](const StringRef& ref) {
+        return static_cast<uint64_t>(ref.offset) + ref.length <= m_strings.size();
+    };
+
+    project.sections.reserve(m_sections.count);
+    for (size_t i = 0; i < m_sections.count; ++i) {
+        auto record = readSectionRecord(m_sections, i);
+        if (record.type > static_cast<uint8_t>(SectionType::Outro) || !inStrings(record.name) ||
+            record.bars <= 0 || record.bars > MAX_SECTION_BARS ||
+            record.beatsPerBar <= 0 || record.beatsPerBar > MAX_BEATS_PER_BAR) {
+            return invalid;
+        }
+        project.sections.push_back({static_cast<SectionType>(record.type),
+                                    std::string(stringAt(record.name.offset, record.name.length)),
+                                    record.bars, record.beatsPerBar, record.variation});
+    }
+    if (!hasVariations()) {
+        project.sections = numberVariations(std::move(project.sections));
+    }
+
+    project.lyrics.reserve(m_lyrics.count);
+    for (size_t i = 0; i < m_lyrics.count; ++i) {
+        auto ref = readRecord<StringRef>(m_lyrics.record(i));
+        if (!inStrings(ref)) {
+            return invalid;
+        }
+        project.lyrics.emplace_back(stringAt(ref.offset, ref.length));
+    }
+
+    project.automation.reserve(m_lanes.count);
+    for (size_t i = 0; i < m_lanes.count; ++i) {
+        auto lane = getAutomationLane(i);
+        if (lane.target > AutomationTarget::Distortion ||
+            static_cast<uint64_t>(lane.firstPoint) + lane.pointCount > m_points.count) {
+            return invalid;
+        }
+
+        AutomationLane& out = project.automation.emplace_back();
+        out.target = lane.target;
+        out.points.reserve(lane.pointCount);
+        for (uint32_t point = 0; point < lane.pointCount; ++point) {
+            out.points.push_back(getAutomationPoint(lane.firstPoint + point));
+        }
+    }
+    return project;
+}
+
+bool ProjectFile::hasVariations() const {
+    return m_sections.stride >= sizeof(SectionRecord);
+}
+
+std::string_view ProjectFile::stringAt(uint32_t offset, uint32_t length) const {
+    // Out-of-range references read as empty; load() reports them
+    if (static_cast<uint64_t>(offset) + length > m_strings.size()) {
+        return {};
+    }
+    return {reinterpret_cast<const char*>(m_strings.data()) + offset, length};
+}
+
+} // namespace IndustrialMusic
\ No newline at end of file
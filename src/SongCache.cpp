@@ -0,0 +1,141 @@
+#include "SongCache.h"
+#include <fstream>
+#include <random>
+
+namespace IndustrialMusic {
+
+namespace {
+
+// Leftover temporary files older than this belong to a crashed writer
+constexpr auto STALE_TEMP_AGE = std::chrono::minutes(10);
+
+} // namespace
+
+SongCache::SongCache(std::filesystem::path directory, uint64_t maxBytes)
+    : m_directory(std::move(directory)), m_maxBytes(maxBytes) {
+}
+
+Result<std::unique_ptr<SongCache>> SongCache::open(const std::filesystem::path& directory, uint64_t maxBytes) {
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error) {
+        return std::unexpected(ErrorCode::FileWriteFailed);
+    }
+
+    std::unique_ptr<SongCache> cache(new SongCache(directory, maxBytes));
+    for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+        if (entry.path().extension() == ENTRY_EXTENSION) {
+            cache->m_trackedBytes += entry.file_size(error);
+        }
+    }
+    if (cache->m_trackedBytes > maxBytes) {
+        cache->evict();
+    }
+    return cache;
+}
+
+Result<MappedFile> SongCache::find(const std::string& key) {
+    auto path = entryPath(key);
+    auto mapped = MappedFile::open(path);
+    if (!mapped || mapped->empty()) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_misses;
+        return std::unexpected(ErrorCode::FileReadFailed);
+    }
+
+    // Recently used entries survive eviction
+    std::error_code error;
+    std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), error);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_hits;
+    return std::move(*mapped);
+}
+
+Result<void> SongCache::store(const std::string& key, std::span<const uint8_t> bytes) {
+    auto path = entryPath(key);
+    std::error_code error;
+    if (std::filesystem::exists(path, error)) {
+        return {}; // Content-addressed: an existing entry already has these bytes
+    }
+
+    // Unique temporary name in the same directory, so the rename is atomic
+    thread_local std::mt19937_64 rng(std::random_device{}());
+    auto tempPath = m_directory / std::format("{}.tmp-{:016x}", key, rng());
+    {
+        std::ofstream file(tempPath, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        file.close();
+        if (!file) {
+            std::filesystem::remove(tempPath, error);
+            return std::unexpected(ErrorCode::FileWriteFailed);
+        }
+    }
+
+    std::filesystem::rename(tempPath, path, error);
+    if (error) {
+        std::filesystem::remove(tempPath, error);
+        return std::unexpected(ErrorCode::FileWriteFailed);
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_trackedBytes += bytes.size();
+    if (m_trackedBytes > m_maxBytes) {
+        evict();
+    }
+    return {};
+}
+
+uint64_t SongCache::getHits() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_hits;
+}
+
+uint64_t SongCache::getMisses() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_misses;
+}
+
+std::filesystem::path SongCache::entryPath(const std::string& key) const {
+    return m_directory / (key + ENTRY_EXTENSION);
+}
+
+void SongCache::evict() {
+    // Rescan rather than trusting m_trackedBytes, since other processes may
+    // share the directory. Oldest modification time goes first.
+    struct Entry {
+        std::filesystem::path path;
+        std::filesystem::file_time_type time;
+        uint64_t size;
+    };
+    std::vector<Entry> entries;
+    uint64_t total = 0;
+    auto now = std::filesystem::file_time_type::clock::now();
+
+    std::error_code error;
+    for (const auto& item : std::filesystem::directory_iterator(m_directory, error)) {
+        auto time = item.last_write_time(error);
+        if (error) continue;
+
+        if (item.path().extension() == ENTRY_EXTENSION) {
+            uint64_t size = item.file_size(error);
+            if (error) continue;
+            entries.push_back({item.path(), time, size});
+            total += size;
+        } else if (item.path().filename().string().find(".tmp-") != std::string::npos && now - time > STALE_TEMP_AGE) {
+            std::filesystem::remove(item.path(), error);
+        }
+    }
+
+    std::ranges::sort(entries, {}, &Entry::time);
+    for (const auto& entry : entries) {
+        if (total <= m_maxBytes) break;
+        // Mapped entries cannot be removed on Windows; they are retried on the next eviction
+        if (std::filesystem::remove(entry.path, error)) {
+            total -= entry.size;
+        }
+    }
+    m_trackedBytes = total;
+}
+
+} // namespace IndustrialMusic
\ No newline at end of file
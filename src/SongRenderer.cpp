@@ -0,0 +1,465 @@
+#include "SongRenderer.h"
+#include "ThreadPool.h"
+#include <fstream>
+#include <numbers>
+
+namespace IndustrialMusic {
+
+namespace {
+
+constexpr uint8_t DRUM_CHANNEL = 9;
+constexpr uint32_t DEFAULT_MICROS_PER_QUARTER = 500000; // 120 BPM
+
+float noteFrequency(uint8_t key) {
+    return 440.0f * std::exp2((static_cast<float>(key) - 69.0f) / 12.0f);
+}
+
+// Per-note noise source; seeded from the note so output is reproducible
+class Noise {
+public:
+    explicit Noise(uint32_t seed) : m_state(seed | 1) {}
+
+    float next() {
+        m_state ^= m_state << 13;
+        m_state ^= m_state >> 17;
+        m_state ^= m_state << 5;
+        return static_cast<int32_t>(m_state) * (1.0f / 2147483648.0f);
+    }
+
+private:
+    uint32_t m_state;
+};
+
+// Multiplier that decays an envelope by e^-rate per second
+float decayFactor(float ratePerSecond, uint32_t sampleRate) {
+    return std::exp(-ratePerSecond / static_cast<float>(sampleRate));
+}
+
+// One-pole lowpass coefficient
+float lowpassCoefficient(float cutoff, uint32_t sampleRate) {
+    return 1.0f - std::exp(-2.0f * std::numbers::pi_v<float> * cutoff / static_cast<float>(sampleRate));
+}
+
+} // namespace
+
+SongRenderer::TempoMap::TempoMap(const MidiReader& reader) {
+    std::vector<std::pair<uint32_t, uint32_t>> changes;
+    for (const auto& track : reader.getTracks()) {
+        for (const auto& event : track) {
+            if (event.status == 0xFF && event.metaType == 0x51 && event.data.size() == 3) {
+                uint32_t micros = (event.data[0] << 16) | (event.data[1] << 8) | event.data[2];
+                changes.emplace_back(event.tick, micros);
+            }
+        }
+    }
+    std::ranges::stable_sort(changes, {}, &std::pair<uint32_t, uint32_t>::first);
+
+    const double ticksPerQuarter = reader.getTicksPerQuarter();
+    auto secondsPerTick = [&](uint32_t micros) { return micros * 1e-6 / ticksPerQuarter; };
+
+    m_segments.push_back({0, 0.0, secondsPerTick(DEFAULT_MICROS_PER_QUARTER)});
+    for (const auto& [tick, micros] : changes) {
+        const Segment& last = m_segments.back();
+        double seconds = last.seconds + (tick - last.tick) * last.secondsPerTick;
+        if (tick == last.tick) {
+            m_segments.back().secondsPerTick = secondsPerTick(micros);
+        } else {
+            m_segments.push_back({tick, seconds, secondsPerTick(micros)});
+        }
+    }
+}
+
+double SongRenderer::TempoMap::secondsAt(uint32_t tick) const {
+    auto next = std::ranges::upper_bound(m_segments, tick, {}, &Segment::tick);
+    const Segment& segment = *std::prev(next);
+    return segment.seconds + (tick - segment.tick) * segment.secondsPerTick;
+}
+
+SongRenderer::SongRenderer(RenderSettings settings)
+    : m_settings(settings) {
+}
+
+Result<RenderedAudio> SongRenderer::render(std::span<const uint8_t> midiData) const {
+    auto reader = MidiReader::parse(midiData);
+    if (!reader) {
+        return std::unexpected(reader.error());
+    }
+
+    // SMPTE time division is not supported
+    uint16_t division = reader->getTicksPerQuarter();
+    if (division == 0 || (division & 0x8000) || m_settings.sampleRate == 0) {
+        return std::unexpected(ErrorCode::InvalidFileFormat);
+    }
+
+    return renderNotes(collectNotes(*reader, TempoMap(*reader)));
+}
+
+Result<RenderedAudio> SongRenderer::render(const SongPatterns& patterns, int tempo) const {
+    if (patterns.ticksPerQuarter == 0 || tempo <= 0 || m_settings.sampleRate == 0) {
+        return std::unexpected(ErrorCode::InvalidParameter);
+    }
+    return renderNotes(collectNotes(patterns, tempo));
+}
+
+RenderedAudio SongRenderer::renderNotes(const std::vector<RenderNote>& notes) const {
+    RenderedAudio audio;
+    audio.sampleRate = m_settings.sampleRate;
+    if (notes.empty()) {
+        return audio;
+    }
+
+    struct Batch {
+        size_t firstNote;
+        size_t lastNote;
+        uint32_t startSample;
+        std::vector<float> samples;
+    };
+
+    // Split notes into batches by start time. A batch spans from its first
+    // start to the end of its longest-ringing note.
+    const auto batchSamples = std::max<uint32_t>(static_cast<uint32_t>(m_settings.sampleRate * BATCH_SECONDS), 1);
+    std::vector<Batch> batches;
+    std::vector<size_t> batchLengths;
+    size_t totalSamples = 0;
+    for (size_t i = 0; i < notes.size();) {
+        uint32_t index = notes[i].startSample / batchSamples;
+        Batch batch{i, i, index * batchSamples, {}};
+        size_t end = batch.startSample;
+        for (; i < notes.size() && notes[i].startSample / batchSamples == index; ++i) {
+            end = std::max<size_t>(end, size_t{notes[i].startSample} + voiceLength(notes[i]));
+        }
+        batch.lastNote = i;
+        batches.push_back(std::move(batch));
+        batchLengths.push_back(end - batches.back().startSample);
+        totalSamples = std::max(totalSamples, end);
+    }
+
+    auto renderBatch = [&](size_t index) {
+        Batch& batch = batches[index];
+        batch.samples.assign(batchLengths[index], 0.0f);
+        for (size_t n = batch.firstNote; n < batch.lastNote; ++n) {
+            const RenderNote& note = notes[n];
+            renderNote(note, std::span(batch.samples).subspan(note.startSample - batch.startSample, voiceLength(note)));
+        }
+    };
+
+    if (m_threadPool) {
+        std::vector<std::future<void>> pending;
+        pending.reserve(batches.size());
+        for (size_t i = 0; i < batches.size(); ++i) {
+            pending.push_back(m_threadPool->submit([&renderBatch, i] { renderBatch(i); }));
+        }
+
+        // Let every task finish before rethrowing, since they write into `batches`
+        for (auto& result : pending) {
+            result.wait();
+        }
+        for (auto& result : pending) {
+            result.get();
+        }
+    } else {
+        for (size_t i = 0; i < batches.size(); ++i) {
+            renderBatch(i);
+        }
+    }
+
+    // Mix in fixed batch order so the sum does not depend on scheduling
+    audio.samples.assign(totalSamples, 0.0f);
+    for (auto& batch : batches) {
+        float* out = audio.samples.data() + batch.startSample;
+        for (size_t i = 0; i < batch.samples.size(); ++i) {
+            out[i] += batch.samples[i];
+        }
+        batch.samples = {};
+    }
+
+    // Master gain and tanh soft clipper, normalized so full scale stays full scale
+    const float drive = 1.0f + std::clamp(m_settings.distortion, 0.0f, 1.0f) * 4.0f;
+    const float makeup = m_settings.gain / std::tanh(drive);
+    for (float& sample : audio.samples) {
+        sample = std::tanh(sample * drive) * makeup;
+    }
+    return audio;
+}
+
+Result<void> SongRenderer::saveWav(const RenderedAudio& audio, const std::filesystem::path& filepath) {
+    std::ofstream file(filepath, std::ios::binary);
+    if (!file) {
+        return std::unexpected(ErrorCode::FileWriteFailed);
+    }
+
+    auto put16 = [&file](uint16_t value) {
+        const char bytes[2] = {static_cast<char>(value), static_cast<char>(value >> 8)};
+        file.write(bytes, 2);
+    };
+    auto put32 = [&file](uint32_t value) {
+        const char bytes[4] = {static_cast<char>(value), static_cast<char>(value >> 8),
+                               static_cast<char>(value >> 16), static_cast<char>(value >> 24)};
+        file.write(bytes, 4);
+    };
+
+    constexpr uint16_t CHANNELS = 1;
+    constexpr uint16_t BITS = 16;
+    const auto dataSize = static_cast<uint32_t>(audio.samples.size() * sizeof(int16_t));
+
+    file.write("RIFF", 4);
+    put32(36 + dataSize);
+    file.write("WAVEfmt ", 8);
+    put32(16);
+    put16(1); // PCM
+    put16(CHANNELS);
+    put32(audio.sampleRate);
+    put32(audio.sampleRate * CHANNELS * BITS / 8);
+    put16(CHANNELS * BITS / 8);
+    put16(BITS);
+    file.write("data", 4);
+    put32(dataSize);
+
+    // Convert through a small buffer rather than a second copy of the song
+    std::array<char, 16 * 1024> buffer;
+    size_t used = 0;
+    for (float sample : audio.samples) {
+        auto value = static_cast<int16_t>(std::lrint(std::clamp(sample, -1.0f, 1.0f) * 32767.0f));
+        buffer[used++] = static_cast<char>(value);
+        buffer[used++] = static_cast<char>(value >> 8);
+        if (used == buffer.size()) {
+            file.write(buffer.data(), used);
+            used = 0;
+        }
+    }
+    file.write(buffer.data(), used);
+
+    if (!file) {
+        return std::unexpected(ErrorCode::FileWriteFailed);
+    }
+    return {};
+}
+
+std::vector<SongRenderer::RenderNote> SongRenderer::collectNotes(const SongPatterns& patterns, int tempo) const {
+    // One tempo for the whole song. Times are worked out exactly as for the
+    // encoded file (whole microseconds per quarter), so both render the same.
+    const double secondsPerTick = (60000000 / tempo) * 1e-6 / patterns.ticksPerQuarter;
+    const double sampleRate = m_settings.sampleRate;
+    std::vector<RenderNote> notes;
+    size_t total = 0;
+    for (const auto& part : patterns.parts) {
+        total += part.size();
+    }
+    notes.reserve(total);
+
+    for (size_t index = 0; index < PATTERN_PART_COUNT; ++index) {
+        const NoteStream& part = patterns.parts[index];
+        auto which = static_cast<PatternPart>(index);
+        for (size_t i = 0; i < part.size(); ++i) {
+            RenderNote rendered;
+            double start = part.ticks[i] * secondsPerTick;
+            double end = (part.ticks[i] + part.durations[i]) * secondsPerTick;
+            rendered.startSample = static_cast<uint32_t>(start * sampleRate);
+            rendered.lengthSamples = static_cast<uint32_t>((end - start) * sampleRate);
+            rendered.frequency = noteFrequency(part.notes[i]);
+            rendered.velocity = part.velocities[i] / 127.0f;
+            switch (which) {
+                case PatternPart::Drums: rendered.voice = drumVoice(part.notes[i]); break;
+                case PatternPart::Bass:  rendered.voice = Voice::Bass; break;
+                case PatternPart::Lead:  rendered.voice = Voice::Lead; break;
+            }
+            notes.push_back(rendered);
+        }
+    }
+
+    // Each part is already in start order; merge them in a fixed part order
+    std::ranges::stable_sort(notes, {}, &RenderNote::startSample);
+    return notes;
+}
+
+std::vector<SongRenderer::RenderNote> SongRenderer::collectNotes(const MidiReader& reader, const TempoMap& tempo) const {
+    std::vector<RenderNote> notes;
+    const double sampleRate = m_settings.sampleRate;
+
+    for (const auto& track : reader.getTracks()) {
+        // Generated tracks set their program once up front
+        std::array<uint8_t, 16> programs{};
+        for (const auto& event : track) {
+            if ((event.status & 0xF0) == 0xC0 && !event.data.empty()) {
+                programs[event.status & 0x0F] = event.data[0];
+            }
+        }
+
+        for (const auto& note : MidiReader::extractNotes(track)) {
+            double start = tempo.secondsAt(note.startTick);
+            double end = tempo.secondsAt(note.startTick + note.duration);
+
+            RenderNote rendered;
+            rendered.startSample = static_cast<uint32_t>(start * sampleRate);
+            rendered.lengthSamples = static_cast<uint32_t>((end - start) * sampleRate);
+            rendered.frequency = noteFrequency(note.note);
+            rendered.velocity = note.velocity / 127.0f;
+
+            if (note.channel == DRUM_CHANNEL) {
+                rendered.voice = drumVoice(note.note);
+            } else {
+                // GM bass family is programs 33-40
+                uint8_t program = programs[note.channel & 0x0F];
+                rendered.voice = (program >= 32 && program < 40) ? Voice::Bass : Voice::Lead;
+            }
+            notes.push_back(rendered);
+        }
+    }
+
+    std::ranges::stable_sort(notes, {}, &RenderNote::startSample);
+    return notes;
+}
+
+SongRenderer::Voice SongRenderer::drumVoice(uint8_t key) {
+    switch (key) {
+        case 35: case 36:
+            return Voice::Kick;
+        case 37: case 38: case 39: case 40:
+            return Voice::Snare;
+        case 46:
+            return Voice::OpenHat;
+        case 49: case 51: case 52: case 55: case 57: case 59:
+            return Voice::Cymbal;
+        default:
+            return Voice::ClosedHat;
+    }
+}
+
+uint32_t SongRenderer::voiceLength(const RenderNote& note) const {
+    auto seconds = [this](float value) { return static_cast<uint32_t>(value * m_settings.sampleRate); };
+    switch (note.voice) {
+        case Voice::Kick:      return seconds(0.4f);
+        case Voice::Snare:     return seconds(0.25f);
+        case Voice::ClosedHat: return seconds(0.08f);
+        case Voice::OpenHat:   return seconds(0.4f);
+        case Voice::Cymbal:    return seconds(1.5f);
+        case Voice::Bass:      return note.lengthSamples + seconds(0.06f);
+        case Voice::Lead:      return note.lengthSamples + seconds(0.2f);
+    }
+    return 0;
+}
+
+void SongRenderer::renderNote(const RenderNote& note, std::span<float> out) const {
+    switch (note.voice) {
+        case Voice::Kick:      renderKick(note, out); break;
+        case Voice::Snare:     renderSnare(note, out); break;
+        case Voice::ClosedHat: renderHat(note, out, 60.0f, 0.3f); break;
+        case Voice::OpenHat:   renderHat(note, out, 9.0f, 0.25f); break;
+        case Voice::Cymbal:    renderHat(note, out, 3.0f, 0.2f); break;
+        case Voice::Bass:      renderBass(note, out); break;
+        case Voice::Lead:      renderLead(note, out); break;
+    }
+}
+
+void SongRenderer::renderKick(const RenderNote& note, std::span<float> out) const {
+    // Sine with a fast downward pitch sweep
+    const float sampleRate = static_cast<float>(m_settings.sampleRate);
+    const float ampDecay = decayFactor(9.0f, m_settings.sampleRate);
+    const float sweepDecay = decayFactor(30.0f, m_settings.sampleRate);
+    float amp = note.velocity;
+    float sweep = 110.0f;
+    float phase = 0.0f;
+    for (float& sample : out) {
+        sample += std::sin(2.0f * std::numbers::pi_v<float> * phase) * amp;
+        phase += (45.0f + sweep) / sampleRate;
+        phase -= std::floor(phase);
+        amp *= ampDecay;
+        sweep *= sweepDecay;
+    }
+}
+
+void SongRenderer::renderSnare(const RenderNote& note, std::span<float> out) const {
+    // Noise burst over a short 185 Hz body
+    const float phaseStep = 185.0f / static_cast<float>(m_settings.sampleRate);
+    const float noiseDecay = decayFactor(22.0f, m_settings.sampleRate);
+    const float toneDecay = decayFactor(35.0f, m_settings.sampleRate);
+    Noise noise(note.startSample * 2654435761u);
+    float noiseAmp = note.velocity * 0.6f;
+    float toneAmp = note.velocity * 0.5f;
+    float phase = 0.0f;
+    for (float& sample : out) {
+        sample += noise.next() * noiseAmp + std::sin(2.0f * std::numbers::pi_v<float> * phase) * toneAmp;
+        phase += phaseStep;
+        phase -= std::floor(phase);
+        noiseAmp *= noiseDecay;
+        toneAmp *= toneDecay;
+    }
+}
+
+void SongRenderer::renderHat(const RenderNote& note, std::span<float> out, float decayPerSecond, float level) const {
+    // First-difference highpassed noise
+    const float decay = decayFactor(decayPerSecond, m_settings.sampleRate);
+    Noise noise(note.startSample * 2246822519u + static_cast<uint32_t>(note.frequency));
+    float amp = note.velocity * level;
+    float previous = 0.0f;
+    for (float& sample : out) {
+        float current = noise.next();
+        sample += (current - previous) * amp;
+        previous = current;
+        amp *= decay;
+    }
+}
+
+void SongRenderer::renderBass(const RenderNote& note, std::span<float> out) const {
+    // Saw plus a square sub-octave through a lowpass that opens with velocity
+    const uint32_t attack = m_settings.sampleRate / 300;
+    const float releaseDecay = decayFactor(80.0f, m_settings.sampleRate);
+    const float phaseStep = note.frequency / static_cast<float>(m_settings.sampleRate);
+    const float cutoff = lowpassCoefficient(300.0f + 900.0f * note.velocity, m_settings.sampleRate);
+    float phase = 0.0f;
+    float subPhase = 0.0f;
+    float filtered = 0.0f;
+    float env = 0.0f;
+    for (uint32_t i = 0; i < out.size(); ++i) {
+        if (i < attack) {
+            env = static_cast<float>(i) / attack;
+        } else if (i >= note.lengthSamples) {
+            env *= releaseDecay;
+        } else {
+            env = 1.0f;
+        }
+
+        float raw = (2.0f * phase - 1.0f) + (subPhase < 0.5f ? 0.5f : -0.5f);
+        filtered += cutoff * (raw - filtered);
+        out[i] += filtered * env * note.velocity * 0.45f;
+
+        phase += phaseStep;
+        phase -= std::floor(phase);
+        subPhase += phaseStep * 0.5f;
+        subPhase -= std::floor(subPhase);
+    }
+}
+
+void SongRenderer::renderLead(const RenderNote& note, std::span<float> out) const {
+    // Two detuned saws through a lowpass
+    const uint32_t attack = m_settings.sampleRate / 100;
+    const float releaseDecay = decayFactor(25.0f, m_settings.sampleRate);
+    const float baseStep = note.frequency / static_cast<float>(m_settings.sampleRate);
+    const float stepA = baseStep * 1.007f;
+    const float stepB = baseStep * 0.993f;
+    const float cutoff = lowpassCoefficient(2500.0f, m_settings.sampleRate);
+    float phaseA = 0.0f;
+    float phaseB = 0.5f;
+    float filtered = 0.0f;
+    float env = 0.0f;
+    for (uint32_t i = 0; i < out.size(); ++i) {
+        if (i < attack) {
+            env = static_cast<float>(i) / attack;
+        } else if (i >= note.lengthSamples) {
+            env *= releaseDecay;
+        } else {
+            env = 1.0f;
+        }
+
+        float raw = (2.0f * phaseA - 1.0f) + (2.0f * phaseB - 1.0f);
+        filtered += cutoff * (raw - filtered);
+        out[i] += filtered * env * note.velocity * 0.18f;
+
+        phaseA += stepA;
+        phaseA -= std::floor(phaseA);
+        phaseB += stepB;
+        phaseB -= std::floor(phaseB);
+    }
+}
+
+} // namespace IndustrialMusic
\ No newline at end of file
@@ -6,44 +6,117 @@ namespace IndustrialMusic {
 SongStructure::SongStructure() {
     // Start with a default structure
     loadPreset("standard");
+    clearHistory();
 }
 
 void SongStructure::addSection(const Section& section) {
-    m_sections.push_back(section);
-    notifyChange(m_sections.size() - 1);
+    // A new variation, so an added or duplicated section is not a copy
+    Section added = section;
+    m_variations.assign(added);
+    commit({{m_current.size(), {}, SectionList().pushBack(std::move(added))}});
+    notifyChange(m_current.size() - 1);
 }
 
 void SongStructure::removeSection(size_t index) {
-    if (index >= m_sections.size()) return;
+    if (index >= m_current.size()) return;
     
-    m_sections.erase(m_sections.begin() + index);
+    commit({{index, m_current.slice(index, index + 1), {}}});
     notifyChange(index);
 }
 
 void SongStructure::moveSection(size_t from, size_t to) {
-    if (from >= m_sections.size() || to >= m_sections.size()) return;
+    if (from >= m_current.size() || to >= m_current.size()) return;
     if (from == to) return;
     
-    Section section = m_sections[from];
-    m_sections.erase(m_sections.begin() + from);
-    
-    if (to > from) {
-        m_sections.insert(m_sections.begin() + to - 1, section);
-    } else {
-        m_sections.insert(m_sections.begin() + to, section);
-    }
+    size_t target = to > from ? to - 1 : to;
+    SectionList moved = m_current.slice(from, from + 1);
+    commit({{from, moved, {}}, {target, {}, moved}});
     
     notifyChange(std::min(from, to));
 }
 
 void SongStructure::clearSections() {
-    m_sections.clear();
+    commit({{0, m_current, {}}});
+    notifyChange(0);
+}
+
+void SongStructure::setSections(const std::vector<Section>& sections) {
+    for (const auto& section : sections) {
+        m_variations.reserve(section);
+    }
+    commit({{0, m_current, SectionList(sections)}});
     notifyChange(0);
 }
 
+bool SongStructure::undo() {
+    if (m_undoStack.empty()) return false;
+    
+    HistoryStep step = std::move(m_undoStack.back());
+    m_undoStack.pop_back();
+    
+    // Run the step backwards: each splice undone, last first
+    std::vector<SectionSplice> inverse;
+    inverse.reserve(step.splices.size());
+    for (auto it = step.splices.rbegin(); it != step.splices.rend(); ++it) {
+        inverse.push_back({it->index, it->inserted, it->removed});
+    }
+    m_redoStack.push_back({std::move(m_current), std::move(step.splices)});
+    m_current = std::move(step.sections);
+    logChanges(inverse);
+    notifyChange(0);
+    return true;
+}
+
+bool SongStructure::redo() {
+    if (m_redoStack.empty()) return false;
+    
+    HistoryStep step = std::move(m_redoStack.back());
+    m_redoStack.pop_back();
+    
+    logChanges(step.splices);
+    m_undoStack.push_back({std::move(m_current), std::move(step.splices)});
+    m_current = std::move(step.sections);
+    notifyChange(0);
+    return true;
+}
+
+void SongStructure::clearHistory() {
+    m_undoStack.clear();
+    m_redoStack.clear();
+}
+
+size_t SongStructure::getHistoryNodeCount() const {
+    std::vector<SectionList> versions;
+    versions.reserve(m_undoStack.size() + m_redoStack.size() + 1);
+    versions.push_back(m_current);
+    for (const auto& step : m_undoStack) {
+        versions.push_back(step.sections);
+    }
+    for (const auto& step : m_redoStack) {
+        versions.push_back(step.sections);
+    }
+    return SectionList::countNodes(versions);
+}
+
+std::optional<std::vector<SectionSplice>> SongStructure::getChangesSince(uint64_t since) const {
+    uint64_t oldest = m_version - m_changes.size();
+    if (since < oldest || since > m_version) {
+        return std::nullopt;
+    }
+    return std::vector<SectionSplice>(m_changes.begin() + static_cast<ptrdiff_t>(since - oldest), m_changes.end());
+}
+
+const std::vector<Section>& SongStructure::getSections() const {
+    if (m_sectionsStale) {
+        m_sections = m_current.toVector();
+        m_sectionsStale = false;
+    }
+    return m_sections;
+}
+
 const Section* SongStructure::getSection(size_t index) const {
-    if (index >= m_sections.size()) return nullptr;
-    return &m_sections[index];
+    if (index >= m_current.size()) return nullptr;
+    return &m_current[index];
 }
 
 void SongStructure::loadPreset(const std::string& presetName) {
@@ -64,7 +137,7 @@ std::vector<std::string> SongStructure::getAvailablePresets() const {
 
 int SongStructure::getTotalBeats() const {
     int total = 0;
-    for (const auto& section : m_sections) {
+    for (const auto& section : getSections()) {
         total += section.totalBeats();
     }
     return total;
@@ -75,49 +148,68 @@ float SongStructure::getTotalDuration(int bpm) const {
 }
 
 int SongStructure::getBeatsUntilSection(size_t sectionIndex) const {
-    if (sectionIndex >= m_sections.size()) return getTotalBeats();
+    if (sectionIndex >= m_current.size()) return getTotalBeats();
     
+    const auto& sections = getSections();
     int beats = 0;
     for (size_t i = 0; i < sectionIndex; ++i) {
-        beats += m_sections[i].totalBeats();
+        beats += sections[i].totalBeats();
     }
     return beats;
 }
 
 bool SongStructure::isValid() const {
-    return !m_sections.empty();
+    return !m_current.empty();
 }
 
 std::string SongStructure::getValidationError() const {
-    if (m_sections.empty()) {
+    if (m_current.empty()) {
         return "Song structure is empty";
     }
     return "";
 }
 
 void SongStructure::createStandardPreset() {
-    m_sections = Presets::getStandardStructure();
-    notifyChange(0);
+    setSections(Presets::getStandardStructure());
 }
 
 void SongStructure::createSimplePreset() {
-    m_sections = Presets::getSimpleStructure();
-    notifyChange(0);
+    setSections(Presets::getSimpleStructure());
 }
 
 void SongStructure::createExtendedPreset() {
-    m_sections = Presets::getExtendedStructure();
-    notifyChange(0);
+    setSections(Presets::getExtendedStructure());
 }
 
 void SongStructure::createIndustrialPreset() {
-    m_sections = Presets::getIndustrialStructure();
-    notifyChange(0);
+    setSections(Presets::getIndustrialStructure());
+}
+
+void SongStructure::commit(std::vector<SectionSplice> splices) {
+    SectionList next = m_current;
+    for (const auto& splice : splices) {
+        next = next.erase(splice.index, splice.index + splice.removed.size()).insert(splice.index, splice.inserted);
+    }
+    logChanges(splices);
+    m_undoStack.push_back({std::move(m_current), std::move(splices)});
+    m_current = std::move(next);
+    m_redoStack.clear();
+}
+
+void SongStructure::logChanges(const std::vector<SectionSplice>& splices) {
+    for (const auto& splice : splices) {
+        ++m_version;
+        m_changes.push_back(splice);
+        if (m_changes.size() > MAX_LOGGED_CHANGES) {
+            m_changes.pop_front();
+        }
+    }
+    m_sectionsStale = true;
 }
 
 void SongStructure::notifyChange(size_t index) {
-    if (m_onSectionChange && index < m_sections.size()) {
-        m_onSectionChange(index, m_sections[index]);
+    if (m_onSectionChange && index < m_current.size()) {
+        m_onSectionChange(index, m_current[index]);
     }
 }
 
@@ -7,7 +7,12 @@
 #include "MidiGenerator.h"
 #include "SongStructure.h"
 #include "LyricsGenerator.h"
+#include "LiveSong.h"
 #include "VocalSynthesizer.h"
+#include "SongRenderer.h"
+#include "ProjectFile.h"
+#include "ArrangementGenerator.h"
+#include "WordBankPack.h"
 
 #include <imgui.h>
 #include <format>
@@ -15,10 +20,21 @@
 
 namespace IndustrialMusic {
 
+namespace {
+
+// Where the lyrics window looks for word-bank packs
+const std::filesystem::path WORD_PACK_DIRECTORY = "assets/wordpacks";
+
+} // namespace
+
 MainWindow::MainWindow(Application& app) : m_app(app) {
     m_structureEditor = std::make_unique<SongStructureEditor>(app.getSongStructure());
     m_controlPanel = std::make_unique<ControlPanel>(app.getAudioEngine());
     m_visualizer3D = std::make_unique<Visualizer3D>(app.getVisualizer());
+    
+    const auto& patterns = app.getMidiGenerator().getPatternEngine();
+    m_liveSong = std::make_unique<LiveSong>(patterns, app.getLyricsGenerator(), app.getVocalSynthesizer());
+    m_endlessSong = std::make_unique<LiveSong>(patterns, app.getLyricsGenerator(), app.getVocalSynthesizer());
 }
 
 MainWindow::~MainWindow() = default;
@@ -34,6 +50,13 @@ void MainWindow::render() {
         m_structureEditor->render();
     }
     
+    // Follow structure edits once a song exists
+    if (m_endless) {
+        advanceEndless();
+    } else if (m_song && m_app.getSongStructure().getVersion() != m_songVersion) {
+        updateSong();
+    }
+    
     ImGui::Separator();
     
     // Control panel
@@ -104,9 +127,19 @@ void MainWindow::render() {
 void MainWindow::renderMenuBar() {
     if (ImGui::BeginMainMenuBar()) {
         if (ImGui::BeginMenu("File")) {
+            if (ImGui::MenuItem("Open Project...")) {
+                onOpenProject();
+            }
+            if (ImGui::MenuItem("Save Project...")) {
+                onSaveProject();
+            }
+            ImGui::Separator();
             if (ImGui::MenuItem("Export MIDI...")) {
                 onDownloadMidi();
             }
+            if (ImGui::MenuItem("Export Audio (WAV)...")) {
+                onExportAudio();
+            }
             if (ImGui::MenuItem("Export Lyrics...")) {
                 onExportLyrics();
             }
@@ -183,32 +216,89 @@ void MainWindow::renderLyricsWindow() {
     if (ImGui::Button("Export .txt")) {
         onExportLyrics();
     }
+    ImGui::SameLine();
+    renderWordPackPicker();
     
     ImGui::Separator();
     
     ImGui::BeginChild("LyricsContent", ImVec2(0, 0), true);
-    for (const auto& line : m_currentLyrics) {
-        ImGui::TextWrapped("%s", line.c_str());
-    }
+    int verseCount = 0;
+    m_liveSong->getSections().forEach([&](const SongSection& entry) {
+        if (auto header = LyricsGenerator::sectionHeader(entry.section, verseCount)) {
+            ImGui::TextWrapped("%s", header->c_str());
+        }
+        if (entry.lyrics) {
+            for (const auto& line : entry.lyrics->lines) {
+                ImGui::TextWrapped("%s", line.c_str());
+            }
+        }
+    });
     ImGui::EndChild();
     
     ImGui::End();
 }
 
+void MainWindow::renderWordPackPicker() {
+    if (!ImGui::BeginCombo("##WordPack", m_wordPackName.c_str())) {
+        return;
+    }
+    
+    // Rescan only as the list opens, not every frame it stays open
+    if (ImGui::IsWindowAppearing()) {
+        m_wordPacks.clear();
+        std::error_code error;
+        for (const auto& entry : std::filesystem::directory_iterator(WORD_PACK_DIRECTORY, error)) {
+            if (entry.path().extension() == WordBankPack::EXTENSION) {
+                m_wordPacks.push_back(entry.path());
+            }
+        }
+        std::ranges::sort(m_wordPacks);
+    }
+    
+    if (ImGui::Selectable("Built-in", !m_app.getLyricsGenerator().getWordBankPack())) {
+        onSelectWordPack({});
+    }
+    for (const auto& pack : m_wordPacks) {
+        std::string name = pack.stem().string();
+        bool isSelected = name == m_wordPackName;
+        
+        if (ImGui::Selectable(name.c_str(), isSelected)) {
+            onSelectWordPack(pack);
+        }
+        
+        if (isSelected) {
+            ImGui::SetItemDefaultFocus();
+        }
+    }
+    
+    ImGui::EndCombo();
+}
+
 void MainWindow::renderVocalOutputWindow() {
     ImGui::Begin("Vocal Output", &m_showVocalOutput);
     
     auto& audio = m_app.getAudioEngine();
     if (audio.isPlaying()) {
-        int sectionIndex = audio.getCurrentSectionIndex();
-        auto sections = m_app.getSongStructure().getSections();
+        // The snapshot being played; no copy, no lock
+        auto song = audio.getSong();
         
-        if (sectionIndex < sections.size()) {
-            std::string sectionName = sectionTypeToString(sections[sectionIndex].type);
-            ImGui::Text("Section: %s", sectionName.c_str());
+        // Indexed by beat in the vocals compiled with the section being
+        // played, counting from the start of the song (or, in continuous
+        // mode, the window)
+        std::string_view vocalText;
+        if (song) {
+            auto [entry, start] = sectionAt(song->sections, static_cast<int64_t>(audio.getCurrentBeat()));
+            if (entry) {
+                std::string sectionName = sectionTypeToString(entry->section.type);
+                ImGui::Text("Section: %s", sectionName.c_str());
+            }
+            if (entry && entry->vocals) {
+                const VocalEvent* vocal = entry->vocals->activeAt(static_cast<int>(audio.getCurrentBeat() - start));
+                vocalText = vocal ? entry->vocals->text(*vocal) : std::string_view();
+            }
         }
         
-        ImGui::Text("Current Vocal: %s", m_currentVocalText.c_str());
+        ImGui::Text("Current Vocal: %.*s", static_cast<int>(vocalText.size()), vocalText.data());
         ImGui::Text("Beat: %.0f", audio.getCurrentBeat());
     }
     
@@ -218,22 +308,94 @@ void MainWindow::renderVocalOutputWindow() {
 void MainWindow::onGenerateSong() {
     m_statusText = "Generating song...";
     
-    // Generate lyrics
-    m_currentLyrics = m_app.getLyricsGenerator().generate(
-        m_app.getSongStructure().getSections(),
-        std::chrono::steady_clock::now().time_since_epoch().count()
-    );
-    
-    // Update audio engine with current structure
-    m_app.getAudioEngine().setSongSections(m_app.getSongStructure().getSections());
+    m_songSeed = static_cast<uint32_t>(std::chrono::steady_clock::now().time_since_epoch().count());
     
-    // Update vocal synthesizer
+    // Vocals are compiled in the style set when their section is built
     m_app.getVocalSynthesizer().setVocalType(m_currentParams.vocalType);
+    rebuildSong();
     
     m_statusText = "Song generated!";
     m_showLyrics = true;
 }
 
+void MainWindow::rebuildSong() {
+    auto& structure = m_app.getSongStructure();
+    m_songVersion = structure.getVersion();
+    
+    // Sections already generated with this seed come from the section caches
+    m_liveSong->rebuild(structure.getSectionList(), {m_currentParams.intensity, m_songSeed, m_songSeed});
+    
+    // Continuous mode restarts from the new song
+    if (m_endless) {
+        startEndless();
+        return;
+    }
+    publishSong();
+}
+
+void MainWindow::updateSong() {
+    auto& structure = m_app.getSongStructure();
+    auto changes = structure.getChangesSince(m_songVersion);
+    
+    // Too far behind to replay, or the notes of every section are different
+    if (!changes || m_currentParams.intensity != m_liveSong->getSettings().intensity) {
+        rebuildSong();
+        return;
+    }
+    
+    // Only the sections each edit inserted are generated; the rest of the
+    // song is shared with the version already published
+    m_songVersion = structure.getVersion();
+    for (const auto& change : *changes) {
+        m_liveSong->splice(change.index, change.removed.size(), change.inserted);
+    }
+    publishSong();
+}
+
+void MainWindow::publishSong() {
+    auto& vocals = m_app.getVocalSynthesizer();
+    vocals.setTempo(m_currentParams.tempo);
+    
+    // In continuous mode the window is played; vocals count beats from its
+    // start as the audio engine does
+    const LiveSong& song = m_endless ? *m_endlessSong : *m_liveSong;
+    if (m_endless) {
+        m_song = m_app.getAudioEngine().publishSong(song.getSections(), m_endless->getFirstSection(), m_endless->getFirstBeat());
+    } else {
+        m_song = m_app.getAudioEngine().publishSong(song.getSections());
+    }
+    vocals.setSong(song.getSections());
+}
+
+void MainWindow::startEndless() {
+    // Play the arrangement once, then keep generating sections after it
+    m_endless = std::make_unique<EndlessArrangement>(m_app.getSongStructure().getSections(),
+                                                     ArrangementRules::industrial(), m_songSeed);
+    
+    auto settings = m_liveSong->getSettings();
+    settings.intensity = m_currentParams.intensity;
+    settings.seed = m_songSeed;
+    m_endlessSong->rebuild(SectionList(m_endless->getSections()), settings);
+    publishSong();
+}
+
+void MainWindow::advanceEndless() {
+    uint64_t firstSection = m_endless->getFirstSection();
+    if (!m_endless->advance(m_app.getAudioEngine().getPlayingSectionNumber())) {
+        return;
+    }
+    
+    // Sections keep their variations (and seeds) as the window slides, so
+    // only the ones appended are generated; the rest stay as they are
+    size_t retired = std::min<size_t>(m_endless->getFirstSection() - firstSection, m_endlessSong->getSections().size());
+    m_endlessSong->splice(0, retired, {});
+    
+    std::span<const Section> window = m_endless->getSections();
+    size_t kept = std::min(m_endlessSong->getSections().size(), window.size());
+    m_endlessSong->splice(kept, 0, SectionList(window.subspan(kept)));
+    publishSong();
+}
+
 void MainWindow::onPlaySong() {
     if (!m_app.getAudioEngine().isPlaying()) {
         m_app.getAudioEngine().play();
@@ -249,41 +411,81 @@ void MainWindow::onStopSong() {
 }
 
 void MainWindow::onLoopToggle() {
-    bool isLooping = !m_app.getAudioEngine().isLooping();
-    m_app.getAudioEngine().setLooping(isLooping);
-    m_statusText = isLooping ? "Looping enabled" : "Looping disabled";
+    auto& audio = m_app.getAudioEngine();
+    if (m_endless) {
+        m_endless.reset();
+        audio.setLooping(false);
+        rebuildSong();
+        m_statusText = "Continuous music off";
+        return;
+    }
+    
+    // Looping only matters if the window is not topped up in time
+    audio.setLooping(true);
+    startEndless();
+    m_statusText = "Continuous music on";
 }
 
 void MainWindow::onDownloadMidi() {
-    auto result = m_app.getMidiGenerator().generate(
+    // Stream straight to disk; long songs are never held in memory
+    auto result = m_app.getMidiGenerator().generateToFile(
         m_app.getSongStructure().getSections(),
         m_currentParams,
-        std::chrono::steady_clock::now().time_since_epoch().count()
+        "industrial_song.mid",
+        m_songSeed
     );
     
     if (result) {
-        auto saveResult = m_app.getMidiGenerator().saveToFile(
-            result.value(),
-            "industrial_song.mid"
-        );
-        
-        if (saveResult) {
-            m_statusText = "MIDI file saved!";
-        } else {
-            m_statusText = "Failed to save MIDI file";
-        }
+        m_statusText = "MIDI file saved!";
+    } else if (result.error() == ErrorCode::FileWriteFailed) {
+        m_statusText = "Failed to save MIDI file";
     } else {
         m_statusText = "Failed to generate MIDI";
     }
 }
 
+void MainWindow::onExportAudio() {
+    // Rendered straight from the patterns; sections already generated for
+    // playback or MIDI export come from the section cache
+    auto patterns = m_app.getMidiGenerator().getPatternEngine().generateSong(
+        m_app.getSongStructure().getSections(),
+        m_currentParams.intensity,
+        m_songSeed
+    );
+    
+    auto& renderer = m_app.getSongRenderer();
+    RenderSettings settings = renderer.getSettings();
+    settings.distortion = m_currentParams.distortion / 100.0f;
+    renderer.setSettings(settings);
+    
+    auto audio = renderer.render(patterns, m_currentParams.tempo);
+    if (!audio) {
+        m_statusText = "Failed to render audio";
+        return;
+    }
+    
+    if (SongRenderer::saveWav(*audio, "industrial_song.wav")) {
+        m_statusText = "Audio file saved!";
+    } else {
+        m_statusText = "Failed to save audio file";
+    }
+}
+
 void MainWindow::onRegenerateLyrics() {
-    m_currentLyrics = m_app.getLyricsGenerator().regenerate();
+    // Same notes, new words in every section
+    uint32_t lyricsSeed = m_liveSong->getSettings().lyricsSeed + 1;
+    m_liveSong->rebuildLyrics(lyricsSeed);
+    if (m_endless) {
+        m_endlessSong->rebuildLyrics(lyricsSeed);
+    }
+    if (m_song) {
+        publishSong();
+    }
 }
 
 void MainWindow::onExportLyrics() {
     auto result = m_app.getLyricsGenerator().exportToFile(
-        m_currentLyrics,
+        m_liveSong->getLyrics(),
         "lyrics.txt"
     );
     
@@ -294,4 +496,78 @@ void MainWindow::onExportLyrics() {
     }
 }
 
+void MainWindow::onSelectWordPack(const std::filesystem::path& filepath) {
+    auto& lyrics = m_app.getLyricsGenerator();
+    if (filepath.empty()) {
+        lyrics.setWordBankPack(nullptr);
+        m_wordPackName = "Built-in";
+    } else {
+        auto pack = WordBankPack::open(filepath);
+        if (!pack) {
+            m_statusText = std::format("Cannot load word pack '{}'", filepath.stem().string());
+            return;
+        }
+        lyrics.setWordBankPack(std::make_shared<const WordBankPack>(std::move(*pack)));
+        m_wordPackName = filepath.stem().string();
+    }
+    
+    // Same seed, new words
+    m_liveSong->rebuildLyrics(m_liveSong->getSettings().lyricsSeed);
+    if (m_endless) {
+        m_endlessSong->rebuildLyrics(m_endlessSong->getSettings().lyricsSeed);
+    }
+    if (m_song) {
+        publishSong();
+    }
+    m_statusText = std::format("Word pack: {}", m_wordPackName);
+}
+
+void MainWindow::onSaveProject() {
+    Project project;
+    project.sections = m_app.getSongStructure().getSections();
+    project.params = m_currentParams;
+    project.songSeed = m_songSeed;
+    project.lyrics = m_liveSong->getLyrics();
+    project.automation = m_automation;
+    
+    if (ProjectFile::save(project, "industrial_song.immp")) {
+        m_statusText = "Project saved!";
+    } else {
+        m_statusText = "Failed to save project";
+    }
+}
+
+void MainWindow::onOpenProject() {
+    auto file = ProjectFile::open("industrial_song.immp");
+    if (!file) {
+        m_statusText = "Failed to open project";
+        return;
+    }
+    
+    auto project = file->load();
+    if (!project) {
+        m_statusText = "Project file is damaged";
+        return;
+    }
+    
+    // One undo step, like loading a preset
+    m_app.getSongStructure().setSections(project->sections);
+    m_currentParams = project->params;
+    m_controlPanel->setParams(project->params);
+    m_app.getVocalSynthesizer().setVocalType(project->params.vocalType);
+    m_songSeed = project->songSeed;
+    m_automation = std::move(project->automation);
+    
+    // Same seed, so the song comes back exactly as saved
+    rebuildSong();
+    if (!project->lyrics.empty()) {
+        m_liveSong->setLyrics(project->lyrics);
+        if (!m_endless) {
+            publishSong();
+        }
+    }
+    
+    m_statusText = "Project loaded!";
+}
+
 } // namespace IndustrialMusic
\ No newline at end of file
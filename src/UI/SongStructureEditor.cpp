@@ -35,7 +35,21 @@ void SongStructureEditor::renderPresetButtons() {
         }
         ImGui::SameLine();
     }
-    ImGui::NewLine();
+    
+    ImGui::BeginDisabled(!m_songStructure.canUndo());
+    if (ImGui::Button("Undo")) {
+        m_songStructure.undo();
+        m_infoText = "Undid last change";
+    }
+    ImGui::EndDisabled();
+    ImGui::SameLine();
+    
+    ImGui::BeginDisabled(!m_songStructure.canRedo());
+    if (ImGui::Button("Redo")) {
+        m_songStructure.redo();
+        m_infoText = "Redid last change";
+    }
+    ImGui::EndDisabled();
 }
 
 void SongStructureEditor::renderSectionPalette() {
@@ -82,7 +96,7 @@ void SongStructureEditor::renderStructureEditor() {
     
     ImGui::BeginChild("StructureEditor", ImVec2(0, 200), true);
     
-    auto& sections = m_songStructure.getSections();
+    const auto& sections = m_songStructure.getSections();
     
     if (sections.empty()) {
         ImGui::TextColored(ImVec4(0.5f, 0.5f, 0.5f, 1.0f), 
@@ -141,8 +155,7 @@ void SongStructureEditor::renderSectionBlock(size_t index, const Section& sectio
         if (const ImGuiPayload* payload = ImGui::AcceptDragDropPayload("SECTION_MOVE")) {
             size_t sourceIndex = *(const size_t*)payload->Data;
             if (sourceIndex != index) {
-                // Move section
-                // Note: This is a simplified version
+                m_songStructure.moveSection(sourceIndex, index);
                 m_infoText = "Moved section";
             }
         }
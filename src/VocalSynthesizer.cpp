@@ -4,92 +4,101 @@
 
 namespace IndustrialMusic {
 
-VocalSynthesizer::VocalSynthesizer() = default;
+namespace {
 
-std::optional<std::string> VocalSynthesizer::generateVocal(
-    const Section& section,
-    int beat,
-    const std::vector<std::string>& lyrics) {
-    
-    if (m_vocalType == AudioParams::VocalType::Off) {
-        return std::nullopt;
-    }
-    
-    // Generate vocals at specific intervals based on section type
-    bool shouldVocalize = false;
-    
-    switch (section.type) {
-        case SectionType::Verse:
-            shouldVocalize = (beat % 8) == 0;
-            break;
-        case SectionType::Chorus:
-            shouldVocalize = (beat % 4) == 0;
-            break;
-        case SectionType::Bridge:
-            shouldVocalize = (beat % 16) == 0;
-            break;
-        case SectionType::Breakdown:
-            shouldVocalize = (beat % 32) == 0;
-            break;
-        default:
-            shouldVocalize = false;
-            break;
-    }
-    
-    if (!shouldVocalize || lyrics.empty()) {
-        return std::nullopt;
-    }
-    
-    // Select a line from lyrics based on section and beat
-    size_t lineIndex = (beat / 8) % lyrics.size();
-    std::string vocal = lyrics[lineIndex];
-    
-    // Apply vocal style modifications
-    switch (m_vocalType) {
+VoiceSettings voiceFor(AudioParams::VocalType type) {
+    VoiceSettings voice;
+    switch (type) {
         case AudioParams::VocalType::Robotic:
-            std::transform(vocal.begin(), vocal.end(), vocal.begin(), ::toupper);
-            vocal = "[" + vocal + "]";
+            // Monotone and buzzy
+            voice.pitch = 100.0f;
+            voice.stressPitch = 0.0f;
+            voice.openQuotient = 0.4f;
+            voice.aspiration = 0.0f;
             break;
             
         case AudioParams::VocalType::Whisper:
-            std::transform(vocal.begin(), vocal.end(), vocal.begin(), ::tolower);
-            vocal = "..." + vocal + "...";
+            voice.voicing = 0.0f;
+            voice.rate = 0.9f;
+            voice.gain = 1.0f;
             break;
             
         case AudioParams::VocalType::Distorted:
-            // Add some "distortion" characters
-            for (size_t i = 0; i < vocal.length(); i += 3) {
-                if (i < vocal.length()) {
-                    vocal[i] = std::toupper(vocal[i]);
-                }
-            }
-            vocal = "!" + vocal + "!";
+            // Low and rough; the clipper adds the rest
+            voice.pitch = 85.0f;
+            voice.jitter = 0.05f;
+            voice.openQuotient = 0.5f;
+            voice.aspiration = 0.1f;
+            voice.gain = 0.35f;
             break;
             
         default:
             break;
     }
+    return voice;
+}
+
+} // namespace
+
+VocalSynthesizer::VocalSynthesizer()
+    : m_song(std::make_shared<const SongSections>()) {
+}
+
+std::shared_ptr<const SectionVocals> VocalSynthesizer::compileVocals(const Section& section, const SectionLyrics& lyrics) {
+    return std::make_shared<const SectionVocals>(
+        SectionVocals::compile(section, lyrics.lines, m_vocalType.load(), m_phonemizer, lyrics.prosody));
+}
+
+void VocalSynthesizer::setSong(SongSections sections) {
+    // The audio thread only takes new references from m_song, so a retired
+    // song held by nothing else stays that way and is freed here
+    std::erase_if(m_retired, [](const auto& retired) { return retired.use_count() == 1; });
     
-    m_currentVocal = vocal;
+    auto next = std::make_shared<const SongSections>(std::move(sections));
+    m_retired.push_back(m_song.exchange(std::move(next), std::memory_order_acq_rel));
+}
+
+std::optional<VocalEvent> VocalSynthesizer::onBeat(int beat) {
+    if (beat == m_lastVocalBeat) {
+        return std::nullopt;
+    }
     m_lastVocalBeat = beat;
     
-    return vocal;
+    // A song published since the last beat takes over here. Every reference
+    // dropped on this thread has another owner: m_song, or the retired list
+    // until the UI thread frees it.
+    auto song = m_song.load(std::memory_order_acquire);
+    auto [entry, start] = sectionAt(*song, beat);
+    if (!entry || !entry->vocals) {
+        return std::nullopt;
+    }
+    const SectionVocals& vocals = *entry->vocals;
+    const VocalEvent* event = vocals.eventAt(static_cast<int>(beat - start));
+    if (!event) {
+        return std::nullopt;
+    }
+    
+    // Sing it, finishing before the next vocal is due. The line being
+    // replaced is still owned by m_playing until the new line has started.
+    float maxSeconds = static_cast<float>(event->beats) * 60.0f / static_cast<float>(m_tempo.load());
+    m_voice.start(vocals.phonemes(*event), voiceFor(m_vocalType.load()), maxSeconds);
+    m_playing = std::move(song);
+    return *event;
 }
 
 void VocalSynthesizer::processAudio(std::span<float> buffer, float sampleRate) {
     // Apply vocal effects to audio buffer
-    if (m_vocalType == AudioParams::VocalType::Off) {
+    const AudioParams::VocalType type = m_vocalType.load();
+    if (type == AudioParams::VocalType::Off) {
         return;
     }
     
-    switch (m_vocalType) {
+    m_voice.render(buffer, sampleRate);
+    
+    switch (type) {
         case AudioParams::VocalType::Robotic:
-            // Ring modulation for robotic effect
-            m_roboticModulation += 0.1f;
-            for (size_t i = 0; i < buffer.size(); ++i) {
-                float modulator = std::sin(m_roboticModulation + i * 0.01f);
-                buffer[i] *= modulator;
-            }
+            // The voice shapes a synth carrier
+            m_vocoder.process(buffer, sampleRate);
             break;
             
         case AudioParams::VocalType::Whisper:
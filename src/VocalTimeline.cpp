@@ -0,0 +1,147 @@
+#include "VocalTimeline.h"
+#include <algorithm>
+#include <cctype>
+
+namespace IndustrialMusic {
+
+namespace {
+
+// Beats between vocals; 0 for sections without them
+int vocalInterval(SectionType type) {
+    switch (type) {
+        case SectionType::Verse:     return 8;
+        case SectionType::Chorus:    return 4;
+        case SectionType::Bridge:    return 16;
+        case SectionType::Breakdown: return 32;
+        default:                     return 0;
+    }
+}
+
+// The line as the Vocal Output window shows it
+void appendStyled(std::string& out, std::string_view line, AudioParams::VocalType style) {
+    switch (style) {
+        case AudioParams::VocalType::Robotic:
+            out += '[';
+            for (char c : line) {
+                out += static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+            }
+            out += ']';
+            break;
+
+        case AudioParams::VocalType::Whisper:
+            out += "...";
+            for (char c : line) {
+                out += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+            }
+            out += "...";
+            break;
+
+        case AudioParams::VocalType::Distorted:
+            // Every third letter shouted
+            out += '!';
+            for (size_t i = 0; i < line.size(); ++i) {
+                char c = line[i];
+                out += i % 3 == 0 ? static_cast<char>(std::toupper(static_cast<unsigned char>(c))) : c;
+            }
+            out += '!';
+            break;
+
+        default:
+            out += line;
+            break;
+    }
+}
+
+constexpr uint32_t NO_LINE = UINT32_MAX;
+
+// For every line, the first line from it onwards, wrapping past the end,
+// that take() accepts; NO_LINE if there is none
+template<typename Take>
+std::vector<uint32_t> nextLines(size_t lines, Take take) {
+    std::vector<uint32_t> next(lines, NO_LINE);
+    uint32_t found = NO_LINE;
+    // The first pass finds the earliest accepted line for the wrap-around
+    for (int pass = 0; pass < 2; ++pass) {
+        for (size_t i = lines; i-- > 0;) {
+            if (take(i)) found = static_cast<uint32_t>(i);
+            next[i] = found;
+        }
+    }
+    return next;
+}
+
+} // namespace
+
+SectionVocals SectionVocals::compile(
+    const Section& section,
+    std::span<const std::string> lines,
+    AudioParams::VocalType style,
+    Phonemizer& phonemizer,
+    std::span<const LineProsody> prosody) {
+
+    SectionVocals vocals;
+    vocals.m_active.assign(static_cast<size_t>(std::max(section.totalBeats(), 0)), -1);
+    const int interval = vocalInterval(section.type);
+    if (style == AudioParams::VocalType::Off || lines.empty() || interval == 0) {
+        return vocals;
+    }
+
+    // Syllables per line; headers and blank lines have none and are never sung
+    std::vector<uint16_t> syllables(lines.size());
+    for (size_t i = 0; i < lines.size(); ++i) {
+        if (prosody.size() == lines.size()) {
+            syllables[i] = prosody[i].syllables;
+        } else if (!lines[i].starts_with('[')) {
+            syllables[i] = analyzeText(lines[i]).syllables;
+        }
+    }
+
+    // The next line sung from each line, and the next that fits before the
+    // following vocal
+    const size_t budget = static_cast<size_t>(interval) * MAX_SYLLABLES_PER_BEAT;
+    const auto nextSung = nextLines(lines.size(), [&](size_t i) { return syllables[i] > 0; });
+    const auto nextFitting = nextLines(lines.size(), [&](size_t i) { return syllables[i] > 0 && syllables[i] <= budget; });
+
+    // Where each line's styled text starts, once it has been sung
+    constexpr uint32_t UNSTYLED = UINT32_MAX;
+    std::vector<uint32_t> styledOffset(lines.size(), UNSTYLED);
+    std::vector<uint32_t> styledLength(lines.size(), 0);
+    vocals.m_phonemes.resize(lines.size());
+
+    for (int beat = 0; beat < section.totalBeats(); beat += interval) {
+        // From the line due at this beat, take the first that fits before
+        // the next vocal; if none fits, the first sung line is cut short
+        // rather than left out
+        const size_t start = static_cast<size_t>(beat / 8) % lines.size();
+        if (nextSung[start] == NO_LINE) {
+            break;
+        }
+        const size_t line = nextFitting[start] != NO_LINE ? nextFitting[start] : nextSung[start];
+
+        if (styledOffset[line] == UNSTYLED) {
+            styledOffset[line] = static_cast<uint32_t>(vocals.m_text.size());
+            appendStyled(vocals.m_text, lines[line], style);
+            styledLength[line] = static_cast<uint32_t>(vocals.m_text.size()) - styledOffset[line];
+            vocals.m_phonemes[line] = phonemizer.convert(lines[line]);
+        }
+
+        vocals.m_events.push_back({
+            beat,
+            std::min(interval, section.totalBeats() - beat),
+            static_cast<uint32_t>(line),
+            styledOffset[line],
+            styledLength[line]
+        });
+    }
+
+    // Every beat points at the vocal due then, so lookups are one index
+    for (size_t i = 0; i < vocals.m_events.size(); ++i) {
+        const VocalEvent& event = vocals.m_events[i];
+        for (int beat = event.beat; beat < event.beat + event.beats; ++beat) {
+            vocals.m_active[static_cast<size_t>(beat)] = static_cast<int32_t>(i);
+        }
+    }
+    return vocals;
+}
+
+} // namespace IndustrialMusic
\ No newline at end of file
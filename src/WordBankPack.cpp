@@ -0,0 +1,136 @@
+#include "WordBankPack.h"
+#include "AliasTable.h"
+#include <charconv>
+#include <cmath>
+
+namespace IndustrialMusic {
+
+namespace {
+
+constexpr std::array<std::pair<std::string_view, LyricSlot>, LYRIC_SLOT_COUNT> HEADERS = {{
+    {"[adj]", LyricSlot::Adjective},
+    {"[noun]", LyricSlot::Noun},
+    {"[verb]", LyricSlot::Verb},
+    {"[theme]", LyricSlot::Theme},
+}};
+
+std::string_view trim(std::string_view text) {
+    constexpr std::string_view SPACE = " \t\r";
+    size_t first = text.find_first_not_of(SPACE);
+    if (first == std::string_view::npos) return {};
+    return text.substr(first, text.find_last_not_of(SPACE) - first + 1);
+}
+
+// Split "word weight" into the word and its weight; an entry whose last
+// field is not a number is all word ("404" alone is a word)
+bool parseEntry(std::string_view line, std::string_view& word, double& weight) {
+    word = line;
+    weight = 1.0;
+    size_t space = line.find_last_of(" \t");
+    if (space == std::string_view::npos) return true;
+
+    std::string_view field = line.substr(space + 1);
+    double value = 0.0;
+    auto [end, error] = std::from_chars(field.data(), field.data() + field.size(), value);
+    if (error != std::errc{} || end != field.data() + field.size() || !std::isfinite(value)) {
+        // Text that is not a plain number ("12th", "nan") is part of the word
+        return true;
+    }
+    if (value < 0.0) return false;
+
+    word = trim(line.substr(0, space));
+    weight = value;
+    return true;
+}
+
+// Multi-word entries ("steel mill") are one word as far as lines go
+WordProsody analyzeEntry(std::string_view word) {
+    LineProsody line = analyzeText(word);
+    return {static_cast<uint8_t>(std::min<uint16_t>(line.syllables, UINT8_MAX)),
+            static_cast<uint8_t>(line.stress & 0xFF), line.rhyme};
+}
+
+} // namespace
+
+Result<WordBankPack> WordBankPack::open(const std::filesystem::path& filepath) {
+    auto file = MappedFile::open(filepath);
+    if (!file) {
+        return std::unexpected(file.error());
+    }
+
+    WordBankPack pack;
+    pack.m_file = std::move(*file);
+    auto bytes = pack.m_file.bytes();
+    if (auto result = pack.load({reinterpret_cast<const char*>(bytes.data()), bytes.size()}); !result) {
+        return std::unexpected(result.error());
+    }
+    return pack;
+}
+
+Result<WordBankPack> WordBankPack::parse(std::string_view text) {
+    WordBankPack pack;
+    if (auto result = pack.load(text); !result) {
+        return std::unexpected(result.error());
+    }
+    return pack;
+}
+
+Result<void> WordBankPack::load(std::string_view text) {
+    std::array<std::vector<double>, LYRIC_SLOT_COUNT> weights;
+    Bank* current = nullptr;
+    std::vector<double>* currentWeights = nullptr;
+
+    for (size_t start = 0; start < text.size();) {
+        size_t end = std::min(text.find('\n', start), text.size());
+        std::string_view line = trim(text.substr(start, end - start));
+        start = end + 1;
+        if (line.empty() || line.front() == '#') continue;
+
+        if (line.front() == '[') {
+            auto header = std::ranges::find(HEADERS, line, &std::pair<std::string_view, LyricSlot>::first);
+            if (header == HEADERS.end()) {
+                return std::unexpected(ErrorCode::InvalidFileFormat);
+            }
+            auto slot = static_cast<size_t>(header->second);
+            current = &m_banks[slot];
+            currentWeights = &weights[slot];
+            continue;
+        }
+
+        std::string_view word;
+        double weight = 0.0;
+        if (!current || !parseEntry(line, word, weight)) {
+            return std::unexpected(ErrorCode::InvalidFileFormat);
+        }
+        if (weight == 0.0 || word.empty()) continue;
+
+        current->words.push_back(word);
+        current->prosody.push_back(analyzeEntry(word));
+        currentWeights->push_back(weight);
+        m_maxWordLength = std::max(m_maxWordLength, word.size());
+    }
+
+    bool anyWords = false;
+    for (size_t slot = 0; slot < LYRIC_SLOT_COUNT; ++slot) {
+        Bank& bank = m_banks[slot];
+        const auto& bankWeights = weights[slot];
+        size_t n = bankWeights.size();
+        if (n == 0) continue;
+        if (n > UINT32_MAX) {
+            return std::unexpected(ErrorCode::InvalidFileFormat);
+        }
+        anyWords = true;
+
+        bank.columns.resize(n);
+        buildAliasTable(bankWeights, [&](size_t column, double probability, size_t alias) {
+            double threshold = std::min(probability * 4294967296.0, 4294967295.0);
+            bank.columns[column] = {static_cast<uint32_t>(threshold), static_cast<uint32_t>(alias)};
+        });
+    }
+    if (!anyWords) {
+        return std::unexpected(ErrorCode::InvalidFileFormat);
+    }
+    return {};
+}
+
+} // namespace IndustrialMusic
\ No newline at end of file
@@ -0,0 +1,328 @@
+#include "MidiGenerator.h"
+#include "LyricsGenerator.h"
+#include "NgramModel.h"
+#include "WordBankPack.h"
+#include "SongRenderer.h"
+#include "SongCache.h"
+#include "SongStructure.h"
+#include "ThreadPool.h"
+#include <iostream>
+#include <chrono>
+#include <format>
+#include <atomic>
+#include <charconv>
+#include <optional>
+
+// Headless batch generator: writes N songs (MIDI + lyrics) across all cores
+// and reports throughput and per-stage timing.
+//
+//   batch_generate --count 1000 --preset industrial --tempo 90:160
+//                  --intensity 5:10 --seed 0 --out batch_output --threads 8 --wav
+//
+// Song i uses seed (first seed + i); its tempo and intensity are drawn from
+// that seed, so any song can be regenerated on its own.
+
+namespace {
+
+using namespace IndustrialMusic;
+using Clock = std::chrono::steady_clock;
+
+struct BatchOptions {
+    size_t count = 100;
+    std::string preset = "industrial"; // Preset name, or "all" to cycle through them
+    int minTempo = 70;
+    int maxTempo = 140;
+    int minIntensity = 5;
+    int maxIntensity = 10;
+    uint32_t firstSeed = 0;
+    std::filesystem::path outputDir = "batch_output";
+    size_t threads = std::thread::hardware_concurrency();
+    bool renderAudio = false; // Also render each song to .wav
+    std::filesystem::path cacheDir; // Persistent song cache, disabled when empty
+    uint64_t cacheMegabytes = 1024;
+    float swing = 0.0f;     // Eighth-note swing, 0-1
+    uint32_t humanize = 0;  // Timing jitter in ticks
+    std::filesystem::path lyricsModel; // Trained n-gram model for every section's lyrics
+    std::filesystem::path wordPack;    // Weighted word banks for template lyrics
+};
+
+enum Stage { Structure, Midi, Lyrics, Render, Write, StageCount };
+constexpr std::array<const char*, StageCount> STAGE_NAMES = {"structure", "midi", "lyrics", "render", "write"};
+
+// Section chunks kept per worker when rendering audio; more than one song's worth
+constexpr size_t RENDER_SECTION_CACHE = 256;
+
+struct WorkerStats {
+    std::array<double, StageCount> seconds{};
+    size_t songs = 0;
+    size_t failures = 0;
+    size_t midiBytes = 0;
+};
+
+void printUsage() {
+    std::cout << "Usage: batch_generate [options]\n"
+              << "  --count N            Number of songs (default 100)\n"
+              << "  --preset NAME        standard, simple, extended, industrial or all\n"
+              << "  --tempo MIN:MAX      Tempo range in BPM (default 70:140)\n"
+              << "  --intensity MIN:MAX  Intensity range 1-10 (default 5:10)\n"
+              << "  --seed N             First seed; song i uses seed N + i (default 0)\n"
+              << "  --out DIR            Output directory (default batch_output)\n"
+              << "  --threads N          Worker threads (default: all cores)\n"
+              << "  --wav                Also render each song to a .wav file\n"
+              << "  --cache DIR          Reuse songs from a persistent cache directory\n"
+              << "  --cache-size MB      Cache size limit (default 1024)\n"
+              << "  --swing AMOUNT       Eighth-note swing 0-1 (default 0)\n"
+              << "  --humanize TICKS     Random timing offsets of up to TICKS (default 0)\n"
+              << "  --lyrics-model FILE  Draw lyrics from a trained .imlm n-gram model\n"
+              << "  --word-pack FILE     Fill lyric templates from an .imwords word-bank pack\n";
+}
+
+template<typename T>
+bool parseNumber(std::string_view text, T& value) {
+    auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return error == std::errc{} && end == text.data() + text.size();
+}
+
+bool parseRange(std::string_view text, int& min, int& max) {
+    auto colon = text.find(':');
+    if (colon == std::string_view::npos) {
+        return parseNumber(text, min) && parseNumber(text, max);
+    }
+    return parseNumber(text.substr(0, colon), min) &&
+           parseNumber(text.substr(colon + 1), max) && min <= max;
+}
+
+Result<BatchOptions> parseOptions(int argc, char* argv[]) {
+    BatchOptions options;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg == "--wav") {
+            options.renderAudio = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            return std::unexpected(ErrorCode::InvalidParameter);
+        }
+        std::string_view value = argv[++i];
+
+        bool ok = true;
+        if (arg == "--count") ok = parseNumber(value, options.count);
+        else if (arg == "--preset") options.preset = value;
+        else if (arg == "--tempo") ok = parseRange(value, options.minTempo, options.maxTempo);
+        else if (arg == "--intensity") ok = parseRange(value, options.minIntensity, options.maxIntensity);
+        else if (arg == "--seed") ok = parseNumber(value, options.firstSeed);
+        else if (arg == "--out") options.outputDir = value;
+        else if (arg == "--threads") ok = parseNumber(value, options.threads);
+        else if (arg == "--cache") options.cacheDir = value;
+        else if (arg == "--cache-size") ok = parseNumber(value, options.cacheMegabytes);
+        else if (arg == "--swing") ok = parseNumber(value, options.swing);
+        else if (arg == "--humanize") ok = parseNumber(value, options.humanize);
+        else if (arg == "--lyrics-model") options.lyricsModel = value;
+        else if (arg == "--word-pack") options.wordPack = value;
+        else ok = false;
+
+        if (!ok) {
+            return std::unexpected(ErrorCode::InvalidParameter);
+        }
+    }
+
+    options.minTempo = std::clamp(options.minTempo, 16, 240);
+    options.maxTempo = std::clamp(options.maxTempo, options.minTempo, 240);
+    options.minIntensity = std::clamp(options.minIntensity, 1, 10);
+    options.maxIntensity = std::clamp(options.maxIntensity, options.minIntensity, 10);
+    options.threads = std::max<size_t>(options.threads, 1);
+    options.swing = std::clamp(options.swing, 0.0f, 1.0f);
+    return options;
+}
+
+// Pulls song indices from a shared counter until the batch is exhausted
+WorkerStats runWorker(const BatchOptions& options, const std::vector<std::string>& presets,
+                      SongCache* cache, const std::shared_ptr<const NgramModel>& lyricsModel,
+                      const std::shared_ptr<const WordBankPack>& wordPack, std::atomic<size_t>& nextSong) {
+    WorkerStats stats;
+    MidiGenerator midiGen;
+    midiGen.setSongCache(cache);
+    if (options.swing > 0.0f || options.humanize > 0) {
+        NoteTransformChain feel;
+        feel.add(Swing{PatternEngine::TICKS_PER_QUARTER / 2, options.swing});
+        feel.add(Humanize{options.humanize, static_cast<uint8_t>(options.humanize > 0 ? 6 : 0)});
+        for (auto part : {PatternPart::Drums, PatternPart::Bass, PatternPart::Lead}) {
+            midiGen.getPatternEngine().setTransforms(part, feel);
+        }
+    }
+    if (options.renderAudio) {
+        // Rendering reads the section chunks the MIDI encoder just built
+        midiGen.setSectionCacheCapacity(RENDER_SECTION_CACHE);
+    }
+    LyricsGenerator lyricsGen;
+    if (lyricsModel) {
+        for (size_t type = 0; type < SECTION_TYPE_COUNT; ++type) {
+            lyricsGen.setLanguageModel(static_cast<SectionType>(type), lyricsModel);
+        }
+    }
+    lyricsGen.setWordBankPack(wordPack);
+    SongStructure structure;
+    SongRenderer renderer;
+
+    auto timed = [&stats](Stage stage, auto&& work) -> decltype(auto) {
+        auto start = Clock::now();
+        decltype(auto) result = work();
+        stats.seconds[stage] += std::chrono::duration<double>(Clock::now() - start).count();
+        return result;
+    };
+
+    for (size_t index = nextSong++; index < options.count; index = nextSong++) {
+        uint32_t seed = options.firstSeed + static_cast<uint32_t>(index);
+
+        std::mt19937 rng(seed);
+        AudioParams params;
+        params.tempo = std::uniform_int_distribution<int>(options.minTempo, options.maxTempo)(rng);
+        params.intensity = std::uniform_int_distribution<int>(options.minIntensity, options.maxIntensity)(rng);
+
+        const auto& sections = timed(Structure, [&]() -> const std::vector<Section>& {
+            structure.loadPreset(presets[index % presets.size()]);
+            return structure.getSections();
+        });
+
+        auto midi = timed(Midi, [&] { return midiGen.generate(sections, params, seed); });
+        auto lyrics = timed(Lyrics, [&] { return lyricsGen.generate(sections, seed); });
+
+        std::optional<Result<RenderedAudio>> audio;
+        if (options.renderAudio && midi) {
+            audio = timed(Render, [&] {
+                renderer.setSettings({.distortion = params.distortion / 100.0f});
+                auto patterns = midiGen.getPatternEngine().generateSong(sections, params.intensity, seed);
+                return renderer.render(patterns, params.tempo);
+            });
+        }
+
+        auto saved = timed(Write, [&] {
+            auto stem = options.outputDir / std::format("song_{:06}", seed);
+            if (!midi) return Result<void>(std::unexpected(midi.error()));
+            if (auto result = midiGen.saveToFile(*midi, stem.string() + ".mid"); !result) return result;
+            if (audio) {
+                if (!*audio) return Result<void>(std::unexpected(audio->error()));
+                if (auto result = SongRenderer::saveWav(**audio, stem.string() + ".wav"); !result) return result;
+            }
+            return lyricsGen.exportToFile(lyrics, stem.string() + ".txt");
+        });
+
+        if (saved) {
+            ++stats.songs;
+            stats.midiBytes += midi->size();
+        } else {
+            ++stats.failures;
+        }
+    }
+
+    return stats;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    auto parsed = parseOptions(argc, argv);
+    if (!parsed) {
+        printUsage();
+        return 1;
+    }
+    const BatchOptions& options = *parsed;
+
+    std::vector<std::string> presets = SongStructure().getAvailablePresets();
+    if (options.preset != "all") {
+        if (std::ranges::find(presets, options.preset) == presets.end()) {
+            std::cerr << std::format("Unknown preset '{}'\n", options.preset);
+            return 1;
+        }
+        presets = {options.preset};
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(options.outputDir, error);
+    if (error) {
+        std::cerr << std::format("Cannot create output directory '{}'\n", options.outputDir.string());
+        return 1;
+    }
+
+    std::unique_ptr<SongCache> cache;
+    if (!options.cacheDir.empty()) {
+        auto opened = SongCache::open(options.cacheDir, options.cacheMegabytes * 1024 * 1024);
+        if (!opened) {
+            std::cerr << std::format("Cannot open cache directory '{}'\n", options.cacheDir.string());
+            return 1;
+        }
+        cache = std::move(*opened);
+    }
+
+    // One read-only mapping shared by every worker
+    std::shared_ptr<const NgramModel> lyricsModel;
+    if (!options.lyricsModel.empty()) {
+        auto opened = NgramModel::open(options.lyricsModel);
+        if (!opened) {
+            std::cerr << std::format("Cannot open lyrics model '{}'\n", options.lyricsModel.string());
+            return 1;
+        }
+        lyricsModel = std::make_shared<const NgramModel>(std::move(*opened));
+    }
+
+    std::shared_ptr<const WordBankPack> wordPack;
+    if (!options.wordPack.empty()) {
+        auto opened = WordBankPack::open(options.wordPack);
+        if (!opened) {
+            std::cerr << std::format("Cannot open word pack '{}'\n", options.wordPack.string());
+            return 1;
+        }
+        wordPack = std::make_shared<const WordBankPack>(std::move(*opened));
+    }
+
+    std::cout << std::format("Generating {} songs on {} threads into '{}'...\n",
+                             options.count, options.threads, options.outputDir.string());
+
+    auto start = Clock::now();
+    std::atomic<size_t> nextSong{0};
+    std::vector<std::future<WorkerStats>> workers;
+    {
+        ThreadPool pool(options.threads);
+        for (size_t i = 0; i < options.threads; ++i) {
+            workers.push_back(pool.submit([&] { return runWorker(options, presets, cache.get(), lyricsModel, wordPack, nextSong); }));
+        }
+    }
+    double wallSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    WorkerStats total;
+    for (auto& worker : workers) {
+        WorkerStats stats = worker.get();
+        total.songs += stats.songs;
+        total.failures += stats.failures;
+        total.midiBytes += stats.midiBytes;
+        for (size_t stage = 0; stage < StageCount; ++stage) {
+            total.seconds[stage] += stats.seconds[stage];
+        }
+    }
+
+    double cpuSeconds = 0.0;
+    for (double seconds : total.seconds) {
+        cpuSeconds += seconds;
+    }
+
+    std::cout << std::format("{} songs in {:.3f} s: {:.1f} songs/sec ({:.1f} MB MIDI)\n",
+                             total.songs, wallSeconds, total.songs / wallSeconds,
+                             total.midiBytes / (1024.0 * 1024.0));
+    std::cout << "Per-stage time (summed over threads):\n";
+    for (size_t stage = 0; stage < StageCount; ++stage) {
+        double perSongMs = total.songs ? total.seconds[stage] * 1e3 / total.songs : 0.0;
+        double share = cpuSeconds > 0.0 ? total.seconds[stage] * 100.0 / cpuSeconds : 0.0;
+        std::cout << std::format("  {:<10} {:>9.3f} ms/song {:>6.1f}%\n", STAGE_NAMES[stage], perSongMs, share);
+    }
+
+    if (cache) {
+        std::cout << std::format("Song cache: {} hits, {} misses\n", cache->getHits(), cache->getMisses());
+    }
+
+    if (total.failures > 0) {
+        std::cerr << std::format("{} songs failed\n", total.failures);
+        return 1;
+    }
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,60 @@
+#include "ArrangementSearch.h"
+#include "ThreadPool.h"
+#include <iostream>
+#include <chrono>
+#include <format>
+
+// Search millions of candidate arrangements against a brief (a 2:30 cue at
+// 128 BPM that builds, drops and peaks at the end), serially and on all
+// cores, and print the best few.
+int main(int argc, char* argv[]) {
+    using namespace IndustrialMusic;
+    using Clock = std::chrono::steady_clock;
+
+    uint64_t candidates = argc > 1 ? std::stoull(argv[1]) : 4'000'000;
+    constexpr size_t TOP_K = 5;
+    constexpr uint32_t SEED = 7;
+
+    ArrangementBrief brief;
+    brief.targetSeconds = 150.0f;
+    brief.tempo = 128;
+    brief.energyCurve = {0.2f, 0.35f, 0.5f, 0.6f, 0.9f, 0.9f, 0.3f, 0.3f, 0.6f, 0.9f, 0.9f, 0.25f};
+
+    ArrangementSearch search;
+    ThreadPool pool;
+
+    std::vector<ScoredArrangement> results[2];
+    double seconds[2] = {};
+    for (int mode = 0; mode < 2; ++mode) {
+        search.setThreadPool(mode == 0 ? nullptr : &pool);
+        auto start = Clock::now();
+        auto found = search.search(brief, candidates, TOP_K, SEED);
+        seconds[mode] = std::chrono::duration<double>(Clock::now() - start).count();
+        if (!found) {
+            std::cerr << "Invalid brief\n";
+            return 1;
+        }
+        results[mode] = std::move(*found);
+    }
+
+    std::cout << std::format("{} candidates\n", candidates);
+    std::cout << std::format("{:>10} {:>10} {:>14}\n", "threads", "ms", "Mcandidates/s");
+    std::cout << std::format("{:>10} {:>10.1f} {:>14.2f}\n", 1, seconds[0] * 1e3, candidates / seconds[0] / 1e6);
+    std::cout << std::format("{:>10} {:>10.1f} {:>14.2f}\n", pool.size(), seconds[1] * 1e3, candidates / seconds[1] / 1e6);
+
+    bool same = results[0].size() == results[1].size();
+    for (size_t i = 0; same && i < results[0].size(); ++i) {
+        same = results[0][i].candidate == results[1][i].candidate;
+    }
+    std::cout << std::format("serial and parallel results match: {}\n\n", same ? "yes" : "NO");
+
+    for (const auto& result : results[1]) {
+        std::cout << std::format("cost {:.4f}  {:.1f} s  energy error {:.3f}  candidate {}\n  ",
+                                 result.cost, result.seconds, result.energyError, result.candidate);
+        for (const auto& section : result.sections) {
+            std::cout << std::format("{} {}  ", section.name, section.bars);
+        }
+        std::cout << "\n";
+    }
+    return same ? 0 : 1;
+}
\ No newline at end of file
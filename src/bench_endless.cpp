@@ -0,0 +1,72 @@
+#include "ArrangementGenerator.h"
+#include "PatternEngine.h"
+#include "SongStructure.h"
+#include <iostream>
+#include <chrono>
+#include <format>
+
+// Continuous mode over a very long run: the playhead steps through a
+// million sections while the window is retired, topped up and its patterns
+// regenerated, as the UI does every time a section finishes. Window size
+// and pattern memory must stay flat however far it goes.
+int main() {
+    using namespace IndustrialMusic;
+    using Clock = std::chrono::steady_clock;
+
+    constexpr uint64_t SECTIONS = 1'000'000;
+    constexpr uint64_t REPORT_EVERY = SECTIONS / 5;
+    constexpr int INTENSITY = 7;
+    constexpr uint32_t SEED = 42;
+
+    PatternEngine engine;
+    engine.setSectionCacheCapacity(256);
+    EndlessArrangement endless(Presets::getIndustrialStructure(), ArrangementRules::industrial(), SEED);
+
+    std::array<uint64_t, SECTION_TYPE_COUNT> typeCounts{};
+    size_t maxWindow = 0;
+    size_t maxNotes = 0;
+    int64_t playedBeats = 0;
+
+    std::cout << std::format("{:>10} {:>8} {:>10} {:>14} {:>12}\n", "section", "window", "notes", "first beat", "us/section");
+    auto start = Clock::now();
+    auto lastReport = start;
+    for (uint64_t playing = 0; playing < SECTIONS; ++playing) {
+        if (endless.advance(playing)) {
+            const auto& window = endless.getSections();
+            auto patterns = engine.generateSong(window, INTENSITY, SEED);
+
+            size_t notes = 0;
+            for (const auto& part : patterns.parts) {
+                notes += part.size();
+            }
+            maxWindow = std::max(maxWindow, window.size());
+            maxNotes = std::max(maxNotes, notes);
+        }
+
+        // The window always starts at the playing section, at the beat it starts on
+        const Section& current = endless.getSections().front();
+        if (endless.getFirstSection() != playing || endless.getFirstBeat() != playedBeats) {
+            std::cerr << std::format("Window out of step at section {}\n", playing);
+            return 1;
+        }
+        playedBeats += current.totalBeats();
+        ++typeCounts[static_cast<size_t>(current.type)];
+
+        if ((playing + 1) % REPORT_EVERY == 0) {
+            auto now = Clock::now();
+            double seconds = std::chrono::duration<double>(now - lastReport).count();
+            lastReport = now;
+            std::cout << std::format("{:>10} {:>8} {:>10} {:>14} {:>12.2f}\n", playing + 1, endless.getSections().size(),
+                                     maxNotes, endless.getFirstBeat(), seconds / REPORT_EVERY * 1e6);
+        }
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::cout << std::format("{} sections ({} beats) in {:.2f} s; largest window {} sections, {} notes\n",
+                             SECTIONS, playedBeats, seconds, maxWindow, maxNotes);
+    for (size_t type = 0; type < SECTION_TYPE_COUNT; ++type) {
+        std::cout << std::format("{:>14} {:>6.2f}%\n", sectionTypeToString(static_cast<SectionType>(type)),
+                                 100.0 * typeCounts[type] / SECTIONS);
+    }
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,93 @@
+#include "MidiGenerator.h"
+#include "SongStructure.h"
+#include "ThreadPool.h"
+#include <iostream>
+#include <chrono>
+#include <format>
+
+// Microbenchmark for MidiGenerator::generate at increasing song lengths.
+// A song length multiplier of N repeats the industrial preset N times.
+// Each length is timed serially and with tracks built on a thread pool.
+// Then the patterns of a long song are regenerated through the section
+// cache after the edits the UI makes: changing one section and inserting
+// one at the front. Neither should rebuild more than a few sections.
+int main() {
+    using namespace IndustrialMusic;
+    using Clock = std::chrono::steady_clock;
+
+    AudioParams params;
+    params.tempo = 140;
+    params.intensity = 8;
+
+    MidiGenerator midiGen;
+    ThreadPool pool;
+    const auto preset = Presets::getIndustrialStructure();
+
+    std::cout << std::format("{} worker threads\n", pool.size());
+    std::cout << std::format("{:>6} {:>8} {:>10} {:>10} {:>12} {:>10}\n",
+                             "length", "mode", "bytes", "iters", "us/song", "MB/s");
+
+    for (int multiplier : {1, 2, 5, 10, 25, 50, 100}) {
+        std::vector<Section> sections;
+        sections.reserve(preset.size() * multiplier);
+        for (int i = 0; i < multiplier; ++i) {
+            sections.insert(sections.end(), preset.begin(), preset.end());
+        }
+        sections = numberVariations(std::move(sections));
+
+        // Keep the total work per row roughly constant
+        const int iterations = std::max(20, 20000 / multiplier);
+
+        for (ThreadPool* mode : {static_cast<ThreadPool*>(nullptr), &pool}) {
+            midiGen.setThreadPool(mode);
+            size_t bytes = 0;
+
+            auto start = Clock::now();
+            for (int i = 0; i < iterations; ++i) {
+                auto result = midiGen.generate(sections, params, static_cast<uint32_t>(i));
+                if (!result) {
+                    std::cerr << "Failed to generate MIDI\n";
+                    return 1;
+                }
+                bytes = result->size();
+            }
+            double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+            double usPerSong = seconds * 1e6 / iterations;
+            double mbPerSec = (static_cast<double>(bytes) * iterations) / seconds / (1024.0 * 1024.0);
+            std::cout << std::format("{:>5}x {:>8} {:>10} {:>10} {:>12.2f} {:>10.1f}\n",
+                                     multiplier, mode ? "pooled" : "serial", bytes, iterations, usPerSong, mbPerSec);
+        }
+    }
+
+    PatternEngine& engine = midiGen.getPatternEngine();
+    std::vector<Section> song;
+    for (int i = 0; i < 100; ++i) {
+        song.insert(song.end(), preset.begin(), preset.end());
+    }
+    song = numberVariations(std::move(song));
+    auto timePatterns = [&](const std::vector<Section>& sections) {
+        auto start = Clock::now();
+        auto patterns = engine.generateSong(sections, params.intensity, 42);
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    };
+
+    std::cout << std::format("\n{} sections, patterns only\n", song.size());
+    std::cout << std::format("{:>24} {:>10.2f} ms\n", "uncached", timePatterns(song));
+    engine.setSectionCacheCapacity(song.size() * PATTERN_PART_COUNT * 2);
+    std::cout << std::format("{:>24} {:>10.2f} ms\n", "cold cache", timePatterns(song));
+    std::cout << std::format("{:>24} {:>10.2f} ms\n", "unchanged", timePatterns(song));
+
+    song[song.size() / 2].bars += 4;
+    std::cout << std::format("{:>24} {:>10.2f} ms\n", "one section edited", timePatterns(song));
+
+    song.insert(song.begin(), {SectionType::Breakdown, "BREAKDOWN", 3, 4});
+    std::cout << std::format("{:>24} {:>10.2f} ms\n", "inserted at front", timePatterns(song));
+
+    // A copy of a section already in the song shares its seed, so nothing
+    // needs building
+    song.insert(song.begin(), preset[2]);
+    std::cout << std::format("{:>24} {:>10.2f} ms\n", "existing section copied", timePatterns(song));
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,125 @@
+#include "MidiScheduler.h"
+#include "MidiReader.h"
+#include "MidiGenerator.h"
+#include "SongStructure.h"
+#include <iostream>
+#include <format>
+#include <charconv>
+
+// Plays the start of a generated song through MidiScheduler into a loopback
+// sink, feeding it with a short lookahead the way a sequencer would, and
+// reports dispatch jitter.
+//
+//   bench_midi_scheduler [seconds]   (default 10)
+
+namespace {
+
+using namespace IndustrialMusic;
+using Clock = MidiScheduler::Clock;
+
+struct TimedMessage {
+    Clock::duration offset;
+    MidiMessage message;
+};
+
+// Flatten the channel events of every track into one time-ordered list
+std::vector<TimedMessage> flattenSong(const MidiReader& reader, Clock::duration limit) {
+    std::vector<std::pair<uint32_t, MidiMessage>> events;
+    uint32_t microsPerQuarter = 500000;
+
+    for (const auto& track : reader.getTracks()) {
+        for (const auto& event : track) {
+            if (event.status == 0xFF && event.metaType == 0x51 && event.data.size() == 3) {
+                microsPerQuarter = (event.data[0] << 16) | (event.data[1] << 8) | event.data[2];
+            } else if (event.status >= 0x80 && event.status < 0xF0) {
+                MidiMessage message;
+                message.bytes[0] = event.status;
+                message.size = static_cast<uint8_t>(1 + event.data.size());
+                std::copy_n(event.data.begin(), event.data.size(), message.bytes.begin() + 1);
+                events.emplace_back(event.tick, message);
+            }
+        }
+    }
+    std::ranges::stable_sort(events, {}, &std::pair<uint32_t, MidiMessage>::first);
+
+    std::vector<TimedMessage> timed;
+    double tickDuration = microsPerQuarter * 1e3 / reader.getTicksPerQuarter();
+    for (const auto& [tick, message] : events) {
+        auto offset = std::chrono::duration_cast<Clock::duration>(std::chrono::nanoseconds(
+            static_cast<int64_t>(tick * tickDuration)));
+        if (offset > limit) break;
+        timed.push_back({offset, message});
+    }
+    return timed;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int seconds = 10;
+    if (argc > 1) {
+        std::string_view arg = argv[1];
+        auto [end, error] = std::from_chars(arg.data(), arg.data() + arg.size(), seconds);
+        if (error != std::errc{} || seconds <= 0) {
+            std::cerr << "Usage: bench_midi_scheduler [seconds]\n";
+            return 1;
+        }
+    }
+
+    SongStructure structure;
+    structure.loadPreset("industrial");
+    AudioParams params;
+    params.tempo = 140;
+    params.intensity = 10;
+
+    MidiGenerator midiGen;
+    auto midi = midiGen.generate(structure.getSections(), params, 42);
+    if (!midi) {
+        std::cerr << "Failed to generate MIDI\n";
+        return 1;
+    }
+    auto reader = MidiReader::parse(*midi);
+    if (!reader) {
+        std::cerr << "Failed to parse generated MIDI\n";
+        return 1;
+    }
+
+    auto song = flattenSong(*reader, std::chrono::seconds(seconds));
+    std::cout << std::format("Playing {} messages over {} s...\n", song.size(), seconds);
+
+    auto sink = std::make_unique<LoopbackSink>(song.size());
+    LoopbackSink& loopback = *sink;
+    MidiScheduler scheduler(std::move(sink));
+
+    // Keep 50 ms of messages queued ahead of the play position
+    constexpr auto LOOKAHEAD = std::chrono::milliseconds(50);
+    auto start = Clock::now() + LOOKAHEAD;
+    size_t next = 0;
+    while (next < song.size()) {
+        auto horizon = Clock::now() + LOOKAHEAD;
+        while (next < song.size() && start + song[next].offset <= horizon) {
+            if (!scheduler.schedule(song[next].message, start + song[next].offset)) break;
+            ++next;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    while (loopback.count() < song.size()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    auto stats = scheduler.getJitterStats();
+    auto micros = [](std::chrono::nanoseconds ns) { return ns.count() / 1e3; };
+    std::cout << std::format("{} messages, {} dropped\n", stats.messages, stats.dropped);
+    std::cout << std::format("Jitter: mean {:.1f} us, p99 < {:.1f} us, max {:.1f} us\n",
+                             micros(stats.mean), micros(stats.p99), micros(stats.max));
+
+    // Received order must match the song order
+    auto received = loopback.received();
+    for (size_t i = 0; i < received.size(); ++i) {
+        if (!std::ranges::equal(received[i].message.view(), song[i].message.view())) {
+            std::cerr << std::format("Message {} arrived out of order\n", i);
+            return 1;
+        }
+    }
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,107 @@
+#include "NgramModel.h"
+#include "LyricsGenerator.h"
+#include "SongStructure.h"
+#include <iostream>
+#include <chrono>
+#include <format>
+
+// Train a trigram lyric model on a large synthetic corpus (Zipf-distributed
+// words from a 50k vocabulary), then time opening the saved file, sampling
+// tokens from it and generating whole songs' lyrics with it.
+int main(int argc, char* argv[]) {
+    using namespace IndustrialMusic;
+    using Clock = std::chrono::steady_clock;
+
+    size_t corpusLines = argc > 1 ? std::stoull(argv[1]) : 500'000;
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "bench_ngram.imlm";
+    constexpr size_t VOCABULARY = 50'000;
+    constexpr int ORDER = 3;
+    constexpr size_t SAMPLES = 10'000'000;
+    constexpr uint32_t SONGS = 20'000;
+
+    // Words spelled from syllables, drawn with probability 1 / rank
+    constexpr std::array<std::string_view, 16> SYLLABLES = {
+        "ra", "to", "ke", "mi", "su", "ne", "lo", "va", "dri", "gon", "tek", "zu", "ish", "orm", "ex", "kal"};
+    std::vector<std::string> words(VOCABULARY);
+    std::vector<double> cumulative(VOCABULARY);
+    double total = 0.0;
+    for (size_t rank = 0; rank < VOCABULARY; ++rank) {
+        for (size_t value = rank + 1; value > 0; value /= SYLLABLES.size()) {
+            words[rank] += SYLLABLES[value % SYLLABLES.size()];
+        }
+        total += 1.0 / static_cast<double>(rank + 1);
+        cumulative[rank] = total;
+    }
+
+    std::mt19937_64 rng(1);
+    std::uniform_real_distribution<double> unit(0.0, total);
+    std::uniform_int_distribution<int> lineLength(4, 10);
+    std::string corpus;
+    for (size_t line = 0; line < corpusLines; ++line) {
+        for (int word = lineLength(rng); word > 0; --word) {
+            corpus += words[static_cast<size_t>(std::ranges::upper_bound(cumulative, unit(rng)) - cumulative.begin())];
+            corpus += word > 1 ? ' ' : '\n';
+        }
+    }
+
+    auto start = Clock::now();
+    auto trained = NgramModel::train(corpus, ORDER);
+    double trainSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+    if (!trained || !writeFileAtomically(path, *trained)) {
+        std::cerr << "Training failed\n";
+        return 1;
+    }
+    trained = {};
+
+    start = Clock::now();
+    auto opened = NgramModel::open(path);
+    double openSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+    if (!opened) {
+        std::cerr << "Cannot open model\n";
+        return 1;
+    }
+    auto model = std::make_shared<const NgramModel>(std::move(*opened));
+
+    std::cout << std::format("corpus {} lines, {:.1f} MB; model {} words, {} contexts, {:.1f} MB\n",
+                             corpusLines, corpus.size() / 1e6, model->getVocabularySize(),
+                             model->getContextCount(), model->getFileSize() / 1e6);
+    std::cout << std::format("{:>24} {:>12.1f} ms\n", "train", trainSeconds * 1e3);
+    std::cout << std::format("{:>24} {:>12.1f} us\n", "open", openSeconds * 1e6);
+
+    // Token sampling, following the model's own output like generation does
+    std::array<NgramModel::Token, ORDER - 1> history{};
+    size_t lines = 0;
+    start = Clock::now();
+    for (size_t i = 0; i < SAMPLES; ++i) {
+        NgramModel::Token token = model->next(history, rng());
+        if (token == NgramModel::BOUNDARY) {
+            history = {};
+            ++lines;
+        } else {
+            history = {history[1], token};
+        }
+    }
+    double sampleSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+    std::cout << std::format("{:>24} {:>12.1f} Mtokens/s ({} lines)\n", "sample", SAMPLES / sampleSeconds / 1e6, lines);
+
+    LyricsGenerator generator;
+    for (size_t type = 0; type < SECTION_TYPE_COUNT; ++type) {
+        generator.setLanguageModel(static_cast<SectionType>(type), model);
+    }
+    const auto sections = Presets::getIndustrialStructure();
+    start = Clock::now();
+    size_t bytes = 0;
+    for (uint32_t seed = 0; seed < SONGS; ++seed) {
+        for (const auto& text : generator.generate(sections, seed)) {
+            bytes += text.size();
+        }
+    }
+    double songSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+    std::cout << std::format("{:>24} {:>12.2f} us/song ({:.1f} MB of lyrics)\n", "songs from model",
+                             songSeconds / SONGS * 1e6, bytes / 1e6);
+    std::cout << "\n" << generator.generate(sections, 1)[1] << "\n";
+
+    std::error_code error;
+    std::filesystem::remove(path, error);
+    return 0;
+}
\ No newline at end of file
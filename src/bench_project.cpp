@@ -0,0 +1,92 @@
+#include "ProjectFile.h"
+#include "LyricsGenerator.h"
+#include "SongStructure.h"
+#include <iostream>
+#include <chrono>
+#include <format>
+
+// Save and reopen a very large project: open time (map and validate the
+// header), reading every section in place, and a full copy-out with load().
+int main(int argc, char* argv[]) {
+    using namespace IndustrialMusic;
+    using Clock = std::chrono::steady_clock;
+
+    constexpr size_t SECTIONS = 200'000;
+    constexpr size_t LANES = 3;
+    constexpr size_t POINTS_PER_LANE = 250'000;
+
+    std::filesystem::path path = argc > 1 ? argv[1] : "bench_project.immp";
+
+    Project project;
+    project.songSeed = 42;
+    project.params.tempo = 90;
+    const auto pattern = Presets::getExtendedStructure();
+    for (size_t i = 0; i < SECTIONS; ++i) {
+        project.sections.push_back(pattern[i % pattern.size()]);
+    }
+    project.sections = numberVariations(std::move(project.sections));
+
+    // Real lyrics for a slice of the arrangement, repeated to full length
+    LyricsGenerator lyrics;
+    auto lines = lyrics.generate(std::vector<Section>(project.sections.begin(), project.sections.begin() + 1000), 42);
+    while (project.lyrics.size() < SECTIONS * 4) {
+        project.lyrics.insert(project.lyrics.end(), lines.begin(), lines.end());
+    }
+
+    for (size_t lane = 0; lane < LANES; ++lane) {
+        AutomationLane& automation = project.automation.emplace_back();
+        automation.target = static_cast<AutomationTarget>(lane);
+        for (size_t point = 0; point < POINTS_PER_LANE; ++point) {
+            automation.points.push_back({static_cast<uint32_t>(point * 4), static_cast<float>(point % 100) / 100.0f});
+        }
+    }
+
+    auto start = Clock::now();
+    if (!ProjectFile::save(project, path)) {
+        std::cerr << std::format("Failed to write {}\n", path.string());
+        return 1;
+    }
+    double saveSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    // Best of several opens; the first one also pays for page cache misses
+    constexpr int OPENS = 20;
+    double openSeconds = 1e9;
+    size_t fileSize = 0;
+    for (int i = 0; i < OPENS; ++i) {
+        start = Clock::now();
+        auto file = ProjectFile::open(path);
+        if (!file) return 1;
+        openSeconds = std::min(openSeconds, std::chrono::duration<double>(Clock::now() - start).count());
+        fileSize = file->getFileSize();
+    }
+
+    auto file = ProjectFile::open(path);
+    if (!file) return 1;
+
+    start = Clock::now();
+    int64_t totalBeats = 0;
+    for (size_t i = 0; i < file->getSectionCount(); ++i) {
+        auto section = file->getSection(i);
+        totalBeats += section.bars * section.beatsPerBar;
+    }
+    double scanSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    start = Clock::now();
+    auto loaded = file->load();
+    double loadSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    bool roundTrip = loaded && loaded->sections == project.sections && loaded->lyrics == project.lyrics &&
+                     loaded->automation == project.automation && loaded->songSeed == project.songSeed &&
+                     loaded->params.tempo == project.params.tempo;
+
+    std::cout << std::format("{} sections, {} lyric lines, {} automation points, {:.1f} MiB\n",
+                             SECTIONS, project.lyrics.size(), LANES * POINTS_PER_LANE, fileSize / (1024.0 * 1024.0));
+    std::cout << std::format("{:>14} {:>10}\n", "step", "ms");
+    std::cout << std::format("{:>14} {:>10.3f}\n", "save", saveSeconds * 1e3);
+    std::cout << std::format("{:>14} {:>10.3f}\n", "open", openSeconds * 1e3);
+    std::cout << std::format("{:>14} {:>10.3f}\n", "scan sections", scanSeconds * 1e3);
+    std::cout << std::format("{:>14} {:>10.3f}\n", "load all", loadSeconds * 1e3);
+    std::cout << std::format("total beats {}, round trip: {}\n", totalBeats, roundTrip ? "ok" : "MISMATCH");
+
+    return roundTrip ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,62 @@
+#include "SongRenderer.h"
+#include "MidiGenerator.h"
+#include "SongStructure.h"
+#include "ThreadPool.h"
+#include <iostream>
+#include <chrono>
+#include <format>
+
+// Times SongRenderer on a generated song, serially and on a thread pool,
+// and reports how many times faster than real time each one renders.
+int main() {
+    using namespace IndustrialMusic;
+    using Clock = std::chrono::steady_clock;
+
+    SongStructure structure;
+    structure.loadPreset("industrial");
+    AudioParams params;
+    params.tempo = 140;
+    params.intensity = 8;
+
+    MidiGenerator midiGen;
+    auto midi = midiGen.generate(structure.getSections(), params, 42);
+    if (!midi) {
+        std::cerr << "Failed to generate MIDI\n";
+        return 1;
+    }
+
+    ThreadPool pool;
+    SongRenderer renderer;
+    std::vector<float> reference;
+
+    std::cout << std::format("{:>10} {:>10} {:>12} {:>12}\n", "mode", "audio s", "render ms", "x realtime");
+    for (ThreadPool* mode : {static_cast<ThreadPool*>(nullptr), &pool}) {
+        renderer.setThreadPool(mode);
+
+        auto start = Clock::now();
+        auto audio = renderer.render(*midi);
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        if (!audio) {
+            std::cerr << "Render failed\n";
+            return 1;
+        }
+
+        std::cout << std::format("{:>10} {:>10.1f} {:>12.1f} {:>12.1f}\n",
+                                 mode ? std::format("{} thr", pool.size()) : "serial",
+                                 audio->durationSeconds(), seconds * 1e3,
+                                 audio->durationSeconds() / seconds);
+
+        if (reference.empty()) {
+            reference = audio->samples;
+            if (auto saved = SongRenderer::saveWav(*audio, "bench_render.wav"); !saved) {
+                std::cerr << "Failed to write bench_render.wav\n";
+                return 1;
+            }
+        } else if (audio->samples != reference) {
+            std::cerr << "Pooled render differs from serial render\n";
+            return 1;
+        }
+    }
+
+    return 0;
+}
\ No newline at end of file
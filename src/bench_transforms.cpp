@@ -0,0 +1,62 @@
+#include "NoteTransforms.h"
+#include "PatternEngine.h"
+#include "SongStructure.h"
+#include <iostream>
+#include <chrono>
+#include <format>
+
+// Throughput of each NoteTransformChain step, and of a full chain, over the
+// notes of many generated songs concatenated into one large stream.
+int main() {
+    using namespace IndustrialMusic;
+    using Clock = std::chrono::steady_clock;
+
+    constexpr int INTENSITY = 8;
+    constexpr size_t TARGET_NOTES = 4'000'000;
+
+    // Build the corpus once from real patterns, one song after another so
+    // it stays in start order like a single long part
+    PatternEngine engine;
+    const auto sections = Presets::getIndustrialStructure();
+    NoteStream corpus;
+    uint32_t offset = 0;
+    for (uint32_t seed = 0; corpus.size() < TARGET_NOTES; ++seed) {
+        auto song = engine.generateSong(sections, INTENSITY, seed);
+        corpus.append(song.part(PatternPart::Drums), offset);
+        offset += song.lengthTicks;
+    }
+
+    struct Case {
+        const char* name;
+        NoteTransformChain chain;
+    };
+    const std::vector<Case> cases = {
+        {"quantize", {Quantize{120, 0.5f}}},
+        {"swing", {Swing{240, 0.33f}}},
+        {"humanize", {Humanize{12, 8}}},
+        {"accents", {AccentMap{240, {1.25f, 0.8f, 1.0f, 0.8f}}}},
+        {"curve", {VelocityCurve{1.6f, 20, 127}}},
+        {"full chain", {Quantize{120, 0.5f}, Swing{240, 0.33f}, Humanize{12, 8},
+                        AccentMap{240, {1.25f, 0.8f, 1.0f, 0.8f}}, VelocityCurve{1.6f, 20, 127}}},
+    };
+
+    constexpr int PASSES = 5;
+    std::cout << std::format("{} notes\n", corpus.size());
+    std::cout << std::format("{:>12} {:>12} {:>14}\n", "transform", "ms/pass", "Mnotes/s");
+
+    for (const auto& benchCase : cases) {
+        double seconds = 0.0;
+        for (int pass = 0; pass < PASSES; ++pass) {
+            NoteStream notes = corpus;
+            auto start = Clock::now();
+            benchCase.chain.apply(notes, INTENSITY, static_cast<uint32_t>(pass));
+            seconds += std::chrono::duration<double>(Clock::now() - start).count();
+        }
+
+        double perPass = seconds / PASSES;
+        std::cout << std::format("{:>12} {:>12.2f} {:>14.1f}\n",
+                                 benchCase.name, perPass * 1e3, corpus.size() / perPass / 1e6);
+    }
+
+    return 0;
+}
\ No newline at end of file
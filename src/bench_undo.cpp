@@ -0,0 +1,86 @@
+#include "SongStructure.h"
+#include <iostream>
+#include <chrono>
+#include <format>
+#include <random>
+
+// Cost of arrangement edits with full undo history: a long arrangement is
+// edited many times, then every edit is undone and redone. Memory is the
+// distinct section entries kept alive by all versions, compared with storing
+// a full copy of the arrangement per version.
+int main() {
+    using namespace IndustrialMusic;
+    using Clock = std::chrono::steady_clock;
+
+    constexpr size_t SECTIONS = 5'000;
+    constexpr size_t EDITS = 10'000;
+
+    // Tile the presets up to the target length
+    std::vector<Section> arrangement;
+    arrangement.reserve(SECTIONS);
+    const auto pattern = Presets::getExtendedStructure();
+    while (arrangement.size() < SECTIONS) {
+        arrangement.push_back(pattern[arrangement.size() % pattern.size()]);
+    }
+
+    arrangement = numberVariations(std::move(arrangement));
+
+    SongStructure structure;
+    structure.setSections(arrangement);
+    structure.clearHistory();
+
+    // Mixed edits at random positions, roughly balanced so the length stays near SECTIONS
+    std::mt19937 rng(42);
+    auto start = Clock::now();
+    for (size_t i = 0; i < EDITS; ++i) {
+        size_t count = structure.getSectionCount();
+        size_t from = rng() % count;
+        size_t to = rng() % count;
+        switch (rng() % 3) {
+            case 0: structure.addSection(pattern[from % pattern.size()]); break;
+            case 1: structure.removeSection(from); break;
+            default: structure.moveSection(from, to); break;
+        }
+    }
+    double editSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+    const size_t versions = structure.getUndoCount() + 1;
+    const size_t nodes = structure.getHistoryNodeCount();
+    const auto edited = structure.getSections();
+
+    start = Clock::now();
+    while (structure.undo()) {}
+    double undoSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+    bool restored = structure.getSections() == arrangement;
+
+    start = Clock::now();
+    while (structure.redo()) {}
+    double redoSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+    bool replayed = structure.getSections() == edited;
+
+    // Undo and redo only swap versions; the vector is rebuilt on the next read
+    constexpr int READS = 100;
+    start = Clock::now();
+    for (int i = 0; i < READS; ++i) {
+        structure.undo();
+        structure.redo();
+        if (structure.getSections().empty()) return 1;
+    }
+    double readSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    const size_t entryBytes = PersistentVector<Section>::NODE_BYTES;
+    double sharedMiB = nodes * entryBytes / (1024.0 * 1024.0);
+    double copiedMiB = static_cast<double>(versions) * SECTIONS * sizeof(Section) / (1024.0 * 1024.0);
+
+    std::cout << std::format("{} sections, {} edits, {} versions\n", SECTIONS, EDITS, versions);
+    std::cout << std::format("{:>8} {:>12} {:>10}\n", "op", "total ms", "us/op");
+    std::cout << std::format("{:>8} {:>12.2f} {:>10.2f}\n", "edit", editSeconds * 1e3, editSeconds / EDITS * 1e6);
+    std::cout << std::format("{:>8} {:>12.2f} {:>10.2f}\n", "undo", undoSeconds * 1e3, undoSeconds / EDITS * 1e6);
+    std::cout << std::format("{:>8} {:>12.2f} {:>10.2f}\n", "redo", redoSeconds * 1e3, redoSeconds / EDITS * 1e6);
+    std::cout << std::format("{:>8} {:>12.2f} {:>10.2f}\n", "read", readSeconds * 1e3, readSeconds / READS * 1e6);
+    std::cout << std::format("history: {} entries, {:.1f} MiB shared vs {:.1f} MiB as full copies\n",
+                             nodes, sharedMiB, copiedMiB);
+    std::cout << std::format("undo restored original: {}, redo replayed edits: {}\n",
+                             restored ? "yes" : "NO", replayed ? "yes" : "NO");
+
+    return restored && replayed ? 0 : 1;
+}
\ No newline at end of file
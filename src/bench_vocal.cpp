@@ -0,0 +1,159 @@
+#include "VocalSynthesizer.h"
+#include "LyricsGenerator.h"
+#include "SongStructure.h"
+#include "SongRenderer.h"
+#include <iostream>
+#include <chrono>
+#include <format>
+
+// Phonemize generated songs' lyrics, cold and through the line cache,
+// compile each section's vocals and look up every beat of the songs, then
+// time the voice singing a whole song in each style against real time. Writes the
+// first seconds of each style to bench_vocal.wav.
+int main(int argc, char* argv[]) {
+    using namespace IndustrialMusic;
+    using Clock = std::chrono::steady_clock;
+
+    uint32_t songs = argc > 1 ? static_cast<uint32_t>(std::stoul(argv[1])) : 200;
+    constexpr float SAMPLE_RATE = 48000.0f;
+    constexpr size_t BLOCK = 256;
+
+    LyricsGenerator generator;
+    const auto sections = Presets::getIndustrialStructure();
+    std::vector<std::vector<std::string>> lyrics;
+    std::vector<std::vector<std::shared_ptr<const SectionLyrics>>> sectionLyrics;
+    for (uint32_t seed = 0; seed < songs; ++seed) {
+        lyrics.push_back(generator.generate(sections, seed));
+        auto& song = sectionLyrics.emplace_back();
+        for (const auto& section : sections) {
+            song.push_back(generator.generateSection(section, seed));
+        }
+    }
+
+    // Uncached conversion of every line
+    size_t phonemes = 0;
+    auto start = Clock::now();
+    for (const auto& song : lyrics) {
+        for (const auto& line : song) {
+            phonemes += Phonemizer::convertLine(line).size();
+        }
+    }
+    double coldSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+    std::cout << std::format("{} songs, {} phonemes\n", songs, phonemes);
+    std::cout << std::format("{:>24} {:>12.2f} us/song\n", "convert uncached", coldSeconds / songs * 1e6);
+
+    // Each song converted, then converted again as regenerating it does;
+    // only the second pass is timed
+    Phonemizer phonemizer;
+    double cachedSeconds = 0.0;
+    for (const auto& song : lyrics) {
+        for (const auto& line : song) {
+            phonemes += phonemizer.convert(line)->size();
+        }
+        start = Clock::now();
+        for (const auto& line : song) {
+            phonemes += phonemizer.convert(line)->size();
+        }
+        cachedSeconds += std::chrono::duration<double>(Clock::now() - start).count();
+    }
+    double hitRate = static_cast<double>(phonemizer.hits()) / static_cast<double>(phonemizer.hits() + phonemizer.misses());
+    std::cout << std::format("{:>24} {:>12.2f} us/song ({:.1f}% hits overall)\n", "convert cached",
+                             cachedSeconds / songs * 1e6, hitRate * 100.0);
+
+    // Compile each section's vocals, then look up every beat of the songs
+    // as playback and the Vocal Output window do
+    std::vector<SongSections> compiled;
+    start = Clock::now();
+    for (const auto& song : sectionLyrics) {
+        std::vector<SongSection> entries;
+        for (size_t i = 0; i < sections.size(); ++i) {
+            auto vocals = std::make_shared<const SectionVocals>(SectionVocals::compile(
+                sections[i], song[i]->lines, AudioParams::VocalType::Robotic, phonemizer, song[i]->prosody));
+            entries.push_back({sections[i], {}, song[i], std::move(vocals)});
+        }
+        compiled.emplace_back(entries);
+    }
+    double compileSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+    std::cout << std::format("{:>24} {:>12.2f} us/song\n", "compile vocals", compileSeconds / songs * 1e6);
+
+    const auto songBeats = static_cast<int>(compiled.front().totalWeight());
+    size_t beats = 0;
+    size_t textBytes = 0;
+    start = Clock::now();
+    for (const auto& song : compiled) {
+        for (int beat = 0; beat < songBeats; ++beat) {
+            auto [entry, sectionStart] = sectionAt(song, beat);
+            if (const VocalEvent* event = entry->vocals->activeAt(static_cast<int>(beat - sectionStart))) {
+                textBytes += entry->vocals->text(*event).size();
+            }
+        }
+        beats += static_cast<size_t>(songBeats);
+    }
+    double lookupSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+    std::cout << std::format("{:>24} {:>12.2f} ns/beat\n", "vocals lookup", lookupSeconds / beats * 1e9);
+
+    // What each beat cost before: copy the line and decorate it in the style
+    start = Clock::now();
+    for (const auto& song : lyrics) {
+        for (int beat = 0; beat < songBeats; ++beat) {
+            std::string vocal = song[static_cast<size_t>(beat / 8) % song.size()];
+            std::transform(vocal.begin(), vocal.end(), vocal.begin(), ::toupper);
+            vocal = "[" + vocal + "]";
+            textBytes += vocal.size();
+        }
+    }
+    double stringSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+    std::cout << std::format("{:>24} {:>12.2f} ns/beat\n", "per-beat strings", stringSeconds / beats * 1e9);
+
+    // Sing the first song in each style, a block at a time at 70 BPM
+    constexpr std::array<std::pair<AudioParams::VocalType, std::string_view>, 3> STYLES = {{
+        {AudioParams::VocalType::Robotic, "robotic"},
+        {AudioParams::VocalType::Whisper, "whisper"},
+        {AudioParams::VocalType::Distorted, "distorted"},
+    }};
+    const double samplesPerBeat = SAMPLE_RATE * 60.0 / 70.0;
+    std::vector<float> block(BLOCK);
+    std::vector<float> recording;
+    const size_t recordPerStyle = static_cast<size_t>(SAMPLE_RATE) * 8;
+    for (auto [type, name] : STYLES) {
+        const size_t recordUntil = recording.size() + recordPerStyle;
+        VocalSynthesizer vocals;
+        vocals.setVocalType(type);
+        std::vector<SongSection> entries;
+        for (size_t i = 0; i < sections.size(); ++i) {
+            entries.push_back({sections[i], {}, sectionLyrics.front()[i],
+                               vocals.compileVocals(sections[i], *sectionLyrics.front()[i])});
+        }
+        vocals.setSong(SongSections(entries));
+        const auto songSamples = static_cast<size_t>(vocals.getSong()->totalWeight() * samplesPerBeat);
+
+        size_t lines = 0;
+        double peak = 0.0;
+        start = Clock::now();
+        for (size_t n = 0; n < songSamples; n += BLOCK) {
+            lines += vocals.onBeat(static_cast<int>(static_cast<double>(n) / samplesPerBeat)).has_value();
+            std::ranges::fill(block, 0.0f);
+            vocals.processAudio(block, SAMPLE_RATE);
+            for (float sample : block) {
+                peak = std::max(peak, static_cast<double>(std::abs(sample)));
+            }
+            if (recording.size() < recordUntil) {
+                recording.insert(recording.end(), block.begin(), block.end());
+            }
+        }
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        double audioSeconds = songSamples / SAMPLE_RATE;
+        std::cout << std::format("{:>24} {:>12.0f}x real time ({} lines in {:.0f} s, peak {:.2f})\n", name,
+                                 audioSeconds / seconds, lines, audioSeconds, peak);
+    }
+
+    RenderedAudio audio;
+    audio.sampleRate = static_cast<uint32_t>(SAMPLE_RATE);
+    audio.samples = std::move(recording);
+    if (!SongRenderer::saveWav(audio, "bench_vocal.wav")) {
+        std::cerr << "Cannot write bench_vocal.wav\n";
+        return 1;
+    }
+    std::cout << std::format("(checksum {})\n", phonemes + textBytes);
+    return 0;
+}
\ No newline at end of file
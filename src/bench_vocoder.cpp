@@ -0,0 +1,90 @@
+#include "ChannelVocoder.h"
+#include "FormantSynth.h"
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <format>
+
+// Sing a line on several layers, each with its own voice and vocoder on a
+// different carrier pitch, and time the vocoders alone at 16 and 32 bands
+// against the ring modulator they replace. Reports how many layers one core
+// could run in real time.
+int main(int argc, char* argv[]) {
+    using namespace IndustrialMusic;
+    using Clock = std::chrono::steady_clock;
+
+    size_t layers = argc > 1 ? std::stoull(argv[1]) : 8;
+    constexpr float SAMPLE_RATE = 48000.0f;
+    constexpr size_t BLOCK = 256;
+    constexpr float SECONDS = 10.0f;
+    const size_t blocks = static_cast<size_t>(SAMPLE_RATE * SECONDS) / BLOCK;
+
+    // Modulators: the formant voice, restarted whenever a line ends
+    Phonemizer phonemizer;
+    auto line = phonemizer.convert("Steel machines grind the hollow night, we transmit the signal");
+    std::vector<std::vector<float>> voices(layers, std::vector<float>(blocks * BLOCK));
+    for (size_t layer = 0; layer < layers; ++layer) {
+        FormantSynth voice;
+        VoiceSettings settings;
+        settings.pitch = 90.0f + 10.0f * static_cast<float>(layer);
+        for (size_t block = 0; block < blocks; ++block) {
+            if (!voice.isActive()) {
+                voice.start(line, settings);
+            }
+            voice.render(std::span<float>(voices[layer]).subspan(block * BLOCK, BLOCK), SAMPLE_RATE);
+        }
+    }
+
+    std::cout << std::format("{} layers, {:.0f} s each\n", layers, SECONDS);
+    std::vector<float> buffer(BLOCK);
+    double checksum = 0.0;
+    auto report = [&](std::string_view name, double seconds) {
+        // Real time factor of one layer is how many layers one core keeps up with
+        double layersPerCore = SECONDS * static_cast<double>(layers) / seconds;
+        std::cout << std::format("{:>24} {:>10.0f} layers per core in real time\n", name, layersPerCore);
+    };
+
+    // The ring modulator the Robotic style used before
+    auto start = Clock::now();
+    for (size_t layer = 0; layer < layers; ++layer) {
+        float modulation = 0.0f;
+        for (size_t block = 0; block < blocks; ++block) {
+            std::copy_n(voices[layer].begin() + block * BLOCK, BLOCK, buffer.begin());
+            modulation += 0.1f;
+            for (size_t i = 0; i < buffer.size(); ++i) {
+                buffer[i] *= std::sin(modulation + i * 0.01f);
+            }
+            checksum += buffer[0];
+        }
+    }
+    report("ring modulator", std::chrono::duration<double>(Clock::now() - start).count());
+
+    for (size_t bands : {ChannelVocoder::MIN_BANDS, ChannelVocoder::MAX_BANDS}) {
+        std::vector<ChannelVocoder> vocoders;
+        for (size_t layer = 0; layer < layers; ++layer) {
+            VocoderSettings settings;
+            settings.bands = bands;
+            settings.carrierPitch = 55.0f * std::pow(2.0f, static_cast<float>(layer % 4) * 7.0f / 12.0f);
+            vocoders.emplace_back(settings);
+        }
+
+        // Layers interleaved block by block, as a mixer would run them
+        double peak = 0.0;
+        start = Clock::now();
+        for (size_t block = 0; block < blocks; ++block) {
+            for (size_t layer = 0; layer < layers; ++layer) {
+                std::copy_n(voices[layer].begin() + block * BLOCK, BLOCK, buffer.begin());
+                vocoders[layer].process(buffer, SAMPLE_RATE);
+                for (float sample : buffer) {
+                    peak = std::max(peak, static_cast<double>(std::abs(sample)));
+                }
+            }
+        }
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        report(std::format("vocoder {} bands", bands), seconds);
+        std::cout << std::format("{:>24} {:.2f}\n", "peak", peak);
+        checksum += peak;
+    }
+    std::cout << std::format("(checksum {:.3f})\n", checksum);
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,106 @@
+#include "WordBankPack.h"
+#include "LyricsGenerator.h"
+#include "SongStructure.h"
+#include "BinaryRecords.h"
+#include <iostream>
+#include <chrono>
+#include <format>
+
+// Write a word-bank pack with tens of thousands of Zipf-weighted terms per
+// slot, then time loading it, drawing words by alias table against a
+// binary search over cumulative weights, and generating songs' lyrics.
+int main(int argc, char* argv[]) {
+    using namespace IndustrialMusic;
+    using Clock = std::chrono::steady_clock;
+
+    size_t wordsPerSlot = argc > 1 ? std::stoull(argv[1]) : 50'000;
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "bench_word_pack.imwords";
+    constexpr size_t DRAWS = 20'000'000;
+    constexpr uint32_t SONGS = 20'000;
+
+    // Words spelled from syllables, weighted 1 / rank
+    constexpr std::array<std::string_view, 16> SYLLABLES = {
+        "ra", "to", "ke", "mi", "su", "ne", "lo", "va", "dri", "gon", "tek", "zu", "ish", "orm", "ex", "kal"};
+    constexpr std::array<std::string_view, LYRIC_SLOT_COUNT> HEADERS = {"[adj]", "[noun]", "[verb]", "[theme]"};
+    std::string text = "# Synthetic benchmark pack\n";
+    std::vector<double> cumulative(wordsPerSlot);
+    double total = 0.0;
+    for (auto header : HEADERS) {
+        text += std::format("{}\n", header);
+        for (size_t rank = 0; rank < wordsPerSlot; ++rank) {
+            for (size_t value = rank + 1; value > 0; value /= SYLLABLES.size()) {
+                text += SYLLABLES[value % SYLLABLES.size()];
+            }
+            text += std::format(" {:.6g}\n", 1000.0 / static_cast<double>(rank + 1));
+        }
+    }
+    for (size_t rank = 0; rank < wordsPerSlot; ++rank) {
+        total += 1000.0 / static_cast<double>(rank + 1);
+        cumulative[rank] = total;
+    }
+    if (!writeFileAtomically(path, {reinterpret_cast<const uint8_t*>(text.data()), text.size()})) {
+        std::cerr << "Cannot write pack\n";
+        return 1;
+    }
+
+    auto start = Clock::now();
+    auto opened = WordBankPack::open(path);
+    double loadSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+    if (!opened) {
+        std::cerr << "Cannot open pack\n";
+        return 1;
+    }
+    auto pack = std::make_shared<const WordBankPack>(std::move(*opened));
+
+    std::cout << std::format("pack {} words per slot, {:.1f} MB\n", pack->getWordCount(LyricSlot::Noun), text.size() / 1e6);
+    std::cout << std::format("{:>24} {:>12.1f} ms\n", "load", loadSeconds * 1e3);
+
+    // Alias draws, and how often the top word came up against its weight
+    std::mt19937_64 rng(1);
+    size_t topHits = 0;
+    size_t checksum = 0;
+    std::string_view top = pack->word(LyricSlot::Noun, 0).text;
+    start = Clock::now();
+    for (size_t i = 0; i < DRAWS; ++i) {
+        auto word = pack->pick(LyricSlot::Noun, rng());
+        topHits += word.text.data() == top.data();
+        checksum += word.prosody.syllables;
+    }
+    double aliasSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+    std::cout << std::format("{:>24} {:>12.1f} Mwords/s (top word {:.4f}, expected {:.4f})\n", "alias draw",
+                             DRAWS / aliasSeconds / 1e6, static_cast<double>(topHits) / DRAWS,
+                             cumulative[0] / total);
+
+    // The same draws by binary search over cumulative weights
+    std::uniform_real_distribution<double> unit(0.0, total);
+    start = Clock::now();
+    for (size_t i = 0; i < DRAWS; ++i) {
+        auto rank = static_cast<size_t>(std::ranges::upper_bound(cumulative, unit(rng)) - cumulative.begin());
+        checksum += pack->word(LyricSlot::Noun, std::min(rank, wordsPerSlot - 1)).prosody.syllables;
+    }
+    double searchSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+    std::cout << std::format("{:>24} {:>12.1f} Mwords/s\n", "cumulative search", DRAWS / searchSeconds / 1e6);
+
+    LyricsGenerator generator;
+    const auto sections = Presets::getIndustrialStructure();
+    for (bool usePack : {false, true}) {
+        generator.setWordBankPack(usePack ? pack : nullptr);
+        size_t bytes = 0;
+        start = Clock::now();
+        for (uint32_t seed = 0; seed < SONGS; ++seed) {
+            for (const auto& line : generator.generate(sections, seed)) {
+                bytes += line.size();
+            }
+        }
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        std::cout << std::format("{:>24} {:>12.2f} us/song ({:.1f} MB of lyrics)\n",
+                                 usePack ? "songs from pack" : "songs built-in", seconds / SONGS * 1e6, bytes / 1e6);
+        checksum += bytes;
+    }
+    std::cout << "\n" << generator.generate(sections, 1)[1] << "\n";
+    std::cout << std::format("(checksum {})\n", checksum);
+
+    std::error_code error;
+    std::filesystem::remove(path, error);
+    return 0;
+}
\ No newline at end of file
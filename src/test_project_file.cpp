@@ -0,0 +1,59 @@
+#include "ProjectFile.h"
+#include "SongStructure.h"
+#include <iostream>
+#include <format>
+
+// Save projects whose sections have damaged lengths and check that loading
+// them fails instead of handing zero, negative or huge lengths to the
+// generators. An undamaged project must still load unchanged.
+int main() {
+    using namespace IndustrialMusic;
+
+    Project project;
+    project.songSeed = 7;
+    project.sections = Presets::getIndustrialStructure();
+    project.lyrics = {"[Verse 1]", "steel and smoke"};
+
+    auto loads = [](const Project& saved) {
+        auto bytes = ProjectFile::serialize(saved);
+        auto file = ProjectFile::parse(bytes);
+        return file ? file->load() : std::unexpected(file.error());
+    };
+
+    int failures = 0;
+    auto loaded = loads(project);
+    if (!loaded || loaded->sections != project.sections || loaded->lyrics != project.lyrics) {
+        std::cerr << "Undamaged project did not load unchanged\n";
+        ++failures;
+    }
+
+    struct Damage {
+        const char* name;
+        int bars;
+        int beatsPerBar;
+    };
+    constexpr Damage DAMAGES[] = {
+        {"zero bars", 0, 4},
+        {"negative bars", -8, 4},
+        {"huge bars", 1 << 30, 4},
+        {"zero beats per bar", 4, 0},
+        {"negative beats per bar", 4, -4},
+        {"huge beats per bar", 4, 1 << 30},
+    };
+    for (const Damage& damage : DAMAGES) {
+        Project damaged = project;
+        damaged.sections[1].bars = damage.bars;
+        damaged.sections[1].beatsPerBar = damage.beatsPerBar;
+        auto result = loads(damaged);
+        if (result || result.error() != ErrorCode::InvalidFileFormat) {
+            std::cerr << std::format("Project with {} was not rejected\n", damage.name);
+            ++failures;
+        }
+    }
+
+    if (failures > 0) {
+        return 1;
+    }
+    std::cout << "Damaged section lengths are rejected\n";
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,57 @@
+#include "NgramModel.h"
+#include <iostream>
+#include <chrono>
+#include <format>
+#include <charconv>
+
+// Train an n-gram lyric model from a text corpus (one lyric line per line)
+// and write it as an .imlm file for LyricsGenerator and batch_generate.
+//
+//   train_lyrics_model corpus.txt lyrics.imlm [order]
+
+int main(int argc, char* argv[]) {
+    using namespace IndustrialMusic;
+    using Clock = std::chrono::steady_clock;
+
+    if (argc < 3 || argc > 4) {
+        std::cout << "Usage: train_lyrics_model CORPUS OUTPUT [ORDER]\n"
+                  << "  ORDER is the n-gram length, 2-4 (default 3)\n";
+        return 1;
+    }
+
+    int order = 3;
+    if (argc == 4) {
+        std::string_view text = argv[3];
+        auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), order);
+        if (error != std::errc{} || end != text.data() + text.size()) {
+            std::cerr << std::format("Invalid order '{}'\n", text);
+            return 1;
+        }
+    }
+
+    auto corpus = MappedFile::open(argv[1]);
+    if (!corpus) {
+        std::cerr << std::format("Cannot read corpus '{}'\n", argv[1]);
+        return 1;
+    }
+
+    auto start = Clock::now();
+    const auto bytes = corpus->bytes();
+    auto model = NgramModel::train({reinterpret_cast<const char*>(bytes.data()), bytes.size()}, order);
+    if (!model) {
+        std::cerr << std::format("Cannot train an order-{} model from '{}'\n", order, argv[1]);
+        return 1;
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    if (auto saved = writeFileAtomically(argv[2], *model); !saved) {
+        std::cerr << std::format("Cannot write '{}'\n", argv[2]);
+        return 1;
+    }
+
+    auto summary = NgramModel::parse(*model);
+    std::cout << std::format("Trained order-{} model in {:.2f} s: {} words, {} contexts, {:.1f} MB\n",
+                             order, seconds, summary->getVocabularySize(), summary->getContextCount(),
+                             model->size() / (1024.0 * 1024.0));
+    return 0;
+}
\ No newline at end of file